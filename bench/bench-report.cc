@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <bench/bench-report.h>
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+
+
+/** \file
+ *
+ *  Implementation of the \c Bench_Report class. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  Bench_Report::Bench_Report  (string suite_,
+                               unsigned const samples_,
+                               string filter_)
+    :  suite {move (suite_)},
+       samples {max (1u, samples_)},
+       filter {move (filter_)}
+  {}
+
+
+
+  void  Bench_Report::add  (string const &name,
+                            Parameters const &parameters,
+                            size_t const operations,
+                            vector <double> ns_per_op)
+  {
+    sort (begin (ns_per_op),  end (ns_per_op));
+    cases.push_back ({name,  parameters,  operations,  move (ns_per_op)});
+  }
+
+
+
+  double  Bench_Report::quantile  (vector <double> const &sorted,
+                                   double const p)
+  {
+    if (sorted.empty ())    return 0.0;
+
+    auto const  x  {p * (sorted.size () - 1)};
+    auto const  i  {size_t (x)};
+
+    if (i + 1 >= sorted.size ())    return sorted.back ();
+
+    return  sorted [i]  +  (x - i) * (sorted [i + 1] - sorted [i]);
+  }
+
+
+
+  /** The string \a s as a JSON literal. */
+  static string  quoted  (string const &s)
+  {
+    string  ret  {"\""};
+
+    for (auto const c : s)
+      switch (c)
+        {
+        case '"':    ret += "\\\"";    break;
+        case '\\':   ret += "\\\\";    break;
+        case '\n':   ret += "\\n";     break;
+        case '\t':   ret += "\\t";     break;
+        default:
+          if ((unsigned char) c < 0x20)
+            {
+              char  hold [8];
+              snprintf (hold,  sizeof (hold),  "\\u%04x",  c);
+              ret += hold;
+            }
+          else
+            ret += c;
+        }
+
+    return ret + '"';
+  }
+
+
+  /** The number \a x as a JSON literal, to a precision well beyond the
+   *  resolution of any timings. */
+  static string  number  (double const x)
+  {
+    char  hold [32];
+    snprintf (hold,  sizeof (hold),  "%.6g",  x);
+    return hold;
+  }
+
+
+
+  void  Bench_Report::write  (ostream &out)  const
+  {
+    out << "{\"suite\": " << quoted (suite)
+        << ", \"compiler\": " << quoted (__VERSION__)
+        << ", \"cases\": [";
+
+    for (auto c = begin (cases);  c != end (cases);  ++c)
+      {
+        out << (c == begin (cases) ? "\n" : ",\n")
+            << "  {\"name\": " << quoted (c->name)
+            << ", \"parameters\": {";
+
+        for (auto p = begin (c->parameters);  p != end (c->parameters);  ++p)
+          {
+            if (p != begin (c->parameters))    out << ", ";
+            out << quoted (p->first) << ": ";
+            if (auto const *const  s  {get_if <string> (&p->second)})
+              out << quoted (*s);
+            else
+              out << number (get <double> (p->second));
+          }
+
+        auto const &t  {c->ns_per_op};
+
+        out << "}, \"operations\": " << c->operations
+            << ", \"samples\": " << t.size ()
+            << ", \"ns_per_op\": {"
+            << "\"min\": " << number (t.empty () ? 0.0 : t.front ())
+            << ", \"p50\": " << number (quantile (t, 0.50))
+            << ", \"p90\": " << number (quantile (t, 0.90))
+            << ", \"p99\": " << number (quantile (t, 0.99))
+            << ", \"max\": " << number (t.empty () ? 0.0 : t.back ())
+            << ", \"mean\": "
+            << number (t.empty ()  ?  0.0
+                                   :  accumulate (begin (t), end (t), 0.0)
+                                         / t.size ())
+            << "}}";
+      }
+
+    out << "\n]}\n";
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#ifndef DMBCS__TRADER_DESK__BENCH__BENCH_REPORT__H
+#define DMBCS__TRADER_DESK__BENCH__BENCH_REPORT__H
+
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+
+/** \file
+ *
+ *  Declaration of the \c Bench_Report class, which times benchmark cases
+ *  and writes the results out as JSON. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  using namespace std;
+
+
+  /** The results of a run of a suite of benchmarks.  Each case is run a
+   *  number of times (samples), each sample timing a number of repeats
+   *  of some operation; we report the distribution over the samples of
+   *  the time per operation.
+   *
+   *  The JSON written has the form
+   *
+   *      { "suite": ..., "compiler": ..., "cases": [
+   *          { "name": ..., "parameters": { ... }, "operations": N,
+   *            "samples": N, "ns_per_op": { "min": ..., "p50": ...,
+   *            "p90": ..., "p99": ..., "max": ..., "mean": ... } },
+   *          ... ] }
+   *
+   *  with one line per case, so that results of different builds can be
+   *  compared with nothing more than \c diff, as well as by machine. */
+
+  class Bench_Report
+  {
+  public:
+
+    /** A parameter of a case is either a name or a number. */
+    typedef  variant <string, double>  Value;
+
+    typedef  vector <pair <string, Value>>  Parameters;
+
+
+    /** Set up a report of the \a suite, taking \a samples of every case;
+     *  cases whose names do not contain the \a filter are skipped. */
+    Bench_Report  (string suite,  unsigned samples,  string filter = "");
+
+
+    /** Whether the case called \a name is to be run. */
+    bool  wanted  (string const &name)  const
+    {  return  name.find (filter) != string::npos;  }
+
+
+    /** The time taken to call \a f once. */
+    template <typename F>
+    static chrono::steady_clock::duration  time_of  (F &&f)
+    {
+      auto const  start  {chrono::steady_clock::now ()};
+      f ();
+      return  chrono::steady_clock::now () - start;
+    }
+
+
+    /** Run the case called \a name, with the \a parameters, \c samples
+     *  times.  Each call to \a sample must do the \a operations which are
+     *  to be timed, and return the time they took (typically through \c
+     *  time_of, so that any setting up is left out).  There is one
+     *  un-recorded run first, to warm the caches. */
+    template <typename F>
+    void  run  (string const &name,
+                Parameters const &parameters,
+                size_t const operations,
+                F &&sample)
+    {
+      if (! wanted (name))    return;
+
+      sample ();
+
+      vector <double>  ns_per_op;
+      ns_per_op.reserve (samples);
+
+      for (unsigned s = 0;  s < samples;  ++s)
+        ns_per_op.push_back
+              (chrono::duration <double, nano> (sample ()).count ()
+                   /  operations);
+
+      add (name,  parameters,  operations,  move (ns_per_op));
+    }
+
+
+    /** Record a case called \a name, with the \a parameters, whose
+     *  samples (of \a operations each) have already been taken, giving
+     *  the times in \a ns_per_op. */
+    void  add  (string const &name,
+                Parameters const &parameters,
+                size_t operations,
+                vector <double> ns_per_op);
+
+
+    /** Write the whole report out. */
+    void  write  (ostream &)  const;
+
+
+    /** The \a p'th quantile (0 to 1) of the \a sorted values, by linear
+     *  interpolation between the nearest ranks. */
+    static double  quantile  (vector <double> const &sorted,  double p);
+
+
+  private:
+
+    struct Case
+    {
+      string          name;
+      Parameters      parameters;
+      size_t          operations;
+      vector <double> ns_per_op;
+    };
+
+    string const    suite;
+    unsigned const  samples;
+    string const    filter;
+
+    vector <Case>  cases;
+
+  };  /* End of class Bench_Report. */
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+#endif  /* Undefined DMBCS__TRADER_DESK__BENCH__BENCH_REPORT__H. */
@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <bench/daily-csv.h>
+#include <trader-desk/alpha-vantage.h>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+
+/** \file
+ *
+ *  The \c csv-fuzz program, which throws made-up and mangled daily
+ *  time-series responses at \c Alpha_Vantage::parse_closing_prices.
+ *
+ *  Well-formed responses must give exactly what the parser it replaced
+ *  (\c legacy_parse_closing_prices) gave.  Mangled ones must give exactly
+ *  what a plain model of the parser gives: split the response into
+ *  lines, read rows until one will not parse or is not new, and pass
+ *  those on in reverse.  Run it through \c make \c fuzz; it is most
+ *  useful built with \c -fsanitize=address,undefined in the \c CXXFLAGS.
+ *
+ *  Building with \c -DTRADER_DESK_LIBFUZZER instead gives an entry point
+ *  for libFuzzer, which checks arbitrary input against the model. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  typedef  Update_Closing_Prices::Data     Data;
+  typedef  Update_Closing_Prices::Company  Company;
+
+
+  static bool  same  (vector <Data> const &A,  vector <Data> const &B)
+  {
+    return  equal (begin (A),  end (A),  begin (B),  end (B),
+                   [] (Data const &a,  Data const &b)
+                   {
+                     return  a.company_seqid == b.company_seqid
+                               &&  a.year == b.year  &&  a.month == b.month
+                               &&  a.day == b.day
+                               &&  a.open == b.open  &&  a.high == b.high
+                               &&  a.low == b.low    &&  a.close == b.close
+                               &&  a.adj_close == b.adj_close
+                               &&  a.volume == b.volume;
+                   });
+  }
+
+
+  static vector <Data>  run  (void (*parse) (Company const &,
+                                             string const &,
+                                             function <void (Data const &)>),
+                              Company const &company,
+                              string const &csv)
+  {
+    vector <Data>  ret;
+    parse (company,  csv,  [&ret] (Data const &d)  { ret.push_back (d); });
+    return ret;
+  }
+
+
+  /** The model of \c Alpha_Vantage::parse_closing_prices.  The dates are
+   *  compared in UTC, which \c main makes the local time zone. */
+  static vector <Data>  model  (Company const &company,  string const &csv)
+  {
+    vector <string_view>  lines;
+    for (size_t  i  {csv.find ('\n')};  i != csv.npos  &&  i + 1 < csv.size (); )
+      {
+        auto const  j  {csv.find ('\n',  i + 1)};
+        lines.push_back (string_view {csv}.substr (i + 1,  j - i - 1));
+        i = j;
+      }
+
+    tm  t;
+    gmtime_r (&company.last_close_date,  &t);
+    auto const  day  {[] (int64_t const y,  int64_t const m,  int64_t const d)
+                      {  return  y * 10000  +  m * 100  +  d;  }};
+
+    auto const  last_day  {day (t.tm_year + 1900,  t.tm_mon + 1,  t.tm_mday)};
+
+    vector <Data>  rows;
+    for (auto const &l : lines)
+      {
+        Data  d;
+        d.company_seqid = company.seqid;
+        if (! Alpha_Vantage::parse_daily_row (l,  d))    break;
+        rows.push_back (d);
+        if (day (d.year,  d.month,  d.day)  <=  last_day)    break;
+      }
+
+    return {rows.rbegin (),  rows.rend ()};
+  }
+
+
+
+  /** A well-formed response of up to 40 rows, with prices given to all
+   *  sorts of numbers of decimal places. */
+  static string  random_csv  (mt19937_64 &r,  vector <time_t> &dates)
+  {
+    auto const  crlf  {r () % 2  ?  "\r\n"  :  "\n"};
+
+    string  ret  {"timestamp,open,high,low,close,adjusted_close,volume,"
+                  "dividend_amount,split_coefficient"};
+    ret += crlf;
+
+    auto const  price  {[&r]
+                          {
+                            auto  s  {to_string (r () % 100000)};
+                            if (auto const  places  {r () % 7})
+                              {
+                                s += '.';
+                                for (auto i = places;  i--; )
+                                  s += char ('0' + r () % 10);
+                              }
+                            return s;
+                          }};
+
+    dates.clear ();
+    time_t  day  {1577836800 - time_t (r () % 7000) * 86400};
+
+    for (auto n = r () % 41;  n--; )
+      {
+        tm  t;
+        gmtime_r (&day,  &t);
+        dates.push_back (day);
+
+        char  date [16];
+        snprintf (date,  sizeof date,  "%04d-%02d-%02d",
+                  t.tm_year + 1900,  t.tm_mon + 1,  t.tm_mday);
+
+        ret += date;
+        for (int i = 0;  i < 5;  ++i)    ret += ',' + price ();
+        ret += ',' + to_string (r () % 100000000);
+        ret += ",0.0000,1.0";
+        ret += crlf;
+
+        day -= time_t (1 + r () % 4) * 86400;
+      }
+
+    return ret;
+  }
+
+
+
+  /** Damage a few bytes of \a s, or cut it short. */
+  static void  mangle  (mt19937_64 &r,  string &s)
+  {
+    static char const  likely []  {"0123456789.,-+eE\r\n x"};
+
+    for (auto n = 1 + r () % 8;  n--  &&  ! s.empty (); )
+      {
+        auto const  i  {r () % s.size ()};
+        auto const  c  {r () % 4  ?  likely [r () % (sizeof likely - 1)]
+                                  :  char (r ())};
+
+        switch (r () % 5)
+          {
+          case 0:  s [i] = c;                                 break;
+          case 1:  s.insert (s.begin () + i,  c);             break;
+          case 2:  s.erase (i,  1);                           break;
+          case 3:  s.insert (i,  s.substr (i,  r () % 40));   break;
+          case 4:  s.resize (i);                              break;
+          }
+      }
+  }
+
+
+
+  static void  fail  (char const *const what,
+                      Company const &company,
+                      string const &csv)
+  {
+    cerr << "csv-fuzz: " << what << " with last close "
+         << company.last_close_date << " on:\n" << csv << "\n";
+    exit (1);
+  }
+
+
+
+  /** Check one response \a csv against the model and, if it is \a
+   *  well_formed, against the old parser too, for a company whose last
+   *  close was on one of the \a dates (or at neither end of them). */
+  static void  check  (mt19937_64 &r,
+                       string const &csv,
+                       vector <time_t> const &dates,
+                       bool const well_formed)
+  {
+    auto const  pick  {r () % (dates.size () + 2)};
+
+    Company const  company
+      {"Fuzz",  "FUZZ",  int (r () % 1000),
+       pick < dates.size ()   ?  dates [pick]
+         : pick == dates.size ()  ?  time_t {0}
+                                  :  time_t {1600000000}};
+
+    auto const  got  {run (Alpha_Vantage::parse_closing_prices,
+                           company,  csv)};
+
+    if (! same (got,  model (company,  csv)))
+      fail ("parser differs from model",  company,  csv);
+
+    if (well_formed  &&  ! same (got,  run (legacy_parse_closing_prices,
+                                            company,  csv)))
+      fail ("parser differs from legacy parser",  company,  csv);
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+
+#ifdef TRADER_DESK_LIBFUZZER
+
+extern "C" int  LLVMFuzzerTestOneInput  (uint8_t const *data,  size_t size)
+{
+  namespace TD  =  DMBCS::Trader_Desk;
+
+  static bool const  utc  {setenv ("TZ",  "UTC",  1) == 0};
+  static std::mt19937_64  r  {utc};
+
+  TD::check (r,  std::string (data,  data + size),  {},  0);
+  return 0;
+}
+
+#else
+
+int main (int argc, char **argv)
+try
+  {
+    namespace TD  =  DMBCS::Trader_Desk;
+
+    unsigned long  iterations  {200000};
+    unsigned long  seed  {1};
+
+    for (int a = 1;  a < argc;  ++a)
+      {
+        std::string const  arg  {argv [a]};
+
+        if (arg == "--iterations"  &&  a + 1 < argc)
+          iterations = std::stoul (argv [++a]);
+        else if (arg == "--seed"  &&  a + 1 < argc)
+          seed = std::stoul (argv [++a]);
+        else
+          {
+            std::cerr << "usage: csv-fuzz [--iterations N] [--seed N]\n";
+            return  arg == "--help"  ?  0  :  1;
+          }
+      }
+
+    /* So that the model and both parsers agree on what day a time is. */
+    setenv ("TZ",  "UTC",  1);
+    tzset ();
+
+    std::mt19937_64  r  {seed};
+    std::vector <time_t>  dates;
+
+    for (unsigned long  i  {0};  i < iterations;  ++i)
+      {
+        auto  csv  {TD::random_csv (r,  dates)};
+
+        TD::check (r,  csv,  dates,  1);
+
+        TD::mangle (r,  csv);
+        TD::check (r,  csv,  dates,  0);
+      }
+
+    std::cout << "csv-fuzz: " << iterations << " responses, no differences.\n";
+
+    return 0;
+  }
+
+catch (std::exception const &e)
+  {
+    std::cerr << e.what () << ".\n";
+    std::exit (1);
+  }
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <bench/daily-csv.h>
+#include <cstdio>
+#include <random>
+#include <sstream>
+
+
+/** \file
+ *
+ *  Implementation of \c daily_csv and \c legacy_parse_closing_prices. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  string  daily_csv  (Time_Series const &series,  bool const crlf)
+  {
+    char const *const  eol  {crlf  ?  "\r\n"  :  "\n"};
+
+    string  ret  {"timestamp,open,high,low,close,adjusted_close,volume,"
+                  "dividend_amount,split_coefficient"};
+    ret += eol;
+    ret.reserve (series.size () * 80);
+
+    mt19937_64  r  {series.size ()};
+
+    for (auto const &e : series)
+      {
+        auto const  T  {chrono::system_clock::to_time_t (e.time)};
+        tm  t;
+        gmtime_r (&T,  &t);
+
+        auto const  spread  {e.price * 0.01 * (r () % 100) / 100.0};
+
+        char  line [160];
+        snprintf (line,  sizeof line,
+                  "%04d-%02d-%02d,%.4f,%.4f,%.4f,%.4f,%.4f,%d,0.0000,1.0%s",
+                  t.tm_year + 1900,  t.tm_mon + 1,  t.tm_mday,
+                  e.price - spread / 2,  e.price + spread,  e.price - spread,
+                  e.price,  e.price,
+                  int (r () % 10000000),
+                  eol);
+        ret += line;
+      }
+
+    return ret;
+  }
+
+
+
+  /* This and what follows is the code from alpha-vantage.cc as it was. */
+
+  static  istream&  operator>> (istream& I,  Update_Closing_Prices::Data&  D)
+  {
+    static  char  comma;
+    static  double  dividend_amount,  split_coefficient;
+
+    I >> D.year >> comma >> D.month >> comma >> D.day >> comma
+      >> D.open >> comma >> D.high >> comma
+      >> D.low >> comma >> D.close >> comma
+      >> D.adj_close >> comma >> D.volume >> comma
+      >> dividend_amount >> comma >> split_coefficient;
+
+    return  I;
+  }
+
+
+
+  static  vector<Update_Closing_Prices::Data>  parse_csv
+                     (const string&  results,  const int  company_seqid)
+  {
+    istringstream  O  {results.substr  (results.find  ('\n'))};
+    vector<Update_Closing_Prices::Data>  data;
+
+    for (;;)    {    Update_Closing_Prices::Data  datum;
+                     datum.company_seqid  =  company_seqid;
+                     O >> datum;
+                     if  (! O.good ())  return data;
+                     data.push_back (move (datum));    }
+  }
+
+
+
+  void  legacy_parse_closing_prices
+          (Update_Closing_Prices::Company const &company,
+           string const &csv,
+           function <void (Update_Closing_Prices::Data const &)>  injector)
+  {
+    vector<Update_Closing_Prices::Data>  data
+            {parse_csv  (csv,  company.seqid)};
+
+    auto  i  {  find_if  (data.rbegin (),  data.rend (),
+                          [L = company.last_close_date]
+                                      (const Update_Closing_Prices::Data&  D)
+                                {    return  t (D.year, D.month, D.day) > L;  })};
+
+    if  (i != data.rbegin())  --i;
+
+    for  (auto j {i};  j != data.rend ();  ++j)
+                 injector  (*j);
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#ifndef DMBCS__TRADER_DESK__BENCH__DAILY_CSV__H
+#define DMBCS__TRADER_DESK__BENCH__DAILY_CSV__H
+
+
+#include <trader-desk/time-series.h>
+#include <trader-desk/update-closing-prices.h>
+
+
+/** \file
+ *
+ *  Declaration of the helpers which the benchmarks and the fuzzer use to
+ *  make up and read AlphaVantage daily time-series responses. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  /** A response to a \c TIME_SERIES_DAILY_ADJUSTED query in csv form, as
+   *  AlphaVantage would send it for the closing prices in \a series, with
+   *  the open, high, low and volume made up around them.  The lines end
+   *  in CR-LF if \a crlf is set, as the service's do. */
+  string  daily_csv  (Time_Series const &series,  bool crlf = 1);
+
+
+  /** The closing-price parsing as it was before \c
+   *  Alpha_Vantage::parse_closing_prices read the response in place:
+   *  every row is read through an \c istringstream into a vector, and the
+   *  wanted rows picked out of that.  Kept here so that the new parser
+   *  can be timed and checked against it. */
+  void  legacy_parse_closing_prices
+          (Update_Closing_Prices::Company const &,
+           string const &csv,
+           function <void (Update_Closing_Prices::Data const &)>  injector);
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+#endif  /* Undefined DMBCS__TRADER_DESK__BENCH__DAILY_CSV__H. */
@@ -0,0 +1,611 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <bench/daily-csv.h>
+#include <bench/synthetic-prices.h>
+#include <trader-desk/http-client.h>
+#include <curlpp/cURLpp.hpp>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <thread>
+
+
+/** \file
+ *
+ *  The \c market-data-stand-in program, an HTTP server on the local
+ *  machine which answers the queries that trader-desk makes of the
+ *  market-data services.  With it the ingest paths can be run, timed and
+ *  checked without the Internet, without an API key, and without using
+ *  up the day's quota of calls.
+ *
+ *  Each query is answered from the first of these which has an answer:
+ *
+ *    - a directory of recorded responses (\c --replay);
+ *
+ *    - the real service (\c --upstream), whose response is recorded if
+ *      \c --record names a directory to put it in;
+ *
+ *    - made-up price histories (\c --synthesize), for \c
+ *      TIME_SERIES_DAILY_ADJUSTED and \c GLOBAL_QUOTE queries on any
+ *      symbol at all, so that a market of any size can be served.
+ *
+ *  Responses are filed under a name made from the path and query of the
+ *  request, less the API key.  So anything the services send, such as the
+ *  component deltas of the meta-data service, can be recorded and
+ *  replayed without our needing to know its form.
+ *
+ *  On top of that every response can be delayed (\c --latency), we can
+ *  refuse calls with a note as AlphaVantage does when it is called too
+ *  often (\c --calls-per-minute), and we can fail at random (\c
+ *  --error-rate) with an error message, an HTTP error, or a dropped
+ *  connection.
+ *
+ *  Point trader-desk at it by setting the market data service in the
+ *  preferences to \c http://localhost:8642/query (or whichever port is
+ *  given with \c --port). */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  struct Options
+  {
+    uint16_t  port  {8642};
+
+    /** Directories to replay responses from and record them in. */
+    string  replay,  record;
+
+    /** The real service, as scheme, host and port only; the path and
+     *  query of each request are added to it. */
+    string  upstream;
+
+    bool  synthesize  {0};
+
+    /** The number of trading days in a synthesized full history; compact
+     *  ones have 100, as AlphaVantageʼs do. */
+    size_t  history  {20 * 261};
+
+    /** Unless set, synthesized histories are moved forward by whole
+     *  weeks so that they end close to today, and look new to the
+     *  database. */
+    bool  fixed_dates  {0};
+
+    chrono::milliseconds  latency  {0};
+
+    /** Zero for no limit. */
+    unsigned  calls_per_minute  {0};
+
+    /** The proportion of requests which fail. */
+    double  error_rate  {0.0};
+
+    uint64_t  seed  {1};
+  };
+
+
+  struct Request
+  {
+    /** The path and query exactly as they came to us. */
+    string  target;
+
+    string  path;
+
+    /** The decoded query parameters. */
+    map <string, string>  query;
+
+    /** Whether the client wants the connection closed after this. */
+    bool  close  {0};
+  };
+
+
+  struct Response
+  {
+    int  status  {200};
+    string  body;
+
+    /** Close the connection without sending anything. */
+    bool  drop  {0};
+
+    /** Where the response came from, for the log. */
+    char const  *source  {""};
+  };
+
+
+
+  static string  url_decode  (string_view  s)
+  {
+    string  ret;
+    ret.reserve (s.size ());
+
+    for (size_t  i  {0};  i < s.size ();  ++i)
+      if (s [i] == '+')
+        ret += ' ';
+      else if (s [i] == '%'  &&  i + 2 < s.size ()
+                             &&  isxdigit ((unsigned char) s [i + 1])
+                             &&  isxdigit ((unsigned char) s [i + 2]))
+        {
+          ret += char (stoi (string {s.substr (i + 1,  2)},  nullptr,  16));
+          i += 2;
+        }
+      else
+        ret += s [i];
+
+    return ret;
+  }
+
+
+
+  /** Read the request line and headers in \a head (up to but not
+   *  including the blank line); returns nothing if they are not what we
+   *  expect. */
+  static optional <Request>  parse_request  (string_view  head)
+  {
+    auto const  eol  {head.find ("\r\n")};
+    string_view  line  {head.substr (0,  eol)};
+
+    if (line.substr (0, 4) != "GET ")    return {};
+    line.remove_prefix (4);
+
+    Request  ret;
+    ret.target = line.substr (0,  line.find (' '));
+
+    auto const  q  {ret.target.find ('?')};
+    ret.path = url_decode (string_view {ret.target}.substr (0, q));
+
+    if (q != string::npos)
+      for (string_view  rest  {string_view {ret.target}.substr (q + 1)};
+           ! rest.empty ();  )
+        {
+          auto const  amp  {rest.find ('&')};
+          auto const  pair  {rest.substr (0,  amp)};
+          auto const  eq  {pair.find ('=')};
+          ret.query [url_decode (pair.substr (0, eq))]
+                  = eq == pair.npos  ?  string {}
+                                     :  url_decode (pair.substr (eq + 1));
+          rest.remove_prefix (amp == rest.npos  ?  rest.size ()  :  amp + 1);
+        }
+
+    string  headers  {eol == head.npos  ?  string_view {}
+                                        :  head.substr (eol)};
+    for (auto &c : headers)    c = tolower ((unsigned char) c);
+    ret.close = headers.find ("\r\nconnection: close") != string::npos;
+
+    return ret;
+  }
+
+
+
+  /** The name under which the response to \a r is filed: its path and
+   *  query, in a fixed order and less the API key, with anything which
+   *  might upset a file system made into an underscore. */
+  static string  record_name  (Request const &r)
+  {
+    string  ret  {r.path};
+
+    for (auto const &[key, value] : r.query)
+      if (key != "apikey")
+        ret += '&' + key + '=' + value;
+
+    for (auto &c : ret)
+      if (! isalnum ((unsigned char) c)  &&  c != '.'  &&  c != '-'
+                                         &&  c != '='  &&  c != '&')
+        c = '_';
+
+    return ret;
+  }
+
+
+
+  static optional <string>  read_file  (filesystem::path const &p)
+  {
+    ifstream  in  {p,  ios::binary};
+    if (! in)    return {};
+    ostringstream  hold;
+    hold << in.rdbuf ();
+    return hold.str ();
+  }
+
+
+
+  static void  write_file  (filesystem::path const &p,  string const &body)
+  {
+    ofstream  out  {p,  ios::binary};
+    out << body;
+    if (! out)    cerr << "market-data-stand-in: cannot write " << p << ".\n";
+  }
+
+
+
+  /** FNV-1a, which gives the same seed for a symbol on every machine. */
+  static uint64_t  hash  (string_view  s)
+  {
+    uint64_t  h  {0xcbf29ce484222325};
+    for (auto const c : s)    h = (h ^ (unsigned char) c) * 0x100000001b3;
+    return h;
+  }
+
+
+
+  /** The newest \a days of the made-up history for \a symbol.  The whole
+   *  history is made every time, so that the prices are the same however
+   *  many days are asked for. */
+  static Time_Series  synthetic_history  (Options const &O,
+                                          string const &symbol,
+                                          size_t const days)
+  {
+    auto const  h  {hash (symbol) ^ O.seed};
+
+    auto  ret  {Synthetic_Prices::make
+                    (Synthetic_Prices::PATTERNS
+                             [h % size (Synthetic_Prices::PATTERNS)],
+                     max (O.history,  days),  h)};
+
+    ret.resize (min (days,  ret.size ()));
+
+    if (! O.fixed_dates)
+      {
+        auto const  week  {chrono::hours {24 * 7}};
+        auto const  shift  {(chrono::system_clock::now ()
+                                   - Synthetic_Prices::LATEST) / week * week};
+        for (auto &e : ret)    e.time += shift;
+      }
+
+    return ret;
+  }
+
+
+
+  /** A response to a \c GLOBAL_QUOTE query in csv form, for the latest
+   *  event of the \a series. */
+  static string  global_quote_csv  (string const &symbol,
+                                    Time_Series const &series)
+  {
+    auto const &latest  {series [0]};
+    auto const  previous  {series.size () > 1  ?  series [1].price
+                                               :  latest.price};
+
+    auto const  T  {chrono::system_clock::to_time_t (latest.time)};
+    tm  t;
+    gmtime_r (&T,  &t);
+
+    char  row [256];
+    snprintf (row,  sizeof row,
+              "%s,%.4f,%.4f,%.4f,%.4f,%d,%04d-%02d-%02d,%.4f,%.4f,%.4f%%\r\n",
+              symbol.c_str (),
+              previous,
+              max (previous,  latest.price) * 1.005,
+              min (previous,  latest.price) * 0.995,
+              latest.price,
+              int (hash (symbol) % 10000000),
+              t.tm_year + 1900,  t.tm_mon + 1,  t.tm_mday,
+              previous,
+              latest.price - previous,
+              100.0 * (latest.price - previous) / previous);
+
+    return  "symbol,open,high,low,price,volume,latestDay,previousClose,"
+            "change,changePercent\r\n"  +  string {row};
+  }
+
+
+
+  static string  error_json  (string const &tag,  string const &message)
+  {
+    return "{\n    \"" + tag + "\": \"" + message + "\"\n}";
+  }
+
+
+
+  class Stand_In
+  {
+    Options const  O;
+
+    mutex  m;
+
+    /** For the error injection; used under \c m. */
+    mt19937_64  random;
+
+    /** The times of the calls we have answered in the last minute, when
+     *  there is a limit on them; used under \c m. */
+    deque <chrono::steady_clock::time_point>  calls;
+
+
+    /** If the call is to fail, or be refused, say how. */
+    optional <Response>  misbehave  (Request const &r)
+    {
+      lock_guard  l  {m};
+
+      if (O.error_rate > 0.0  &&  (random () >> 11) * 0x1.0p-53 < O.error_rate)
+        switch (random () % 3)
+          {
+          case 0:
+            return Response {200,
+                             error_json ("Error Message",
+                                         "Invalid API call. Please retry or "
+                                         "visit the documentation for "
+                                           + (r.query.count ("function")
+                                                ?  r.query.at ("function")
+                                                :  string {"this service"})
+                                           + "."),
+                             0,  "error"};
+          case 1:
+            return Response {503,  "Service Unavailable",  0,  "error"};
+          default:
+            return Response {0,  {},  1,  "dropped"};
+          }
+
+      if (O.calls_per_minute)
+        {
+          auto const  now  {chrono::steady_clock::now ()};
+
+          while (! calls.empty ()
+                    &&  calls.front () <= now - chrono::minutes {1})
+            calls.pop_front ();
+
+          if (calls.size () >= O.calls_per_minute)
+            return Response
+                     {200,
+                      error_json ("Note",
+                                  "Thank you for using Alpha Vantage! Our "
+                                  "standard API call frequency is "
+                                  + to_string (O.calls_per_minute)
+                                  + " calls per minute and 500 calls per "
+                                    "day."),
+                      0,  "throttled"};
+
+          calls.push_back (now);
+        }
+
+      return {};
+    }
+
+
+    Response  respond  (Request const &r)
+    {
+      if (auto  ret  {misbehave (r)})    return *ret;
+
+      auto const  name  {record_name (r)};
+
+      if (! O.replay.empty ())
+        if (auto  body  {read_file (filesystem::path {O.replay} / name)})
+          return {200,  move (*body),  0,  "replay"};
+
+      if (! O.upstream.empty ())
+        try
+          {
+            auto  body  {Http_Client::shared ().get (O.upstream + r.target)};
+            if (! O.record.empty ())
+              write_file (filesystem::path {O.record} / name,  body);
+            return {200,  move (body),  0,  "upstream"};
+          }
+        catch (exception const &e)
+          {
+            return {502,  e.what (),  0,  "upstream"};
+          }
+
+      auto const  get  {[&r] (string const &key)
+                        {
+                          auto const  i  {r.query.find (key)};
+                          return  i == r.query.end ()  ?  string {}
+                                                       :  i->second;
+                        }};
+
+      if (O.synthesize  &&  ! get ("symbol").empty ())
+        {
+          if (get ("function") == "TIME_SERIES_DAILY_ADJUSTED")
+            return {200,
+                    daily_csv (synthetic_history
+                                 (O,  get ("symbol"),
+                                  get ("outputsize") == "full"  ?  O.history
+                                                                :  100)),
+                    0,  "synthesized"};
+
+          if (get ("function") == "GLOBAL_QUOTE")
+            return {200,
+                    global_quote_csv (get ("symbol"),
+                                      synthetic_history (O,  get ("symbol"),
+                                                         2)),
+                    0,  "synthesized"};
+        }
+
+      return {404,
+              error_json ("Error Message",
+                          "The stand-in has no response for " + name),
+              0,  "missing"};
+    }
+
+
+    static bool  send_all  (int const  fd,  string_view  s)
+    {
+      while (! s.empty ())
+        {
+          auto const  n  {::send (fd,  s.data (),  s.size (),  MSG_NOSIGNAL)};
+          if (n <= 0)    return 0;
+          s.remove_prefix (n);
+        }
+      return 1;
+    }
+
+
+  public:
+
+    explicit Stand_In (Options const &o)  :  O {o},  random {o.seed}  {}
+
+
+    /** Answer the requests which come over the connection \a fd, until
+     *  the client closes it, and then close it ourselves. */
+    void  serve  (int const  fd)
+    {
+      string  buffer;
+      char  chunk [4096];
+
+      for (;;)
+        {
+          size_t  end;
+          while ((end = buffer.find ("\r\n\r\n")) == string::npos)
+            {
+              auto const  n  {::recv (fd,  chunk,  sizeof chunk,  0)};
+              if (n <= 0)    {  ::close (fd);  return;  }
+              buffer.append (chunk,  n);
+            }
+
+          auto const  request  {parse_request (string_view {buffer}
+                                                       .substr (0, end))};
+          buffer.erase (0,  end + 4);
+
+          auto const  response
+            {request  ?  respond (*request)
+                      :  Response {405,  "Only GET is served here",  0,
+                                   "refused"}};
+
+          cerr << (request  ?  request->target  :  string {"?"}) << "  ->  "
+               << response.source << ' ' << response.status << '\n';
+
+          this_thread::sleep_for (O.latency);
+
+          if (response.drop)    break;
+
+          char const *const  reason
+            {response.status == 200  ?  "OK"
+             :  response.status == 404  ?  "Not Found"
+             :  response.status == 405  ?  "Method Not Allowed"
+             :  response.status == 502  ?  "Bad Gateway"
+             :  "Service Unavailable"};
+
+          auto const  type
+            {response.body.empty ()  ||  response.body [0] != '{'
+                   ?  "text/csv"  :  "application/json"};
+
+          ostringstream  head;
+          head << "HTTP/1.1 " << response.status << ' ' << reason << "\r\n"
+               << "Content-Type: " << type << "\r\n"
+               << "Content-Length: " << response.body.size () << "\r\n"
+               << (request && ! request->close  ?  ""
+                                                :  "Connection: close\r\n")
+               << "\r\n";
+
+          if (! send_all (fd,  head.str ())
+                 ||  ! send_all (fd,  response.body)
+                 ||  ! request  ||  request->close)
+            break;
+        }
+
+      ::close (fd);
+    }
+
+  };  /* End of class Stand_In. */
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+
+int main (int argc, char **argv)
+try
+  {
+    namespace TD  =  DMBCS::Trader_Desk;
+
+    TD::Options  O;
+
+    for (int a = 1;  a < argc;  ++a)
+      {
+        std::string const  arg  {argv [a]};
+
+        if (arg == "--port"  &&  a + 1 < argc)
+          O.port = std::stoul (argv [++a]);
+        else if (arg == "--replay"  &&  a + 1 < argc)
+          O.replay = argv [++a];
+        else if (arg == "--record"  &&  a + 1 < argc)
+          O.record = argv [++a];
+        else if (arg == "--upstream"  &&  a + 1 < argc)
+          O.upstream = argv [++a];
+        else if (arg == "--synthesize")
+          O.synthesize = 1;
+        else if (arg == "--history"  &&  a + 1 < argc)
+          O.history = std::stoul (argv [++a]);
+        else if (arg == "--fixed-dates")
+          O.fixed_dates = 1;
+        else if (arg == "--latency"  &&  a + 1 < argc)
+          O.latency = std::chrono::milliseconds {std::stoul (argv [++a])};
+        else if (arg == "--calls-per-minute"  &&  a + 1 < argc)
+          O.calls_per_minute = std::stoul (argv [++a]);
+        else if (arg == "--error-rate"  &&  a + 1 < argc)
+          O.error_rate = std::stod (argv [++a]);
+        else if (arg == "--seed"  &&  a + 1 < argc)
+          O.seed = std::stoul (argv [++a]);
+        else
+          {
+            std::cerr << "usage: market-data-stand-in [--port N]"
+                         " [--replay DIR] [--record DIR] [--upstream URL]\n"
+                         "          [--synthesize] [--history DAYS]"
+                         " [--fixed-dates] [--latency MS]\n"
+                         "          [--calls-per-minute N]"
+                         " [--error-rate P] [--seed N]\n";
+            return  arg == "--help"  ?  0  :  1;
+          }
+      }
+
+    if (! O.record.empty ())
+      std::filesystem::create_directories (O.record);
+
+    curlpp::Cleanup  curl_lifetime;
+
+    int const  listener  {::socket (AF_INET,  SOCK_STREAM,  0)};
+    int const  yes  {1};
+    ::setsockopt (listener,  SOL_SOCKET,  SO_REUSEADDR,  &yes,  sizeof yes);
+
+    sockaddr_in  address  {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons (O.port);
+    address.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+
+    if (listener < 0
+           ||  ::bind (listener,  (sockaddr*) &address,  sizeof address) < 0
+           ||  ::listen (listener,  64) < 0)
+      throw std::runtime_error {"cannot listen on port "
+                                  + std::to_string (O.port)};
+
+    std::cerr << "market-data-stand-in: serving http://localhost:"
+              << O.port << "/query\n";
+
+    TD::Stand_In  stand_in  {O};
+
+    for (;;)
+      {
+        int const  fd  {::accept (listener,  nullptr,  nullptr)};
+        if (fd < 0)    continue;
+        std::thread  {[&stand_in, fd]  { stand_in.serve (fd); }}.detach ();
+      }
+  }
+
+catch (std::exception const &e)
+  {
+    std::cerr << "market-data-stand-in: " << e.what () << ".\n";
+    std::exit (1);
+  }
@@ -0,0 +1,333 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <bench/bench-report.h>
+#include <bench/daily-csv.h>
+#include <bench/synthetic-prices.h>
+#include <trader-desk/alpha-vantage.h>
+#include <trader-desk/sd-envelope-analyzer.h>
+#include <trader-desk/text.h>
+#include <iostream>
+#include <random>
+
+
+/** \file
+ *
+ *  The \c micro-bench program, which times the core time-series and
+ *  analysis code over synthetic price histories, without needing a
+ *  display or a database, and writes the results to standard output as
+ *  JSON (see \c Bench_Report).  Run it through \c make \c bench. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  /** Keep the compiler from optimizing away a computation whose result
+   *  we do not otherwise use. */
+  template <typename T>
+  inline void  keep  (T const &x)
+  {
+    asm volatile (""  :  :  "g" (&x)  :  "memory");
+  }
+
+
+  /** Times, \a n of them, spread over the span of the \a series, in an
+   *  order which is the same every time. */
+  static vector <Time_Point>  probe_times  (Time_Series const &series,
+                                            size_t const n)
+  {
+    mt19937_64  r  {7};
+    auto const  start  {series.back ().time};
+    auto const  span   {(series.front ().time - start).count ()};
+
+    vector <Time_Point>  ret;
+    ret.reserve (n);
+    for (size_t i = 0;  i < n;  ++i)
+      ret.push_back (start  +  Duration {Duration::rep (r () % (span + 1))});
+
+    return ret;
+  }
+
+
+
+  static void  time_series_cases  (Bench_Report &report,
+                                   vector <size_t> const &sizes)
+  {
+    for (auto const pattern : Synthetic_Prices::PATTERNS)
+      for (auto const size : sizes)
+        {
+          auto const  series  {Synthetic_Prices::make (pattern,  size)};
+
+          Bench_Report::Parameters const
+                    P  {{"pattern",  Synthetic_Prices::name (pattern)},
+                        {"size",     double (size)}};
+
+          /* New events are put into a fresh copy of the series each time,
+           * at times which fall all over its span. */
+          {
+            size_t const  n  {100};
+            vector <Event>  events;
+            for (auto const &t : probe_times (series, n))
+              events.emplace_back (t + chrono::seconds {1},  100.0);
+
+            report.run ("Time_Series::insert_event",  P,  n,
+                        [&]
+                        {
+                          auto  s  {series};
+                          return Bench_Report::time_of
+                                   ([&]  { for (auto const &e : events)
+                                             s.insert_event (e); });
+                        });
+          }
+
+          /* A month, a year, and (as zero) the whole series. */
+          for (auto const days : {30,  365,  0})
+            {
+              auto  Q  {P};
+              Q.emplace_back ("window_days",  double (days));
+
+              Duration const  window  {chrono::hours {24 * days}};
+
+              size_t const  n  {20};
+
+              report.run ("Time_Series::get_range",  Q,  n,
+                          [&]
+                          {
+                            return Bench_Report::time_of
+                                     ([&]
+                                      {
+                                        for (size_t i = 0;  i < n;  ++i)
+                                          keep (days  ?  series.get_range
+                                                                     (window)
+                                                      :  series.get_range ());
+                                      });
+                          });
+            }
+
+          {
+            size_t const  n  {1000};
+            auto const  times  {probe_times (series,  n)};
+
+            report.run ("Time_Series::interpolated_value",  P,  n,
+                        [&]
+                        {
+                          return Bench_Report::time_of
+                                   ([&]  { for (auto const &t : times)
+                                             keep (series.interpolated_value
+                                                                       (t)); });
+                        });
+          }
+
+          /* The moving average, and the standard deviation about it, as
+           * the SD envelope analyzer computes them over the whole
+           * history with the default 30-day window. */
+          {
+            auto const  window    {Duration {chrono::hours {24 * 30}}};
+            auto const  earliest  {series.back ().time};
+
+            report.run ("Time_Series::compute_moving_average",  P,  1,
+                        [&]
+                        {
+                          return Bench_Report::time_of
+                                   ([&]  { keep (Time_Series::
+                                                   compute_moving_average
+                                                     (series,  window,
+                                                      earliest)); });
+                        });
+
+            report.run ("SD_Envelope_Analyzer::standard_deviation",  P,  1,
+                        [&]
+                        {
+                          return Bench_Report::time_of
+                                   ([&]
+                                    {
+                                      auto const  mean
+                                        {Time_Series::compute_moving_average
+                                                 (series,  window,  earliest)};
+                                      keep (SD_Envelope_Analyzer::
+                                                standard_deviation
+                                                   (series,  mean,  earliest));
+                                    });
+                        });
+          }
+        }
+  }
+
+
+
+  /** Labels as the chart makes them: tide marks crowded against the
+   *  right-hand side at prices near each other, and a few elsewhere. */
+  static Text  crowd  (size_t const n,  uint64_t const seed)
+  {
+    mt19937_64  r  {seed};
+    auto const  u  {[&r] { return (r () >> 11) * 0x1.0p-53; }};
+
+    Text  ret;
+
+    for (size_t i = 0;  i < n;  ++i)
+      {
+        auto const  x  {i % 5  ?  720.0 + 40.0 * u ()  :  800.0 * u ()};
+        auto const  y  {i % 5  ?  250.0 + 100.0 * u ()  :  600.0 * u ()};
+
+        ret += Text::Item {"123.45",  Colour::PRICE_TIDES,
+                           {x, y},  {36.0 + 12.0 * u (),  10.0}};
+      }
+
+    return ret;
+  }
+
+
+
+  static void  text_cases  (Bench_Report &report,
+                            vector <size_t> const &counts)
+  {
+    Text::Boundary const  B  {0.0,  800.0,  0.0,  600.0};
+
+    for (auto const n : counts)
+      {
+        auto const  labels  {crowd (n,  1)};
+
+        report.run ("Text::arrange",  {{"labels",  double (n)}},  1,
+                    [&]
+                    {
+                      auto  t  {labels};
+                      return Bench_Report::time_of
+                                      ([&]  { keep (t.arrange (B)); });
+                    });
+      }
+  }
+
+
+
+
+  /** Reading an AlphaVantage daily time-series response of \a years of
+   *  trading days, both for a company we have no prices for yet and for
+   *  one which is only a week out of date, by the parser and by the one
+   *  it replaced. */
+  static void  csv_cases  (Bench_Report &report,
+                           vector <size_t> const &years)
+  {
+    typedef  void  Parse  (Update_Closing_Prices::Company const &,
+                           string const &,
+                           function <void (Update_Closing_Prices::Data
+                                                                const &)>);
+
+    pair <char const *,  Parse *>  const  parsers []
+      {{"Alpha_Vantage::parse_closing_prices",
+        Alpha_Vantage::parse_closing_prices},
+       {"legacy_parse_closing_prices",  legacy_parse_closing_prices}};
+
+    for (auto const y : years)
+      {
+        auto const  series  {Synthetic_Prices::make
+                                   (Synthetic_Prices::Pattern::RANDOM_WALK,
+                                    252 * y)};
+        auto const  csv  {daily_csv (series)};
+
+        for (auto const new_days : {series.size (),  size_t {5}})
+          {
+            Update_Closing_Prices::Company const  company
+              {"Bench",  "BNCH",  1,
+               new_days < series.size ()
+                  ?  chrono::system_clock::to_time_t (series [new_days].time)
+                  :  0};
+
+            Bench_Report::Parameters const
+                      P  {{"years",     double (y)},
+                          {"bytes",     double (csv.size ())},
+                          {"new_days",  double (new_days)}};
+
+            for (auto const &p : parsers)
+              report.run (p.first,  P,  1,
+                          [&]
+                          {
+                            size_t  rows  {0};
+                            auto const  ns  {Bench_Report::time_of
+                                  ([&]
+                                   {
+                                     p.second (company,  csv,
+                                               [&rows] (Update_Closing_Prices
+                                                               ::Data const &)
+                                               { ++rows; });
+                                   })};
+                            keep (rows);
+                            return ns;
+                          });
+          }
+      }
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+
+int main (int argc, char **argv)
+try
+  {
+    namespace TD  =  DMBCS::Trader_Desk;
+
+    unsigned  samples  {15};
+    std::string  filter;
+    bool  quick  {0};
+
+    for (int a = 1;  a < argc;  ++a)
+      {
+        std::string const  arg  {argv [a]};
+
+        if (arg == "--samples"  &&  a + 1 < argc)
+          samples = std::stoul (argv [++a]);
+        else if (arg == "--filter"  &&  a + 1 < argc)
+          filter = argv [++a];
+        else if (arg == "--quick")
+          quick = 1;
+        else
+          {
+            std::cerr << "usage: micro-bench [--samples N] [--filter NAME]"
+                                                          " [--quick]\n";
+            return  arg == "--help"  ?  0  :  1;
+          }
+      }
+
+    TD::Bench_Report  report  {"micro",  samples,  filter};
+
+    TD::time_series_cases (report,
+                           quick  ?  std::vector <size_t> {250,  2500}
+                                  :  std::vector <size_t> {250,  2500,
+                                                           25000,  250000});
+
+    TD::text_cases (report,
+                    quick  ?  std::vector <size_t> {10,  50}
+                           :  std::vector <size_t> {10,  50,  200});
+
+    TD::csv_cases (report,
+                   quick  ?  std::vector <size_t> {1,  20}
+                          :  std::vector <size_t> {1,  5,  20});
+
+    report.write (std::cout);
+
+    return 0;
+  }
+
+catch (std::exception const &e)
+  {
+    std::cerr << e.what () << ".\n";
+    std::exit (1);
+  }
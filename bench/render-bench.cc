@@ -0,0 +1,351 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <bench/bench-report.h>
+#include <bench/synthetic-prices.h>
+#include <trader-desk/chart-grid.h>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+
+/** \file
+ *
+ *  The \c render-bench program, which times the drawing of charts and of
+ *  the market grid onto off-screen Cairo surfaces, without a display or
+ *  a database.  Scripted sequences of mouse movements stand in for the
+ *  user, and the time taken by each frame is recorded; the percentiles
+ *  of these are written to standard output as JSON (see \c
+ *  Bench_Report).  Run it through \c make \c bench. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  /** Run the GLib main loop until nothing has happened on it for a while,
+   *  so that the results of work on the worker pool have all been
+   *  delivered.  This stands in for the idle time between frames. */
+  static void  settle  (chrono::milliseconds const quiet
+                                                 = chrono::milliseconds {30})
+  {
+    auto  last  {chrono::steady_clock::now ()};
+
+    while (chrono::steady_clock::now () - last  <  quiet)
+      if (g_main_context_iteration (nullptr,  FALSE))
+        last = chrono::steady_clock::now ();
+      else
+        this_thread::sleep_for (chrono::milliseconds {1});
+  }
+
+
+
+  /** Give the \a data the \a series of prices, all of it in view, as
+   *  though a company had just been loaded. */
+  static void  load  (Chart_Data &data,
+                      Time_Series const &series,
+                      string const &name)
+  {
+    {
+      lock_guard  l  {data.prices_mutex};
+      data.company_name     =  name;
+      data.prices           =  series;
+      data.last_fetch_time  =  series.back ().time;
+      data.extremes         =  data.prices.get_range ();
+    }
+
+    data.note_change (Chart_Data::Change::NEW_COMPANY
+                        |  Chart_Data::Change::RANGE);
+    data.flush_changes ();
+  }
+
+
+
+  /** What the user does to a chart between two frames.  Frame \a f of \a
+   *  n is about to be drawn on a chart \a width by \a height. */
+  typedef  function <void (Chart_Renderer &,
+                           unsigned f,  unsigned n,
+                           int width,  int height)>  Script;
+
+
+  /** The scripts, by name. */
+  static vector <pair <string, Script>>  const  SCRIPTS
+    {
+      /* Nothing happens: every frame is drawn from the cached layers. */
+      {"redraw",
+       [] (Chart_Renderer &,  unsigned,  unsigned,  int,  int)  {}},
+
+      /* The mouse sweeps across the chart from left to right, weaving up
+       * and down, with the cross-hairs following it. */
+      {"cross-hair",
+       [] (Chart_Renderer &c,  unsigned const f,  unsigned const n,
+           int const w,  int const h)
+       {
+         c.pointer_moved (50.0 + (w - 60.0) * f / n,
+                          h * (0.4 + 0.3 * sin (f * 0.1)));
+       }},
+
+      /* The user drags out a delta region, releases it and starts
+       * another, every twenty frames. */
+      {"delta-drag",
+       [] (Chart_Renderer &c,  unsigned const f,  unsigned,
+           int const w,  int const h)
+       {
+         auto const  step  {f % 20};
+         auto const  x  {w * 0.2  +  w * 0.03 * step};
+         auto const  y  {h * 0.5  -  h * 0.01 * step};
+
+         if (step == 0)          c.button_down (x, y);
+         c.pointer_moved (x, y);
+         if (step == 19)         c.button_up (x, y);
+       }},
+    };
+
+
+
+  static void  chart_cases  (Bench_Report &report,
+                             vector <size_t> const &lengths,
+                             unsigned const frames)
+  {
+    if (! report.wanted ("Chart_Renderer::render"))    return;
+
+    auto  preferences  {Preferences::defaults ()};
+
+    struct Style  {  char const *name;  uint32_t features;  int w,  h;  };
+
+    for (auto const &style
+            :  {Style {"thumb",  Chart::Style::THUMB,
+                       Chart_Grid::THUMB_WIDTH,  Chart_Grid::THUMB_HEIGHT},
+                Style {"hand-analysis",  Chart::Style::HAND_ANALYSIS,
+                       1200,  800}})
+      for (auto const length : lengths)
+        for (auto const &script : SCRIPTS)
+          {
+            /* Thumbnails do not respond to the mouse. */
+            if (style.features == Chart::Style::THUMB
+                    &&  script.first != "redraw")
+              continue;
+
+            Chart_Renderer  chart  {style.features,  preferences};
+
+            load (chart.data,
+                  Synthetic_Prices::make
+                          (Synthetic_Prices::Pattern::RANDOM_WALK,  length),
+                  "SYNTHETIC PLC");
+
+            auto const  surface  {Cairo::ImageSurface::create
+                                        (Cairo::FORMAT_ARGB32,
+                                         style.w,  style.h)};
+            auto const  cairo  {Cairo::Context::create (surface)};
+
+            /* The first frame sets off the analyzers; their results are
+             * in before we start timing. */
+            chart.render (cairo,  style.w,  style.h);
+            settle ();
+
+            vector <double>  times;
+            times.reserve (frames);
+
+            for (unsigned f = 0;  f < frames;  ++f)
+              {
+                script.second (chart,  f,  frames,  style.w,  style.h);
+
+                times.push_back
+                  (chrono::duration <double, nano>
+                     (Bench_Report::time_of
+                          ([&]  { chart.render (cairo,  style.w,  style.h); }))
+                   .count ());
+
+                /* Deliver anything the analyzers have finished, as the
+                 * main loop would between frames. */
+                while (g_main_context_iteration (nullptr,  FALSE))    ;
+              }
+
+            report.add ("Chart_Renderer::render",
+                        {{"style",   style.name},
+                         {"script",  script.first},
+                         {"length",  double (length)},
+                         {"width",   double (style.w)},
+                         {"height",  double (style.h)}},
+                        1,
+                        move (times));
+          }
+  }
+
+
+
+  /** Time the frames of the market grid as the user scrolls down through
+   *  \a companies thumbnails and back up again, a row at a time, with the
+   *  thumbnails being rendered on the worker pool meanwhile. */
+  static void  grid_cases  (Bench_Report &report,
+                            vector <size_t> const &lengths,
+                            size_t const companies,
+                            unsigned const frames)
+  {
+    if (! report.wanted ("Thumbnail_Atlas frame"))    return;
+
+    int const  width  {1200},  height  {800};
+    int const  cell_w  {Chart_Grid::THUMB_WIDTH};
+    int const  cell_h  {Chart_Grid::THUMB_HEIGHT};
+    int const  columns  {width / cell_w};
+    int const  rows  {int ((companies + columns - 1) / columns)};
+    int const  visible  {min (rows,  height / cell_h + 1)};
+
+    for (auto const length : lengths)
+      {
+        vector <unique_ptr <Chart_Data>>  data;
+        for (size_t i = 0;  i < companies;  ++i)
+          {
+            data.push_back (make_unique <Chart_Data> ());
+            ostringstream  name;
+            name << "COMPANY " << i;
+            load (*data.back (),
+                  Synthetic_Prices::make
+                       (Synthetic_Prices::PATTERNS [i % 4],  length,  i + 1),
+                  name.str ());
+          }
+
+        Thumbnail_Atlas  atlas;
+        atlas.arrange (companies,  columns,  cell_w,  cell_h);
+
+        auto const  surface  {Cairo::ImageSurface::create
+                                    (Cairo::FORMAT_ARGB32,  width,  height)};
+        auto const  cairo  {Cairo::Context::create (surface)};
+
+        auto const  frame  {[&] (int const first)
+                            {
+                              atlas.hold_rows (first,  visible);
+
+                              for (int r = first;  r < first + visible;  ++r)
+                                for (int c = 0;  c < columns;  ++c)
+                                  if (size_t (r * columns + c) < companies)
+                                    atlas.update (r * columns + c,
+                                                  *data [r * columns + c],
+                                                  [] {});
+
+                              cairo->save ();
+                              cairo->translate (0,  -first * cell_h);
+                              atlas.paint (cairo);
+                              cairo->restore ();
+                            }};
+
+        vector <double>  times;
+        times.reserve (frames);
+
+        int const  travel  {max (1,  rows - visible)};
+
+        for (unsigned f = 0;  f < frames;  ++f)
+          {
+            /* Down to the bottom, and back up to the top. */
+            auto const  phase  {int (f % (2 * travel))};
+            auto const  first  {phase < travel  ?  phase  :  2 * travel - phase};
+
+            times.push_back (chrono::duration <double, nano>
+                                (Bench_Report::time_of ([&] { frame (first); }))
+                             .count ());
+
+            while (g_main_context_iteration (nullptr,  FALSE))    ;
+          }
+
+        report.add ("Thumbnail_Atlas frame",
+                    {{"script",     "scroll"},
+                     {"length",     double (length)},
+                     {"companies",  double (companies)},
+                     {"width",      double (width)},
+                     {"height",     double (height)}},
+                    1,
+                    move (times));
+
+        /* The thumbnails still being rendered must be finished with
+         * before their data go. */
+        atlas.clear ();
+        settle ();
+      }
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+
+/** Parse a comma-separated list of sizes. */
+static std::vector <size_t>  sizes  (std::string const &list)
+{
+  std::vector <size_t>  ret;
+  std::istringstream  in  {list};
+  for (std::string  s;  std::getline (in, s, ',');  )
+    ret.push_back (std::stoul (s));
+  return ret;
+}
+
+
+
+int main (int argc, char **argv)
+try
+  {
+    namespace TD  =  DMBCS::Trader_Desk;
+
+    std::vector <size_t>  lengths  {250,  2500,  25000};
+    size_t  companies  {500};
+    unsigned  frames  {200};
+    std::string  filter;
+
+    for (int a = 1;  a < argc;  ++a)
+      {
+        std::string const  arg  {argv [a]};
+
+        if (arg == "--lengths"  &&  a + 1 < argc)
+          lengths = sizes (argv [++a]);
+        else if (arg == "--companies"  &&  a + 1 < argc)
+          companies = std::stoul (argv [++a]);
+        else if (arg == "--frames"  &&  a + 1 < argc)
+          frames = std::stoul (argv [++a]);
+        else if (arg == "--filter"  &&  a + 1 < argc)
+          filter = argv [++a];
+        else if (arg == "--quick")
+          {
+            lengths = {250,  2500};
+            companies = 100;
+            frames = 50;
+          }
+        else
+          {
+            std::cerr << "usage: render-bench [--lengths N,N...]"
+                         " [--companies N] [--frames N] [--filter NAME]"
+                         " [--quick]\n";
+            return  arg == "--help"  ?  0  :  1;
+          }
+      }
+
+    TD::Bench_Report  report  {"render",  frames,  filter};
+
+    TD::chart_cases (report,  lengths,  frames);
+    TD::grid_cases (report,  lengths,  companies,  frames);
+
+    report.write (std::cout);
+
+    return 0;
+  }
+
+catch (std::exception const &e)
+  {
+    std::cerr << e.what () << ".\n";
+    std::exit (1);
+  }
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <bench/synthetic-prices.h>
+#include <cmath>
+#include <random>
+
+
+/** \file
+ *
+ *  Implementation of the \c Synthetic_Prices class. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  /* Friday 3rd January 2020. */
+  static constexpr int64_t const  LATEST_DAY  {18264};
+
+
+  Duration const  Synthetic_Prices::MARKET_CLOSE
+                        {chrono::hours {16} + chrono::minutes {30}};
+
+  Time_Point const  Synthetic_Prices::LATEST
+                        {chrono::hours {24 * LATEST_DAY}  +  MARKET_CLOSE};
+
+
+
+  char const  *Synthetic_Prices::name  (Pattern const p)
+  {
+    switch (p)
+      {
+      case Pattern::RANDOM_WALK:   return "random-walk";
+      case Pattern::TRENDING:      return "trending";
+      case Pattern::CYCLIC:        return "cyclic";
+      case Pattern::GAPPY:         return "gappy";
+      }
+
+    return "?";
+  }
+
+
+
+  /** Uniform deviates on [0, 1), and normal deviates by the Box-Muller
+   *  method, from a fixed generator. */
+  struct Deviates
+  {
+    mt19937_64  engine;
+
+    explicit Deviates (uint64_t const seed)  :  engine {seed}  {}
+
+    double  uniform  ()   {  return (engine () >> 11) * 0x1.0p-53;  }
+
+    double  normal  ()
+    {
+      auto const  u  {1.0 - uniform ()};
+      return sqrt (-2.0 * log (u))  *  cos (2.0 * M_PI * uniform ());
+    }
+  };
+
+
+
+  Time_Series  Synthetic_Prices::make  (Pattern const pattern,
+                                        size_t const size,
+                                        uint64_t const seed)
+  {
+    Deviates  r  {seed};
+
+    /* Work backwards from the latest day, which is a Friday, skipping
+     * week-ends (day zero was a Thursday). */
+    vector <int64_t>  days;
+    days.reserve (size);
+
+    for (auto d = LATEST_DAY;  days.size () < size;  --d)
+      {
+        auto const  weekday  {((d + 4) % 7 + 7) % 7};
+        if (weekday == 0  ||  weekday == 6)    continue;
+
+        if (pattern == Pattern::GAPPY  &&  d != LATEST_DAY
+                &&  r.uniform () < 0.1)
+          continue;
+
+        days.push_back (d);
+      }
+
+    /* Now make the prices, oldest first. */
+    Time_Series  ret  {MARKET_CLOSE};
+    ret.resize (size);
+
+    double  price  {100.0};
+
+    for (size_t i = 0;  i < size;  ++i)
+      {
+        auto const  z  {r.normal ()};
+
+        switch (pattern)
+          {
+          case Pattern::RANDOM_WALK:
+            price *= exp (0.015 * z);
+            break;
+
+          case Pattern::TRENDING:
+            price *= exp (0.0008  +  0.01 * z);
+            break;
+
+          case Pattern::CYCLIC:
+            price  =  100.0  *  (1.0 + 0.2 * sin (2.0 * M_PI * i / 120.0))
+                             *  exp (0.005 * z);
+            break;
+
+          case Pattern::GAPPY:
+            price *= exp (0.015 * z);
+            if (r.uniform () < 0.01)
+              price *= r.uniform () < 0.5  ?  0.85  :  1.15;
+            break;
+          }
+
+        ret [size - 1 - i]
+              =  Event {Time_Point {chrono::hours {24 * days [size - 1 - i]}}
+                            +  MARKET_CLOSE,
+                        price};
+      }
+
+    return ret;
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
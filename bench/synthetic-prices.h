@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#ifndef DMBCS__TRADER_DESK__BENCH__SYNTHETIC_PRICES__H
+#define DMBCS__TRADER_DESK__BENCH__SYNTHETIC_PRICES__H
+
+
+#include <trader-desk/time-series.h>
+#include <cstdint>
+
+
+/** \file
+ *
+ *  Declaration of the \c Synthetic_Prices class, which makes up price
+ *  histories for the benchmarks. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  /** A source of made-up closing-price histories, one event per trading
+   *  day, which are the same every time for the same \c seed.  They end
+   *  at a fixed date, so that they do not depend on the clock either.
+   *
+   *  The random numbers are derived from \c mt19937_64 by our own
+   *  arithmetic rather than through the standard distributions, whose
+   *  algorithms vary between library implementations. */
+
+  struct Synthetic_Prices
+  {
+    /** The shapes of history we can make. */
+    enum class Pattern
+      {
+        /** Prices doing a geometric random walk. */
+        RANDOM_WALK,
+
+        /** A random walk with a steady upward drift. */
+        TRENDING,
+
+        /** A slow cycle, with a little noise on top. */
+        CYCLIC,
+
+        /** A random walk with one day in ten missing, and occasional
+         *  large jumps. */
+        GAPPY
+      };
+
+    /** All of the above, for iterating over. */
+    static constexpr Pattern const  PATTERNS []
+      {Pattern::RANDOM_WALK,  Pattern::TRENDING,
+       Pattern::CYCLIC,       Pattern::GAPPY};
+
+    /** The name of the pattern \a p, as it appears in reports. */
+    static char const  *name  (Pattern p);
+
+    /** The time of the last event in every history. */
+    static Time_Point const  LATEST;
+
+    /** The time after midnight at which our imaginary market closes. */
+    static Duration const  MARKET_CLOSE;
+
+
+    /** Make a history of \a size events in the \a pattern, newest first
+     *  as a \c Time_Series should be. */
+    static Time_Series  make  (Pattern,  size_t size,  uint64_t seed = 1);
+
+  };  /* End of class Synthetic_Prices. */
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+#endif  /* Undefined DMBCS__TRADER_DESK__BENCH__SYNTHETIC_PRICES__H. */
@@ -51,22 +51,17 @@ void  Alpha_Vantage__Monitor::Clocks::hit  ()
       {
         db.reconnect (db.current_preferences);
       }
-    
-    last_time  =  chrono::steady_clock::now ();
   }
 
 
 
-      static  int  seconds_since  (const chrono::steady_clock::time_point&  T)
-                 {    return  chrono::duration_cast<chrono::seconds>
-                                      (chrono::steady_clock::now () - T)
-                                 .count ();   }
-
       using  C  =  Alpha_Vantage__Monitor::Clocks;
 
 const  C&  C::update  ()
 {
   const time_t  now  {system_clock::to_time_t  (system_clock::now ())};
+  Rate_Limiter&  limiter
+                     {Alpha_Vantage::rate_limiter (db.current_preferences)};
  
   try
     {
@@ -77,10 +72,17 @@ const  C&  C::update  ()
       strikes
         =  db.scalar_result<int> (0, "select count(*) from alphavantage_ticks");
       strikes_.set_text  (to_string (strikes));
-      count_down.set_text  (to_string (max (0,
-                                            12 - seconds_since (last_time))));
+
+      /* The table sees the calls made from every machine which shares the
+       * database, which our own bucket may not know about. */
+      limiter.reconcile_day  (strikes);
     }
   catch  (Mysql::DB_Connection::Exception&)  {}
+
+  count_down.set_text  (to_string ((limiter.wait ().count () + 999) / 1000));
+
+  const unsigned  per_day  {db.current_preferences.market_data_calls_per_day};
+  finisher.set_text  (per_day  ?  "/" + to_string (per_day)  :  string {});
   
   return  *this;
 }
@@ -13,12 +13,12 @@ namespace DMBCS::Trader_Desk {
       using  Error       =  Alpha_Vantage::Error;
       using  Throttled   =  Alpha_Vantage::Throttled;
       using  Bad_API_Key =  Alpha_Vantage::Bad_API_Key;
+      using  Quota_Used_Up  =  Alpha_Vantage::Quota_Used_Up;
       using  TO_DO       =  Alpha_Vantage::TO_DO;
 
       struct  Clocks
       {
         DB  db;
-        chrono::steady_clock::time_point  last_time;
         int strikes {0};
 
         Gtk::Label  starter     {"AlphaVantage charge: "};
@@ -53,32 +53,60 @@ namespace DMBCS::Trader_Desk {
       static  void  remove_clock_widgets  (Gtk::Container&);
 
 
-      static  TO_DO  get_closing_prices   /* override */
+      static  TO_DO  fetch_closing_prices   /* override */
          (const Update_Closing_Prices::Company&  C,
           const string&  market_component_extension,
           Preferences&  P,
-          const function <void (const Update_Closing_Prices::Data&)>  injector)
+          string&  csv)
       {
         initialize_clocks  (P);
-        const TO_DO  ret  {Alpha_Vantage::get_closing_prices
-                                (C, market_component_extension, P, injector)};
+        const TO_DO  ret  {Alpha_Vantage::fetch_closing_prices
+                                (C, market_component_extension, P, csv)};
         if (ret == TO_DO::FINISHED)  clocks->hit ();
         return  ret;
       }
       
 
+      static  void  parse_closing_prices   /* override */
+         (const Update_Closing_Prices::Company&  C,
+          const string&  csv,
+          const function <void (const Update_Closing_Prices::Data&)>  injector)
+      {
+        Alpha_Vantage::parse_closing_prices  (C, csv, injector);
+      }
+      
+
+
+      static  constexpr  size_t  QUOTES_PER_CALL
+                                       {Alpha_Vantage::QUOTES_PER_CALL};
+
 
-      static  Update_Latest_Prices::Data  get_latest_data  /* override */
-                              (const Update_Latest_Prices::Company&  C,
-                               const string&  market_component_extension,
-                               Preferences&  P)
+      /* Every call admitted is a strike on the clocks. */
+      static  Rate_Limiter::Wait  admit  (Preferences&  P)
       {
         initialize_clocks  (P);
-        auto  ret  {Alpha_Vantage::get_latest_data
-                                        (C, market_component_extension, P)};
-        clocks->hit ();
+        const auto  ret  {Alpha_Vantage::admit (P)};
+        if  (ret == Rate_Limiter::Wait {0})   clocks->hit ();
         return  ret;
       }
+
+
+      static  string  latest_data_query   /* override */
+         (const vector<const Update_Latest_Prices::Company*>&  C,
+          const string&  market_component_extension,
+          const Preferences&  P)
+      {
+        return  Alpha_Vantage::latest_data_query
+                                      (C, market_component_extension, P);
+      }
+
+
+      static  vector<Update_Latest_Prices::Data>  parse_latest_data
+         (const vector<const Update_Latest_Prices::Company*>&  C,
+          const string&  response)
+      {
+        return  Alpha_Vantage::parse_latest_data  (C, response);
+      }
       
 
     } ;  /* End of class Alpha_Vantage__Monitor. */
@@ -19,33 +19,57 @@
 
 
 #include <trader-desk/alpha-vantage.h>
+#include <trader-desk/http-client.h>
 #include <trader-desk/time-series.h>  /* For time utilities. */
-#include <curlpp/Options.hpp>
-#include <curlpp/Easy.hpp>
 #include <fmt/format.h>
+#include <charconv>
 #include <regex>
+#include <thread>
 
 
 namespace DMBCS::Trader_Desk {
 
 
-static  bool  throttle  ()
+Rate_Limiter&  Alpha_Vantage::rate_limiter  (const Preferences&  P)
     {
-        namespace  C  =  chrono;
-        using  clock  =  C::system_clock;
+        const  Rate_Limiter::Budget  budget  {P.market_data_calls_per_minute,
+                                              P.market_data_calls_per_day};
+        static  Rate_Limiter  L  {"alphavantage",  budget};
+        L.set_budget  (budget);
+        return  L;
+    }
 
-        static  clock::time_point  LAST_CALL;
 
-        const  C::duration  wait  {clock::now ()  -  LAST_CALL};
-        if  (wait < C::seconds {12})
-          {
-            usleep  (min (number<C::microseconds> (C::seconds {12} - wait),
-                          number<C::microseconds> (C::milliseconds {500})));
-            return 1;
-          }
+auto  Alpha_Vantage::admit  (const Preferences&  P)  ->  Rate_Limiter::Wait
+    {
+        using  Wait  =  Rate_Limiter::Wait;
+
+        const  Wait  wait  {rate_limiter (P).try_acquire ()};
 
-        LAST_CALL  =  clock::now ();
-        return  0;
+        /* Only the day's budget can keep us waiting this long. */
+        if  (wait > chrono::minutes {1})
+              throw  Quota_Used_Up
+                        {"The day's allowance of calls to AlphaVantage "
+                         "has been used up"};
+
+        return  wait;
+    }
+
+
+    /* Returns 1 if we must wait before calling the server, having waited
+     * a little while (not more than half a second, so that the caller can
+     * keep an eye on other things); returns 0 having taken our ticket if
+     * we may go ahead now. */
+
+static  bool  throttle  (const Preferences&  P)
+    {
+        using  Wait  =  Rate_Limiter::Wait;
+
+        const  Wait  wait  {Alpha_Vantage::admit (P)};
+        if  (wait == Wait {0})   return  0;
+
+        this_thread::sleep_for  (min (wait,  Wait {500}));
+        return  1;
     }
       
 
@@ -68,55 +92,48 @@ static  void  throw_error  (const string&  query,  const string&  json)
 
 
 
+    /* Every request goes through the applicationʼs pool of HTTP
+     * connections, so that the connection to the server is kept open
+     * from one request to the next.  A server which answers with an error
+     * status has nothing to tell us about this company, which is the
+     * same as if it had said so in JSON. */
+
 static  string  get_curl_response  (const string&  query)
+  try
   {
-    namespace Curl  =  cURLpp;
-    namespace Opt   =  Curl::Options;
-
-    string      response;
-    Curl::Easy  request;
-            
-    request.setOpt (Opt::Url {query});
-
-    request.setOpt (Opt::WriteFunction 
-                       {[&response] (char* buffer,  size_t size,  size_t n) 
-                                    { response  +=  string {buffer, 
-                                                            buffer + size * n};
-                                      return  size * n; }});
-
-    request.setOpt (Opt::SslVerifyPeer {0});
-
-    request.perform ();
-
-    return  response;
+    return  Http_Client::shared ().get  (query);
+  }
+  catch (const Http_Client::Status_Error&  e)
+  {
+    throw  Alpha_Vantage::Error  {e.what ()};
   }
 
 
 
-    static  time_t  to_time_t  (const Update_Closing_Prices::Data&  D)
-                     {   return  t (D.year, D.month, D.day);   }
-
-    
     inline  string  maybe_dot  (const string&  X)
                      {   return  X.length ()  ?  '.' + X  :  X;    }
     
 
 
+    /* The queries go to the service named in the preferences, which is
+     * AlphaVantage itself unless the user has pointed us at a stand-in
+     * for it. */
+
     static  string  get_timeseries_csv
                              (const Update_Closing_Prices::Company&  company,
                               string  market_component_extension,
-                              const string&  api_key,
+                              const Preferences&  P,
                               const bool  over_100)
       {
         const string  query
-          {fmt::format ("https://www.alphavantage.co/query"
-                                       "?function=TIME_SERIES_DAILY_ADJUSTED"
+          {fmt::format ("{}?function=TIME_SERIES_DAILY_ADJUSTED"
                                        "&symbol={}"
                                        "&apikey={}"
                                        "&datatype=csv"
                                        "&outputsize={}",
+                        P.market_data_service,
                         company.symbol + maybe_dot (market_component_extension),
-                        api_key,
+                        P.market_data_service_key,
                         over_100 ? "full" : "compact")  };
 
         const string  ret  {get_curl_response (query)};
@@ -126,43 +143,120 @@ static  string  get_curl_response  (const string&  query)
         return ret;
       }
 
-    static  vector<string>  fields  (const string&  csv,  const char  separator)
-    {
-      vector<string>  ret;
-      for  (size_t cursor {0}; ; )
-        {
-          const size_t  next_cursor  {csv.find (separator, cursor)};
-          ret.push_back (csv.substr (cursor, next_cursor - cursor));
-          if  (next_cursor == csv.npos)   return  ret;
-          cursor = next_cursor + 1;
-        }
-    }
+    /* The responses are read in place, a field at a time, by these
+     * helpers.  Each takes what it wants from the front of ‘S’ and
+     * returns 1, or returns 0 and leaves ‘S’ alone if it is not there. */
 
-     static  istream&  operator>> (istream& I,  Update_Closing_Prices::Data&  D)
+    static  bool  take  (string_view&  S,  const char  c)
           {
-                 static  char  comma;
-                 static  double  dividend_amount,  split_coefficient;
+               if  (S.empty ()  ||  S.front () != c)   return  0;
+               S.remove_prefix (1);
+               return  1;
+          }
 
-                 I >> D.year >> comma >> D.month >> comma >> D.day >> comma
-                   >> D.open >> comma >> D.high >> comma
-                   >> D.low >> comma >> D.close >> comma
-                   >> D.adj_close >> comma >> D.volume >> comma
-                   >> dividend_amount >> comma >> split_coefficient;
+    static  bool  take  (string_view&  S,  int&  x)
+          {
+               const auto  [end, error]  {from_chars (S.data (),
+                                                      S.data () + S.size (),
+                                                      x)};
+               if  (error != errc {})   return  0;
+               S.remove_prefix (end - S.data ());
+               return  1;
+          }
 
-                 return  I;
+#if  __cpp_lib_to_chars >= 201611L
+
+    static  bool  take  (string_view&  S,  double&  x)
+          {
+               const auto  [end, error]  {from_chars (S.data (),
+                                                      S.data () + S.size (),
+                                                      x)};
+               if  (error != errc {})   return  0;
+               S.remove_prefix (end - S.data ());
+               return  1;
           }
 
-    static  vector<Update_Closing_Prices::Data>  parse_csv
-                     (const string&  results,  const int  company_seqid)
+#else
+
+    /* Libraries without from_chars for floating point (before gcc 11)
+     * get this, which reads the plain decimals the service sends.  With
+     * no more than 2^53 in the digits and 22 places of decimals both the
+     * digits and the power of ten are exact as doubles, so the one
+     * division gives the correctly rounded value, as from_chars would;
+     * anything else is refused.  Unlike strtod, it does not depend on
+     * the locale. */
+
+    static  bool  take  (string_view&  S,  double&  x)
           {
-               istringstream  O  {results.substr  (results.find  ('\n'))};
-               vector<Update_Closing_Prices::Data>  data;
-
-               for (;;)    {    Update_Closing_Prices::Data  datum;
-                                datum.company_seqid  =  company_seqid;
-                                O >> datum;
-                                if  (! O.good ())  return data;
-                                data.push_back (move (datum));    }
+               static constexpr  double  POWER_OF_TEN []
+                 {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,
+                  1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18,
+                  1e19, 1e20, 1e21, 1e22};
+
+               size_t  i  {S.size () && S [0] == '-'};
+               uint64_t  digits  {0};
+               int  n_digits  {0},  places  {-1};
+
+               for  (;  i < S.size ();  ++i)
+                 {
+                   if  (S [i] == '.'  &&  places < 0)
+                     {   places = 0;   continue;   }
+                   if  (S [i] < '0'  ||  S [i] > '9')   break;
+                   if  (++n_digits > 19)   return  0;
+                   digits  =  digits * 10  +  (S [i] - '0');
+                   if  (places >= 0)   ++places;
+                 }
+
+               if  (n_digits == 0  ||  digits > (uint64_t {1} << 53)
+                                   ||  places > 22)
+                     return  0;
+
+               x  =  digits / POWER_OF_TEN [max (places, 0)];
+               if  (S [0] == '-')   x  =  -x;
+               S.remove_prefix (i);
+               return  1;
+          }
+
+#endif
+
+bool  Alpha_Vantage::parse_daily_row  (string_view  R,
+                                       Update_Closing_Prices::Data&  D)
+   {
+      double  dividend_amount,  split_coefficient;
+
+      if  (! R.empty ()  &&  R.back () == '\r')   R.remove_suffix (1);
+
+      return  take (R, D.year)       &&  take (R, '-')
+          &&  take (R, D.month)      &&  take (R, '-')
+          &&  take (R, D.day)        &&  take (R, ',')
+          &&  take (R, D.open)       &&  take (R, ',')
+          &&  take (R, D.high)       &&  take (R, ',')
+          &&  take (R, D.low)        &&  take (R, ',')
+          &&  take (R, D.close)      &&  take (R, ',')
+          &&  take (R, D.adj_close)  &&  take (R, ',')
+          &&  take (R, D.volume)     &&  take (R, ',')
+          &&  take (R, dividend_amount)    &&  take (R, ',')
+          &&  take (R, split_coefficient)  &&  R.empty ();
+   }
+
+    /* Dates compared as yyyymmdd numbers, which saves going through
+     * mktime for every row.  (Wide enough for whatever a garbled
+     * response might hold.) */
+
+    static  int64_t  calendar_day  (const int64_t  year,
+                                    const int64_t  month,
+                                    const int64_t  day)
+          {    return  year * 10000  +  month * 100  +  day;    }
+
+    static  int64_t  calendar_day  (const Update_Closing_Prices::Data&  D)
+          {    return  calendar_day  (D.year, D.month, D.day);    }
+
+    static  int64_t  calendar_day  (const time_t  T)
+          {
+             tm  t;
+             localtime_r  (&T,  &t);
+             return  calendar_day  (t.tm_year + 1900,  t.tm_mon + 1,
+                                    t.tm_mday);
           }
 
     static  int  days_ago  (const time_t  T)
@@ -173,78 +267,130 @@ static  string  get_curl_response  (const string&  query)
                                / 24;
           }
 
-auto  Alpha_Vantage::get_closing_prices
+auto  Alpha_Vantage::fetch_closing_prices
           (const Update_Closing_Prices::Company&  company,
            const string&  market_component_extension,
            const Preferences&  P,
-           const function <void (const Update_Closing_Prices::Data&)>  injector)
+           string&  csv)
   ->  TO_DO
    {
-      if  (throttle  ())   return MORE_WORK;
+      if  (throttle  (P))   return MORE_WORK;
 
-      vector<Update_Closing_Prices::Data>  data
-              {parse_csv  (get_timeseries_csv
-                                    (company,
-                                     market_component_extension,
-                                     P.market_data_service_key,
-                                     days_ago (company.last_close_date) > 100),
-                           company.seqid)};
+      csv  =  get_timeseries_csv  (company,
+                                   market_component_extension,
+                                   P,
+                                   days_ago (company.last_close_date) > 100);
 
-      auto  i  {  find_if  (data.rbegin (),  data.rend (),
-                            [L = company.last_close_date]
-                                        (const Update_Closing_Prices::Data&  D)
-                                  {    return  to_time_t (D) > L;    })};
+      return  FINISHED;
+   }
 
-      if  (i != data.rbegin())  --i;
 
-      for  (auto j {i};  j != data.rend ();  ++j)
-                   injector  (*j);
 
-      return  FINISHED;
+void  Alpha_Vantage::parse_closing_prices
+          (const Update_Closing_Prices::Company&  company,
+           const string&  csv,
+           const function <void (const Update_Closing_Prices::Data&)>  injector)
+   {
+      /* After the header the rows run newest first, and we want to pass
+       * on, oldest first, those for the days since the companyʼs last
+       * close together with the row for that day itself (or just the
+       * newest row if there is nothing new).  So we first find where
+       * those rows end, reading no further than the first row which is
+       * not new, and then read them again from there backwards. */
+
+      string_view  rows  {csv};
+      const size_t  header_end  {rows.find ('\n')};
+      if  (header_end == rows.npos)   return;
+      rows.remove_prefix  (header_end + 1);
+
+      const int64_t  last_day  {calendar_day (company.last_close_date)};
+
+      Update_Closing_Prices::Data  datum;
+      datum.company_seqid  =  company.seqid;
+
+      size_t  wanted  {0};
+      for  (string_view  rest  {rows};  ! rest.empty ();  )
+        {
+          const size_t  eol  {rest.find ('\n')};
+          if  (! parse_daily_row  (rest.substr (0, eol),  datum))   break;
+          const size_t  length  {eol == rest.npos  ?  rest.size ()
+                                                   :  eol + 1};
+          wanted  +=  length;
+          rest.remove_prefix  (length);
+          if  (calendar_day (datum) <= last_day)   break;
+        }
+
+      for  (string_view  W  {rows.substr (0, wanted)};  ! W.empty ();  )
+        {
+          if  (W.back () == '\n')   W.remove_suffix (1);
+          const size_t  bol  {W.rfind ('\n') + 1};   /* npos + 1 == 0. */
+          parse_daily_row  (W.substr (bol),  datum);
+          injector  (datum);
+          W.remove_suffix  (W.size () - bol);
+        }
    }
 
 
 
-  static  string  get_snap_csv  (const Update_Latest_Prices::Company&  company,
-                                 const string&  market_component_extension,
-                                 const string&  api_key)
-  {
-    const auto  query  
-    { fmt::format  ("https://www.alphavantage.co/query"
-                                     "?function=GLOBAL_QUOTE"
+string  Alpha_Vantage::latest_data_query
+          (const vector<const Update_Latest_Prices::Company*>&  companies,
+           const string&  market_component_extension,
+           const Preferences&  P)
+   {
+      /* GLOBAL_QUOTE takes just the one symbol. */
+      return  fmt::format  ("{}?function=GLOBAL_QUOTE"
                                      "&symbol={}"
                                      "&datatype=csv"
                                      "&apikey={}",
-                    company.symbol + maybe_dot (market_component_extension),
-                    api_key)  };
+                            P.market_data_service,
+                            companies.front ()->symbol
+                                  + maybe_dot (market_component_extension),
+                            P.market_data_service_key);
+   }
 
-    const string  ret  {get_curl_response (query)};
-    if  (ret [0]  ==  '{')   throw_error  (query, ret);
-    return  ret;
-  }
 
-      inline  double  extract_price_csv  (const string&  X)
-      {
-        return  strtod  (fields  (fields  (X, '\n') [1],  ',') [4].data (),
-                         nullptr);
-      }
-    
 
-
-Update_Latest_Prices::Data  Alpha_Vantage::get_latest_data
-                               (const Update_Latest_Prices::Company&  company,
-                                const string&  market_component_extension,
-                                const Preferences&  P)
+vector<Update_Latest_Prices::Data>  Alpha_Vantage::parse_latest_data
+          (const vector<const Update_Latest_Prices::Company*>&  companies,
+           const string&  response)
    {
-      while  (throttle ())   ;
-
-      return
-        {  .company_seqid  =  company.seqid,
-           .time  =  chrono::system_clock::now (),
-           .price  =  extract_price_csv
-                             (get_snap_csv  (company,
-                                             market_component_extension,
-                                             P.market_data_service_key))   };
+      if  (response [0]  ==  '{')
+            throw_error  ("GLOBAL_QUOTE for " + companies.front ()->symbol,
+                          response);
+
+      vector<Update_Latest_Prices::Data>  ret;
+      const auto  now  {chrono::system_clock::now ()};
+
+      /* After the header there is a row for each company in turn, in
+       * which the price is the fifth field. */
+      string_view  S  {response};
+      const auto  skip_past  {[&S] (const char  c)
+                                {   const size_t  i  {S.find (c)};
+                                    S.remove_prefix (i == S.npos
+                                                       ?  S.size ()
+                                                       :  i + 1);   }};
+      skip_past ('\n');
+
+      for  (const auto *const  C  :  companies)
+        {
+          if  (S.empty ())   break;
+          string_view  row  {S.substr (0, S.find ('\n'))};
+          skip_past ('\n');
+
+          for  (int  field  {0};  field < 4;  ++field)
+            {
+              const size_t  i  {row.find (',')};
+              row.remove_prefix (i == row.npos  ?  row.size ()  :  i + 1);
+            }
+
+          double  price  {0.0};
+          if  (take (row, price)  &&  price > 0.0)
+                ret.push_back  ({.company_seqid  =  C->seqid,
+                                 .time  =  now,
+                                 .price  =  price});
+        }
+
+      return  ret;
    }
 
 
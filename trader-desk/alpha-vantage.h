@@ -24,6 +24,8 @@
 
 #include  <trader-desk/update-closing-prices.h>
 #include  <trader-desk/update-latest-prices.h>
+#include  <trader-desk/rate-limiter.h>
+#include  <string_view>
 
 
 namespace DMBCS::Trader_Desk {
@@ -43,20 +45,67 @@ struct  Alpha_Vantage
       struct  Error  :  runtime_error  { using  runtime_error::runtime_error; };
       struct  Throttled    :  Error    {   using  Error::Error;   };
       struct  Bad_API_Key  :  Error    {   using  Error::Error;   };
+      /* Our own budget of calls for the day has run out. */
+      struct  Quota_Used_Up  :  Throttled  { using  Throttled::Throttled; };
 
 
       enum  TO_DO  :  bool  {FINISHED = 0,  MORE_WORK = 1};
-      static  TO_DO  get_closing_prices   /* override */
+
+      /* Every call we make to the server is paid for from this, which
+       * is shared with all the other threads and processes using the
+       * service.  The budget is kept up to date with the preferences. */
+      static  Rate_Limiter&  rate_limiter  (const Preferences&);
+
+      /* Getting the closing prices is done in two parts, so that the
+       * parsing of one response can overlap the fetching of the next.
+       * The first gets the raw response into ‘csv’, unless we must wait
+       * before asking the server again, in which case MORE_WORK is
+       * returned and nothing is done. */
+      static  TO_DO  fetch_closing_prices   /* override */
          (const Update_Closing_Prices::Company&,
           const string&  market_component_extension,
           const Preferences&  P,
+          string&  csv);
+
+      /* The second passes those days in the ‘csv’ which are new to the
+       * company to the injector, oldest first. */
+      static  void  parse_closing_prices   /* override */
+         (const Update_Closing_Prices::Company&,
+          const string&  csv,
           const function <void (const Update_Closing_Prices::Data&)>  injector);
 
+      /* Read one row of a daily time-series csv response, without its
+       * line ending, into ‘D’ (all but the company_seqid).  Returns 0 if
+       * the row is not well formed.  This is the whole of the parsing
+       * done for the above; it does not allocate, and keeps no state. */
+      static  bool  parse_daily_row  (string_view  row,
+                                      Update_Closing_Prices::Data&  D);
+
+
+      /* Take a ticket to call the server and return zero if we may go
+       * ahead now, or else return how long to wait before asking again.
+       * Throws Quota_Used_Up if the day's budget has gone. */
+      static  Rate_Limiter::Wait  admit  (const Preferences&);
+
+
+      /* The latest prices for a market are fetched by putting many calls
+       * in flight at once, as fast as admit allows.  A provider which
+       * takes batch quotes would ask after many companies in each call;
+       * AlphaVantage have withdrawn theirs, so for us it is one. */
+      static constexpr  size_t  QUOTES_PER_CALL  {1};
+
+      /* The URL which asks for the latest prices of the ‘companies’ (no
+       * more than QUOTES_PER_CALL of them). */
+      static  string  latest_data_query   /* override */
+         (const vector<const Update_Latest_Prices::Company*>&  companies,
+          const string&  market_component_extension,
+          const Preferences&);
 
-      static  Update_Latest_Prices::Data  get_latest_data  /* override */
-                              (const Update_Latest_Prices::Company&,
-                               const string&  market_component_extension,
-                               const Preferences&);
+      /* Read the ‘response’ to the above; there is a datum for each of
+       * the companies, in the same order, for which a price was given. */
+      static  vector<Update_Latest_Prices::Data>  parse_latest_data
+         (const vector<const Update_Latest_Prices::Company*>&  companies,
+          const string&  response);
       
 
   } ;  /* End of class Alpha_Vantage. */
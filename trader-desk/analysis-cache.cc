@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <trader-desk/analysis-cache.h>
+#include <algorithm>
+
+
+/** \file
+ *
+ *  Implementation of the \c Analysis_Cache class. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  shared_ptr <void const>  Analysis_Cache::find_  (Key const &k)
+  {
+    auto const  i  {find_if (begin (entries),  end (entries),
+                             [&k] (auto const &e)  { return e.first == k; })};
+
+    if (i == end (entries))    return  nullptr;
+
+    entries.splice (begin (entries),  entries,  i);
+
+    return  entries.front ().second;
+  }
+
+
+
+  void  Analysis_Cache::insert_  (Key const &k,  shared_ptr <void const>  r)
+  {
+    if (find_ (k))
+      {
+        entries.front ().second  =  move (r);
+        return;
+      }
+
+    entries.emplace_front (k,  move (r));
+
+    if (entries.size () > capacity)    entries.pop_back ();
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
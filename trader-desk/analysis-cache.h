@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#ifndef DMBCS__TRADER_DESK__ANALYSIS_CACHE__H
+#define DMBCS__TRADER_DESK__ANALYSIS_CACHE__H
+
+
+#include <trader-desk/time-series.h>
+#include <list>
+#include <memory>
+#include <string>
+
+
+/** \file
+ *
+ *  Declaration of the \c Analysis_Cache class. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  /** A small, least-recently-used store of analytical results, owned by
+   *  the \c Analyzer_Stack and shared by all its analyzers.  A result is
+   *  filed under a \c Key which captures everything the computation
+   *  depended on; if an analyzer finds that its inputs match a key
+   *  already in the cache it can use the stored result rather than
+   *  computing a new one (for example when the user flicks a slider back
+   *  to a previous position, or returns to a company already looked at).
+   *
+   *  The cache is only used in the GTK thread, and so does no locking.
+   *  The results are immutable once stored, and are handed out as shared
+   *  pointers so that they survive eviction for as long as they are
+   *  being drawn. */
+
+  class Analysis_Cache
+  {
+  public:
+
+    /** Everything a computation depends on. */
+    struct Key
+    {
+      /** Identifies the analyzer (and so the type of result). */
+      string  analyzer;
+
+      /** The \c Chart_Data::prices_version of the input series. */
+      uint64_t  series_version  {0};
+
+      /** The visible range of the chart at the time of computation. */
+      Time_Point  start_time;
+      Time_Point  end_time;
+
+      /** Any parameters the analyzer takes from the user. */
+      vector <double>  parameters;
+
+      bool operator==  (Key const &k)  const
+      {
+        return  series_version == k.series_version
+                  &&  start_time == k.start_time
+                  &&  end_time == k.end_time
+                  &&  parameters == k.parameters
+                  &&  analyzer == k.analyzer;
+      }
+    };
+
+
+  private:
+
+    /** The stored results, most recently used first. */
+    list <pair <Key,  shared_ptr <void const>>>  entries;
+
+    /** The maximum size of \c entries. */
+    size_t  capacity;
+
+    /** Find the entry under \a k, move it to the front of \c entries and
+     *  return its result, or \c nullptr if there is no such entry. */
+    shared_ptr <void const>  find_  (Key const &k);
+
+    /** Put the result \a r at the front of \c entries, under the key \a k,
+     *  evicting the least recently used entry if necessary. */
+    void  insert_  (Key const &k,  shared_ptr <void const>  r);
+
+
+  public:
+
+    /** Create an empty cache which will hold at most \a capacity
+     *  results. */
+    explicit Analysis_Cache  (size_t const  capacity = 32)
+      :  capacity {capacity}
+    {}
+
+
+    /** Return the result filed under \a k, or \c nullptr.  The caller
+     *  asserts that all results stored under keys with the same \c
+     *  analyzer name are of type \a Result. */
+    template <typename Result>
+    shared_ptr <Result const>  find  (Key const &k)
+    {  return  static_pointer_cast <Result const>  (find_ (k));  }
+
+
+    /** File the result \a r under the key \a k. */
+    template <typename Result>
+    void  insert  (Key const &k,  shared_ptr <Result const>  r)
+    {  insert_  (k,  move (r));  }
+
+
+    /** Forget everything. */
+    void  clear  ()   {  entries.clear ();  }
+
+  };  /* End of class Analysis_Cache. */
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+#endif  /* Undefined DMBCS__TRADER_DESK__ANALYSIS_CACHE__H. */
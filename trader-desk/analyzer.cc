@@ -19,7 +19,10 @@
 
 
 #include <trader-desk/delta-analyzer.h>
+#include <trader-desk/macd-analyzer.h>
+#include <trader-desk/rsi-analyzer.h>
 #include <trader-desk/sd-envelope-analyzer.h>
+#include <trader-desk/stochastic-analyzer.h>
 
 
 /** \file
@@ -36,7 +39,10 @@ namespace DMBCS::Trader_Desk {
 
   Analyzer_Stack::Analyzer_Stack  (Chart_Data&  chart_data,  Preferences&)
   {
-    analyzers.emplace_back  (new SD_Envelope_Analyzer  {chart_data});
+    analyzers.emplace_back  (new SD_Envelope_Analyzer  {chart_data,  cache});
+    analyzers.emplace_back  (new Macd_Analyzer         {chart_data});
+    analyzers.emplace_back  (new Rsi_Analyzer          {chart_data});
+    analyzers.emplace_back  (new Stochastic_Analyzer   {chart_data});
     analyzers.emplace_back  (new Delta_Analyzer        {chart_data});
 
     for  (auto &a : analyzers)
@@ -45,4 +51,83 @@ namespace DMBCS::Trader_Desk {
   }
 
 
+
+  void  Analyzer_Stack::draw_panels  (Chart_Context const &main,
+                                      double const top,
+                                      double const bottom)
+  {
+    panel_outlines.clear ();
+
+    auto const  n  {number_panels ()};
+    if (n == 0)    return;
+
+    auto const  height  {(bottom - top) / n};
+    auto  panel_top  {top};
+
+    for (auto &a : analyzers)
+      if (a->wants_panel ())
+        {
+          Chart_Context  panel;
+          panel.panel_of (main,  panel_top + 4,  panel_top + height);
+          panel_top += height;
+
+          {
+            Stage_Timer::Scope  s  {timer.get (),  a->name () + " panel"};
+            a->panel_draw_hook (panel);
+          }
+
+          panel_outlines.push_back (panel.outline);
+
+          panel.set_source_rgb (Colour::TIME_AXIS);
+          panel.cairo->move_to (panel.left_border,
+                                panel.top_border);
+          panel.cairo->line_to (panel.left_border,
+                                panel.height - panel.bottom_border);
+          panel.cairo->line_to (panel.width - panel.right_border,
+                                panel.height - panel.bottom_border);
+          panel.cairo->stroke ();
+
+          panel.render (panel.text);
+        }
+  }
+
+
+
+  void  Analyzer_Stack::draw_panel_cursors  (Chart_Context const &main,
+                                             double const top,
+                                             double const bottom,
+                                             Time_Point const &cursor)
+  {
+    auto const  n  {number_panels ()};
+    if (n == 0  ||  panel_outlines.size () != n)    return;
+
+    auto const  height  {(bottom - top) / n};
+    auto  panel_top  {top};
+    auto  outline  {begin (panel_outlines)};
+
+    for (auto &a : analyzers)
+      if (a->wants_panel ())
+        {
+          Chart_Context  panel;
+          panel.panel_of (main,  panel_top + 4,  panel_top + height);
+          panel_top += height;
+          panel.outline = *outline++;
+
+          if (cursor < panel.outline.start_time
+                  ||  cursor > panel.outline.end_time)
+            continue;
+
+          panel.set_source_rgb (Colour::CURSOR_TIDES);
+          panel.cairo->move_to (panel.x (cursor),  panel.top_border);
+          panel.cairo->line_to (panel.x (cursor),
+                                panel.height - panel.bottom_border);
+          panel.cairo->stroke ();
+
+          a->panel_cursor_hook (panel,  cursor);
+
+          panel.render (panel.text);
+        }
+  }
+
+
 }  /* End of namespace DMBCS::Trader_Desk. */
@@ -22,8 +22,10 @@
 #define DMBCS__TRADER_DESK__ANALYZER__H
 
 
+#include <trader-desk/analysis-cache.h>
 #include <trader-desk/chart-context.h>
 #include <trader-desk/chart-data.h>
+#include <trader-desk/stage-timer.h>
 #include <trader-desk/tide-mark.h>
 #include <gtkmm.h>
 
@@ -47,6 +49,15 @@ namespace DMBCS::Trader_Desk {
     /** Obligatory null destructor for a purely virtual base class. */
     virtual ~Analyzer () = default;
 
+    /** A short name, which labels our entries in the chart's stage
+     *  timings. */
+    virtual string name () const = 0;
+
+    /** Have the time taken by any computations we do in the background
+     *  recorded in the \a timer.  Most analyzers compute nothing in the
+     *  background, so we provide a null default. */
+    virtual void instrument (shared_ptr <Stage_Timer> const & /*timer*/)  {}
+
     /** The returned object, if not empty, will be stacked up at the right
      *  edge of the window.  This is optional functionality for analyzers,
      *  so we provide a default implementation which adds no controls. */
@@ -54,14 +65,24 @@ namespace DMBCS::Trader_Desk {
     {  return  {};  }
     
 
-    /** Draw whatever into the \a chart_context.  The tide_marks are the
-     *  points in time at which tide-lines need adding, if they are to
-     *  show on the \c hand_analysis_widget. */
-    virtual void graph_draw_hook
-                   (Chart_Context &canvas,
-                    Tide_Mark::List &notes,
-                    unsigned number_shares,
-                    vector <Tide_Mark::Price_Marker> const &) = 0;
+    /** Draw whatever into the \a canvas.  The drawing is kept by the
+     *  chart and used again until the data or outline change or we emit
+     *  \c signal_redraw_needed, so it must not depend on the position of
+     *  the mouse. */
+    virtual void graph_draw_hook (Chart_Context &canvas) = 0;
+
+    /** Add to the \a notes any tide marks we want at the points in time
+     *  given by the \a markers, which include the time under the mouse.
+     *  This is called whenever the chart is shown, so should be quick. */
+    virtual void tide_mark_hook
+                   (Chart_Context const & /*canvas*/,
+                    Tide_Mark::List & /*notes*/,
+                    vector <Tide_Mark::Price_Marker> const & /*markers*/)  {}
+
+    /** Draw anything which follows the mouse over the \a canvas; this is
+     *  done afresh whenever the chart is shown. */
+    virtual void overlay_draw_hook (Chart_Context & /*canvas*/,
+                                    unsigned /*number_shares*/)  {}
 
     /** An opportunity for the analyzer to increase the area in which
      *  time-series are plotted, if this is necessary to display all of
@@ -73,6 +94,24 @@ namespace DMBCS::Trader_Desk {
      *  have changed (and probably need re-rendering on-screen). */
     virtual sigc::signal<void> &signal_redraw_needed () = 0;
 
+    /** Analyzers which show something other than prices (a bounded
+     *  oscillator, say) can ask for a panel of their own, below the main
+     *  chart, by returning true here. */
+    virtual bool wants_panel () const   { return 0; }
+
+    /** Draw into the \a panel requested above.  The context shares the
+     *  canvas, horizontal geometry and time range of the main chart, but
+     *  occupies its own strip; the analyzer must set the \c min_value and
+     *  \c max_value of the \c panel.outline to suit itself before drawing.
+     *  As with \c graph_draw_hook, the drawing is kept by the chart. */
+    virtual void panel_draw_hook (Chart_Context & /*panel*/)  {}
+
+    /** Label the value at the \a cursor (the time at the cross-hairs) in
+     *  the \a panel, whose \c outline is as \c panel_draw_hook left it.
+     *  This is done afresh whenever the chart is shown. */
+    virtual void panel_cursor_hook (Chart_Context & /*panel*/,
+                                    Time_Point const & /*cursor*/)  {}
+
     /** Allow an analyzer to respond to mouse presses on the chart canvas.
      *
      *  As it stands, the system only allows for one of the analyzers to
@@ -101,6 +140,11 @@ namespace DMBCS::Trader_Desk {
 
   struct Analyzer_Stack : Analyzer
   {
+    /** Results computed by the analyzers, kept so that they need not be
+     *  computed again if the same inputs come round again.  This must
+     *  outlive the \c analyzers, which hold references to it. */
+    Analysis_Cache  cache;
+
     /** The individual analyzers that we provide a home for. */
     vector <unique_ptr <Analyzer>>  analyzers;
     
@@ -111,6 +155,13 @@ namespace DMBCS::Trader_Desk {
     /** If not \c nullptr, this analyzer is working with the mouse. */
     Analyzer *mouse_user {nullptr};
 
+    /** Where the time taken by each analyzer is recorded, if anywhere. */
+    shared_ptr <Stage_Timer>  timer;
+
+    /** The value ranges the analyzers gave their panels the last time
+     *  they were drawn. */
+    vector <Time_Series::Range>  panel_outlines;
+
 
     /** The class constructor is actually a comprehensive analyzer
      *  factory, and returns a fully populated object ready to run the
@@ -135,19 +186,68 @@ namespace DMBCS::Trader_Desk {
     }
 
 
+    string name () const  override   { return "analyzers"; }
+
+    /** Record the time taken by each analyzer's drawing, and have each
+     *  record its background computations, in the \a timer. */
+    void instrument (shared_ptr <Stage_Timer> const &t)  override
+    {
+      timer = t;
+      for (auto &a : analyzers)  a->instrument (t);
+    }
+
     /** Give every analyzer an opportunity to draw onto the chart
      *  canvas. */
-    void graph_draw_hook 
-             (Chart_Context &c,
+    void graph_draw_hook (Chart_Context &c) override
+    {
+      for (auto &a : analyzers)  
+        {
+          Stage_Timer::Scope  s  {timer.get (),  a->name () + " draw"};
+          a->graph_draw_hook (c);
+        }
+    }
+
+    /** Collect every analyzer's tide marks. */
+    void tide_mark_hook
+             (Chart_Context const &c,
               Tide_Mark::List &t,
-              unsigned number_shares,
               vector <Tide_Mark::Price_Marker> const &p) override
     {
-      for (auto &a : analyzers)  
-          a->graph_draw_hook (c, t, number_shares, p);
+      for (auto &a : analyzers)  a->tide_mark_hook (c, t, p);
+    }
+
+    /** Give every analyzer an opportunity to draw over the chart. */
+    void overlay_draw_hook (Chart_Context &c,
+                            unsigned const number_shares) override
+    {
+      for (auto &a : analyzers)  a->overlay_draw_hook (c, number_shares);
     }
 
 
+    /** The number of analyzers which want a panel below the chart. */
+    size_t number_panels () const
+    {
+      return count_if (begin (analyzers), end (analyzers),
+                       [] (auto const &a) { return a->wants_panel (); });
+    }
+
+
+    /** Share out the strip of the \a main canvas between \a top and \a
+     *  bottom among the analyzers which want panels, and let them draw
+     *  there. */
+    void draw_panels (Chart_Context const &main,
+                      double const top,
+                      double const bottom);
+
+    /** Carry the cross-hair at time \a cursor down through all of the
+     *  panels laid out by the last \c draw_panels, drawing onto the \a
+     *  main canvas. */
+    void draw_panel_cursors (Chart_Context const &main,
+                             double const top,
+                             double const bottom,
+                             Time_Point const &cursor);
+
+
     /** Give every analyzer a go at stretching the size of the chart
      *  canvas. */
     void stretch_outline (Time_Series::Range &r) override
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <trader-desk/application.h>
+#include <trader-desk/correlation.h>
+
+
+/** \file
+ *
+ *  Implementation of the \c Application::correlate_market
+ *  mega-method. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  void Application::correlate_market ()
+  {
+    Chart_Grid *const  g  {displayed_grid ()};
+
+    if (! g)
+      {
+        Gtk::MessageDialog {*window,
+                            pgettext ("Instruction",
+                                      "Show a market before correlating it"),
+                            0,
+                            Gtk::MESSAGE_INFO}
+                 .run ();
+        return;
+      }
+
+    Chart_Grid&  grid  {*g};
+
+    auto const  matrix  {[this,  &grid]
+                         {
+                           DB  db  {user_prefs};
+                           return  Trader_Desk::correlate_market
+                                         (db,  grid.market,
+                                          chrono::hours {24 * 365},
+                                          grid.prices_version (),
+                                          market_analyses);
+                         }  ()};
+
+    Gtk::TreeModelColumn <string>  name_a;
+    Gtk::TreeModelColumn <string>  name_b;
+    Gtk::TreeModelColumn <int>     seqid_a;
+    Gtk::TreeModelColumn <int>     seqid_b;
+    Gtk::TreeModelColumn <double>  correlation;
+    Gtk::TreeModelColumn <double>  covariance;
+    Gtk::TreeModel::ColumnRecord  columns;
+    columns.add (name_a);
+    columns.add (name_b);
+    columns.add (seqid_a);
+    columns.add (seqid_b);
+    columns.add (correlation);
+    columns.add (covariance);
+
+    auto list = Gtk::ListStore::create (columns);
+    for (auto const &p  :  matrix->strongest (200))
+      {
+        auto b = list->append ();
+        (*b) [name_a]       =  matrix->name [p.a];
+        (*b) [name_b]       =  matrix->name [p.b];
+        (*b) [seqid_a]      =  matrix->seqid [p.a];
+        (*b) [seqid_b]      =  matrix->seqid [p.b];
+        (*b) [correlation]  =  p.correlation;
+        (*b) [covariance]   =  matrix->covariance (p.a,  p.b);
+      }
+
+    Gtk::TreeView view {list};
+    view.append_column (pgettext ("Label", "Company"), name_a);
+    view.append_column (pgettext ("Label", "Company"), name_b);
+    view.append_column_numeric (pgettext ("Label", "Correlation"),
+                                correlation,  "%.3f");
+    view.append_column_numeric (pgettext ("Label", "Covariance"),
+                                covariance,  "%.3g");
+
+    view.get_column (0)->set_sort_column (name_a);
+    view.get_column (1)->set_sort_column (name_b);
+    view.get_column (2)->set_sort_column (correlation);
+    view.get_column (3)->set_sort_column (covariance);
+
+    Gtk::Dialog dialog (grid.market.world_data.name,
+                        *window,
+                        Gtk::DIALOG_MODAL);
+
+    Gtk::ScrolledWindow  scroll;
+    scroll.add (view);
+    dialog.get_vbox ()->pack_start (scroll);
+
+    int  selected  {-1};
+
+    view . signal_row_activated ()
+         . connect ([&] (Gtk::TreeModel::Path const &path,
+                         Gtk::TreeViewColumn *const column)
+                    {  auto const  row  {*list->get_iter (path)};
+                       selected = column == view.get_column (1)
+                                     ?  row [seqid_b]  :  row [seqid_a];
+                       dialog.response (Gtk::RESPONSE_OK);  });
+
+    dialog  . add_button (pgettext ("Instruction", "Close"),
+                          Gtk::RESPONSE_CANCEL);
+    dialog  . set_size_request (600, 500);
+    dialog  . show_all ();
+
+    if (Gtk::RESPONSE_OK  ==  dialog.run ())
+      if (auto *const  c  {grid.open_chart (selected)})
+        {
+          dialog.hide ();
+          grid.selection = c;
+          grid.selection_signal.emit ();
+        }
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <trader-desk/application.h>
+#include <trader-desk/screener.h>
+#include <deque>
+
+
+/** \file
+ *
+ *  Implementation of the \c Application::screen_market mega-method. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  void Application::screen_market ()
+  {
+    Chart_Grid *const  g  {displayed_grid ()};
+
+    if (! g)
+      {
+        Gtk::MessageDialog {*window,
+                            pgettext ("Instruction",
+                                      "Show a market before screening it"),
+                            0,
+                            Gtk::MESSAGE_INFO}
+                 .run ();
+        return;
+      }
+
+    Chart_Grid&  grid  {*g};
+
+    Screen  screen  {[this,  &grid]
+                     {
+                       DB  db  {user_prefs};
+                       return  Trader_Desk::screen_market
+                                         (db,  grid.market,  default_screen ());
+                     }  ()};
+
+    Gtk::TreeModelColumn <string>  name;
+    Gtk::TreeModelColumn <int>     seqid;
+    Gtk::TreeModelColumn <double>  price;
+    deque <Gtk::TreeModelColumn <double>>  values;
+    Gtk::TreeModel::ColumnRecord  columns;
+    columns.add (name);
+    columns.add (seqid);
+    columns.add (price);
+    for (size_t i = 0;  i < screen.expressions.size ();  ++i)
+      columns.add (values.emplace_back ());
+
+    auto list = Gtk::ListStore::create (columns);
+    for (auto const &r  :  screen.rows)
+      {
+        auto b = list->append ();
+        (*b) [name]   =  r.company_name;
+        (*b) [seqid]  =  r.seqid;
+        (*b) [price]  =  r.latest.price;
+        for (size_t i = 0;  i < values.size ();  ++i)
+          (*b) [values [i]]  =  r.values [i];
+      }
+
+    if (! values.empty ())
+      list->set_sort_column (values [0],  Gtk::SORT_DESCENDING);
+
+    Gtk::TreeView view {list};
+    view.append_column (pgettext ("Label", "Company"), name);
+    view.append_column_numeric (pgettext ("Label", "Price"), price, "%.2f");
+    for (size_t i = 0;  i < values.size ();  ++i)
+      view.append_column_numeric (screen.expressions [i].title (),
+                                  values [i],
+                                  "%.2f");
+
+    view.get_column (0)->set_sort_column (name);
+    view.get_column (1)->set_sort_column (price);
+    for (size_t i = 0;  i < values.size ();  ++i)
+      view.get_column (i + 2)->set_sort_column (values [i]);
+
+    Gtk::Dialog dialog (grid.market.world_data.name,
+                        *window,
+                        Gtk::DIALOG_MODAL);
+
+    Gtk::ScrolledWindow  scroll;
+    scroll.add (view);
+    dialog.get_vbox ()->pack_start (scroll);
+
+    int  selected  {-1};
+
+    view . signal_row_activated ()
+         . connect ([&] (Gtk::TreeModel::Path const &path,
+                         Gtk::TreeViewColumn *const)
+                    {  selected = (*list->get_iter (path)) [seqid];
+                       dialog.response (Gtk::RESPONSE_OK);  });
+
+    dialog  . add_button (pgettext ("Instruction", "Close"),
+                          Gtk::RESPONSE_CANCEL);
+    dialog  . set_size_request (600, 500);
+    dialog  . show_all ();
+
+    if (Gtk::RESPONSE_OK  ==  dialog.run ())
+      if (auto *const  c  {grid.open_chart (selected)})
+        {
+          dialog.hide ();
+          grid.selection = c;
+          grid.selection_signal.emit ();
+        }
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
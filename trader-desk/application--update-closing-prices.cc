@@ -111,7 +111,7 @@ extern "C"  int  preferences_error_  (const preferences_error_args *const  A)
 
 
 static  void  grid_injector  (Chart_Grid&  grid,
-                              Chart**  current_chart,
+                              shared_ptr<Chart> *const  current_chart,
                               const Update_Closing_Prices::Data&  data)
   {
     if (! *current_chart)
@@ -129,11 +129,11 @@ static  void  grid_injector  (Chart_Grid&  grid,
 
 void Application::update_closing_prices ()
   {
-    const size_t  a  {(size_t) notebook.get_current_page ()};
+    Chart_Grid *const  g  {displayed_grid ()};
 
-    if (a < 1  ||  a > market_grids.size ())   return;
+    if (! g)   return;
 
-    Chart_Grid&  grid  {*market_grids [a - 1]};
+    Chart_Grid&  grid  {*g};
 
     try   {
               DB  db  {user_prefs};
@@ -146,7 +146,8 @@ void Application::update_closing_prices ()
               return;
           }
 
-    for (auto&  c  :  grid.chart)    c->data.unaccurate = 1;
+    for (auto&  c  :  grid.companies)
+      if (c.chart)    c.chart->data.unaccurate = 1;
 
     grid.queue_draw ();
 
@@ -168,7 +169,7 @@ void Application::update_closing_prices ()
               *  new datum is reported to us, so only do the search when
               *  this is \c nullptr and re-use the last search result
               *  (stored here) otherwise. */
-             Chart*  current_chart  {nullptr};
+             shared_ptr<Chart>  current_chart;
 
              do_update
                 (update,
@@ -196,14 +197,22 @@ void Application::update_closing_prices ()
                     {    if (! current_chart)
                               current_chart = grid.find_chart (company_seqid);
 
-                         current_chart->data.extremes
-                            = current_chart->data
-                                            .prices
-                                            .get_range (chrono::hours (50*24));
+                         /* Charts not yet in view will read everything
+                          * from the database when they come into it. */
+                         if (! current_chart)    return;
+
+                         /* The thumbnails copy these from the GTK
+                          * thread. */
+                         {
+                           auto &d  {current_chart->data};
+                           lock_guard  l  {d.prices_mutex};
+                           d.extremes
+                               = d.prices.get_range (chrono::hours (50*24));
+                           d.unaccurate = 0;
+                         }
 
-                         current_chart->data.unaccurate = 0;
                          gdk_threads_add_idle  ((int(*)(void*))queue_draw,
-                                                current_chart);
+                                                &grid);
                          current_chart = nullptr;       });
            }
 
@@ -214,6 +223,13 @@ void Application::update_closing_prices ()
                         new  preferences_error_args  {this,  E.what ()});
            }
 
+         catch (const Price_Server::Quota_Used_Up&  E)
+           {
+             gdk_threads_add_idle
+                       ((int(*)(void*)) preferences_error_,
+                        new  preferences_error_args  {this,  E.what ()});
+           }
+
          catch (const Update_Closing_Prices::No_Connection&  E)
            {
              gdk_threads_add_idle
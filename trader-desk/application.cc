@@ -39,4 +39,14 @@ namespace DMBCS::Trader_Desk {
   }
 
 
+
+  Chart_Grid *Application::displayed_grid ()
+  {
+    const size_t  a  {(size_t) notebook.get_current_page ()};
+
+    return  a < 1  ||  a > market_grids.size ()  ?  nullptr
+                                                 :  market_grids [a - 1].get ();
+  }
+
+
 }  /* End of namespace DMBCS::Trader_Desk. */
@@ -22,6 +22,7 @@
 #define DMBCS__TRADER_DESK__APPLICATION__H
 
 
+#include <trader-desk/analysis-cache.h>
 #include <trader-desk/hand-analysis-widget.h>
 #include <trader-desk/update-latest-prices.h>
 
@@ -83,6 +84,10 @@ namespace DMBCS::Trader_Desk {
      *  data, and allows for much interaction with the user. */
     unique_ptr<Hand_Analysis_Widget> hand_analysis;
 
+    /** Results of market-wide analyses, kept while the data they were
+     *  computed from are unchanged. */
+    Analysis_Cache  market_analyses  {4};
+
 
 
     /**  The application is not in a good state until the constructor has
@@ -99,6 +104,10 @@ namespace DMBCS::Trader_Desk {
      *  i.e. counting from one upwards. */
     void display_grid (size_t const &position);
 
+    /** The grid currently on display, or \c nullptr if the hand analysis
+     *  page is showing. */
+    Chart_Grid *displayed_grid ();
+
     
     /** Mega-method which does all the work (including operating the
      *  display machinery) to get a new market working in the system. */
@@ -109,6 +118,15 @@ namespace DMBCS::Trader_Desk {
      *  date. */
     void update_closing_prices ();
 
+    /** Run the default screen over the market currently on display, and
+     *  show the ranked results in a dialog; double-clicking a company
+     *  there brings it up in the hand analysis page. */
+    void screen_market ();
+
+    /** Show the most strongly correlated pairs of companies in the market
+     *  currently on display, over the last year. */
+    void correlate_market ();
+
 
   } ;  /* End of class Application. */
 
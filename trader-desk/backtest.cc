@@ -0,0 +1,347 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <trader-desk/backtest.h>
+#include <trader-desk/kernels.h>
+#include <cmath>
+#include <map>
+#include <sstream>
+
+
+/** \file
+ *
+ *  Implementation of the backtesting engine. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  /* Read a period from \a in into \a p, refusing a minus sign which the
+   * extraction of an unsigned would wrap round. */
+  static void  read_period  (istream &in,  unsigned &p)
+  {
+    long long  n;
+
+    if (in.peek () == '-'  ||  ! (in >> n)
+              ||  n < 1  ||  n > Strategy::MAX_PERIOD)
+      in.setstate (ios::failbit);
+    else
+      p = unsigned (n);
+  }
+
+
+
+  Strategy  Strategy::parse  (string const &text)
+  {
+    istringstream  in  {text};
+    string  kind;
+    getline (in,  kind,  ':');
+
+    Strategy  ret  {Kind::ENVELOPE,  0};
+    char  colon  {':'};
+
+    if (kind == "envelope")
+      {
+        read_period (in,  ret.period);
+        if (! in.eof ())    in >> colon >> ret.width;
+      }
+    else if (kind == "crossover")
+      {
+        ret.kind = Kind::MA_CROSSOVER;
+        read_period (in,  ret.period);
+        in >> colon;
+        read_period (in,  ret.slow_period);
+      }
+    else
+      in.setstate (ios::failbit);
+
+    if (in.fail ()  ||  ! in.eof ()  ||  colon != ':'
+              ||  ret.period < 1
+              ||  (ret.kind == Kind::MA_CROSSOVER
+                        &&  ret.slow_period <= ret.period)
+              ||  (ret.kind == Kind::ENVELOPE
+                        &&  (ret.period < 2  ||  ret.width <= 0.0)))
+      throw runtime_error {"bad strategy \"" + text + "\""};
+
+    return ret;
+  }
+
+
+
+  string  Strategy::title  ()  const
+  {
+    ostringstream  ret;
+
+    if (kind == Kind::ENVELOPE)
+      ret << "envelope:" << period << ':' << width;
+    else
+      ret << "crossover:" << period << ':' << slow_period;
+
+    return ret.str ();
+  }
+
+
+
+  unsigned  Strategy::warm_up  ()  const
+  {
+    return  kind == Kind::ENVELOPE  ?  period  :  slow_period;
+  }
+
+
+
+  Backtest_Result  &Backtest_Result::operator+=  (Backtest_Result const &r)
+  {
+    profit        +=  r.profit;
+    turnover      +=  r.turnover;
+    costs         +=  r.costs;
+    trades        +=  r.trades;
+    days_held     +=  r.days_held;
+    return *this;
+  }
+
+
+
+  Backtest::Backtest  (Market_History const &history,  Worker_Pool &pool)
+  {
+    for (auto const &c  :  history)
+      if (! c.prices.empty ())
+        series.push_back ({c.seqid,  c.name,  {},  {}});
+
+    vector <Time_Series const *>  prices;
+    for (auto const &c  :  history)
+      if (! c.prices.empty ())
+        {
+          prices.push_back (&c.prices);
+          for (auto const &e  :  c.prices)    calendar.push_back (e.time);
+        }
+
+    sort (begin (calendar),  end (calendar));
+    calendar.erase (unique (begin (calendar),  end (calendar)),
+                    end (calendar));
+
+    pool.parallel_for (series.size (),
+                       [&] (size_t const b,  size_t const e)
+                       {
+                         for (auto i = b;  i < e;  ++i)
+                           {
+                             auto &S  {series [i]};
+                             auto const &P  {*prices [i]};
+
+                             S.close.reserve (P.size ());
+                             S.day.reserve (P.size ());
+                             for (auto p = P.rbegin ();  p != P.rend ();  ++p)
+                               {
+                                 S.close.push_back (p->price);
+                                 S.day.push_back
+                                      (lower_bound (begin (calendar),
+                                                    end (calendar),
+                                                    p->time)
+                                          -  begin (calendar));
+                               }
+                           }
+                       });
+  }
+
+
+
+  Backtest_Result  Backtest::run_one  (Series const &S,
+                                       Strategy const &strategy,
+                                       unsigned const number_shares,
+                                       Trading_Costs const &costs,
+                                       vector <double> *const equity_steps)
+  {
+    Backtest_Result  ret;
+
+    auto const  n  {S.close.size ()};
+    auto const  warm_up  {strategy.warm_up ()};
+
+    if (n < warm_up  ||  warm_up == 0)    return ret;
+
+    /* The two quantities the rule compares the price with, or each
+     * other: the mean and deviation for an envelope, or the fast and slow
+     * means for a crossover. */
+    vector <double>  a  (n),  b  (n);
+
+    if (strategy.kind == Strategy::Kind::ENVELOPE)
+      {
+        trailing_mean (S.close,  strategy.period,  a);
+        trailing_deviation (S.close,  strategy.period,  b);
+      }
+    else
+      {
+        trailing_mean (S.close,  strategy.period,  a);
+        trailing_mean (S.close,  strategy.slow_period,  b);
+      }
+
+    Currency_Value  cash  {0.0};
+    Currency_Value  peak  {0.0};
+    bool  held  {0};
+
+    auto const  trade  =  [&] (Currency_Value const &price,  bool const buy)
+      {
+        auto const  value  {number_shares * price};
+        auto const  cost  {costs.of (value)};
+        cash += (buy ? -value : value)  -  cost;
+        ret.turnover += value;
+        ret.costs += cost;
+        ++ret.trades;
+        held = buy;
+      };
+
+    for (auto t = warm_up - 1;  t < n;  ++t)
+      {
+        auto const  price  {S.close [t]};
+
+        switch (strategy.kind)
+          {
+          case Strategy::Kind::ENVELOPE:
+            {
+              if (b [t] <= 0.0)    break;
+
+              auto const  edge  {strategy.width * b [t]};
+
+              if (! held  &&  price <= a [t] - edge)      trade (price,  1);
+              else if (held  &&  price >= a [t] + edge)   trade (price,  0);
+            }
+            break;
+
+          case Strategy::Kind::MA_CROSSOVER:
+            {
+              bool const  want  {a [t] > b [t]};
+              if (want != held)    trade (price,  want);
+            }
+            break;
+          }
+
+        if (held)    ++ret.days_held;
+
+        auto const  equity  {cash  +  (held  ?  number_shares * price  :  0.0)};
+        peak = max (peak,  equity);
+        ret.max_drawdown = max (ret.max_drawdown,  peak - equity);
+
+        if (equity_steps)
+          (*equity_steps) [S.day [t]]  +=  equity - ret.profit;
+
+        ret.profit = equity;
+      }
+
+    return ret;
+  }
+
+
+
+  vector <Backtest_Result>  Backtest::run  (Strategy const &strategy,
+                                            unsigned const number_shares,
+                                            Trading_Costs const &costs,
+                                            Worker_Pool &pool)  const
+  {
+    vector <Backtest_Result>  ret  (series.size ());
+
+    pool.parallel_for (series.size (),
+                       [&] (size_t const b,  size_t const e)
+                       {
+                         for (auto i = b;  i < e;  ++i)
+                           ret [i] = run_one (series [i],  strategy,
+                                              number_shares,  costs);
+                       });
+
+    return ret;
+  }
+
+
+
+  vector <Backtest_Result>  Backtest::sweep
+                                      (vector <Strategy> const &strategies,
+                                       unsigned const number_shares,
+                                       Trading_Costs const &costs,
+                                       Worker_Pool &pool)  const
+  {
+    auto const  C  {series.size ()};
+
+    vector <Backtest_Result>  each  (strategies.size () * C);
+
+    /* For each strategy, the day-by-day change in the profit of the
+     * whole market.  Each batch of work collects its own, and adds them
+     * in when it is finished. */
+    vector <vector <double>>  steps  (strategies.size (),
+                                      vector <double> (calendar.size ()));
+    mutex  steps_mutex;
+
+    pool.parallel_for (each.size (),
+                       [&] (size_t const b,  size_t const e)
+                       {
+                         map <size_t, vector <double>>  local;
+
+                         for (auto i = b;  i < e;  ++i)
+                           {
+                             auto &L  {local [i / C]};
+                             if (L.empty ())    L.resize (calendar.size ());
+
+                             each [i] = run_one (series [i % C],
+                                                 strategies [i / C],
+                                                 number_shares,  costs,
+                                                 &L);
+                           }
+
+                         lock_guard  l  {steps_mutex};
+                         for (auto const &L  :  local)
+                           for (size_t d = 0;  d < calendar.size ();  ++d)
+                             steps [L.first] [d]  +=  L.second [d];
+                       },
+                       8);
+
+    vector <Backtest_Result>  ret  (strategies.size ());
+
+    for (size_t i = 0;  i < each.size ();  ++i)
+      ret [i / C] += each [i];
+
+    for (size_t s = 0;  s < strategies.size ();  ++s)
+      {
+        double  equity  {0.0},  peak  {0.0};
+
+        for (auto const  step  :  steps [s])
+          {
+            equity += step;
+            peak = max (peak,  equity);
+            ret [s].max_drawdown = max (ret [s].max_drawdown,
+                                        peak - equity);
+          }
+      }
+
+    return ret;
+  }
+
+
+
+  vector <Strategy>  default_strategies  ()
+  {
+    using  K  =  Strategy::Kind;
+
+    return {{K::ENVELOPE,      14,   0,  1.5},
+            {K::ENVELOPE,      14,   0,  2.0},
+            {K::ENVELOPE,      28,   0,  1.5},
+            {K::ENVELOPE,      28,   0,  2.0},
+            {K::MA_CROSSOVER,  10,  50},
+            {K::MA_CROSSOVER,  20, 100},
+            {K::MA_CROSSOVER,  50, 200}};
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#ifndef DMBCS__TRADER_DESK__BACKTEST__H
+#define DMBCS__TRADER_DESK__BACKTEST__H
+
+
+#include <trader-desk/market-history.h>
+#include <trader-desk/worker-pool.h>
+
+
+/** \file
+ *
+ *  Declaration of the \c Strategy, \c Trading_Costs, \c
+ *  Backtest_Result and \c Backtest classes, which together replay the
+ *  price history of a market through a trading rule to see how it would
+ *  have fared.  None of this requires any graphics. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  /** A trading rule based on the same quantities the analyzers show on
+   *  the charts.  The rule only ever holds a long position of a fixed
+   *  number of shares, or nothing, and acts at the closing price of the
+   *  day on which it sees a signal.
+   *
+   *  The analyzers centre their moving averages on each date, which
+   *  needs prices from after that date; here the averages are always of
+   *  the \c period prices up to and including the day in question, so
+   *  that no decision is based on information which would not have been
+   *  available at the time.  Periods are counted in trading days. */
+
+  struct Strategy
+  {
+    enum class Kind
+      {
+        /** Buy when the price falls to the bottom of an envelope of \c
+         *  width standard deviations about the moving mean, and sell when
+         *  it rises to the top: the hints given by the SD envelope
+         *  analyzer's tide marks. */
+        ENVELOPE,
+
+        /** Hold while the mean of the last \c period prices is above the
+         *  mean of the last \c slow_period. */
+        MA_CROSSOVER
+      };
+
+    Kind      kind;
+    unsigned  period;
+    unsigned  slow_period  {0};
+    double    width        {2.0};
+
+    /** The longest period \c parse will accept: about a century of
+     *  trading days. */
+    static constexpr unsigned const  MAX_PERIOD  {100 * 261};
+
+    /** Parse one of \c "envelope:PERIOD:WIDTH" or \c
+     *  "crossover:PERIOD:SLOW_PERIOD".  Throws \c runtime_error if \a
+     *  text is not understood. */
+    static Strategy  parse  (string const &text);
+
+    /** A short description, also acceptable to \c parse. */
+    string  title  ()  const;
+
+    /** The number of prices which must have been seen before the rule
+     *  can give any signal. */
+    unsigned  warm_up  ()  const;
+
+  };  /* End of class Strategy. */
+
+
+
+  /** The cost of making a trade, as set in the \c Preferences. */
+
+  struct Trading_Costs
+  {
+    /** Fixed cost of each trade, in pence. */
+    Currency_Value  offset  {0.0};
+
+    /** Cost proportional to the value of each trade. */
+    double  factor  {0.0};
+
+    Currency_Value  of  (Currency_Value const &value)  const
+    {  return  offset  +  factor * value;  }
+  };
+
+
+
+  /** How a \c Strategy fared on one company, or on a whole market.  All
+   *  money amounts are in pence. */
+
+  struct Backtest_Result
+  {
+    /** The profit (or loss) at the end of the period, after costs,
+     *  including the value of any position still open at the last
+     *  price. */
+    Currency_Value  profit  {0.0};
+
+    /** The largest fall in profit from a previous peak.  For a market
+     *  this is taken from the total profit of all its companies, day by
+     *  day, so that companies falling together add up. */
+    Currency_Value  max_drawdown  {0.0};
+
+    /** The total value of all the shares bought and sold. */
+    Currency_Value  turnover  {0.0};
+
+    /** The total of all the trading costs, included in \c profit. */
+    Currency_Value  costs  {0.0};
+
+    /** The number of trades (each purchase or sale counting one). */
+    unsigned  trades  {0};
+
+    /** The number of trading days on which a position was held. */
+    unsigned  days_held  {0};
+
+    /** Add the results for another company to these.  The \c
+     *  max_drawdown is left alone: that of a whole market cannot be had
+     *  from those of its parts. */
+    Backtest_Result  &operator+=  (Backtest_Result const &);
+  };
+
+
+
+  /** The price history of a market prepared for replaying through any
+   *  number of strategies: each company's closes, oldest first, ready
+   *  for the kernels of \c kernels.h to run over. */
+
+  class Backtest
+  {
+    struct Series
+    {
+      int                      seqid;
+      string                   name;
+      vector <Currency_Value>  close;
+
+      /** The index in the \c calendar of the day of each \c close. */
+      vector <uint32_t>        day;
+    };
+
+    vector <Series>  series;
+
+    /** Every time at which any company has a price, oldest first. */
+    vector <Time_Point>  calendar;
+
+    /** Replay the rule on one company.  If \a equity_steps is given, the
+     *  change in the company's profit on each day is added to the element
+     *  of it for that day of the \c calendar. */
+    static Backtest_Result  run_one  (Series const &,
+                                      Strategy const &,
+                                      unsigned const number_shares,
+                                      Trading_Costs const &,
+                                      vector <double> *equity_steps
+                                                                 = nullptr);
+
+
+  public:
+
+    /** Prepare the \a history for replay, using the \a pool. */
+    explicit Backtest (Market_History const &history,
+                       Worker_Pool &pool = Worker_Pool::shared ());
+
+    /** The number of companies. */
+    size_t  size  ()  const   {  return series.size ();  }
+
+    int  seqid  (size_t const i)  const          {  return series [i].seqid;  }
+    string const  &name  (size_t const i)  const {  return series [i].name;  }
+
+    /** The result of trading \a number_shares at a time according to
+     *  the \a strategy, for each company separately, computed in
+     *  parallel on the \a pool. */
+    vector <Backtest_Result>  run  (Strategy const &strategy,
+                                    unsigned const number_shares,
+                                    Trading_Costs const &costs,
+                                    Worker_Pool &pool
+                                              = Worker_Pool::shared ())  const;
+
+    /** The market-wide result of each of the \a strategies (a parameter
+     *  sweep), with all the combinations of strategy and company computed
+     *  in parallel on the \a pool. */
+    vector <Backtest_Result>  sweep  (vector <Strategy> const &strategies,
+                                      unsigned const number_shares,
+                                      Trading_Costs const &costs,
+                                      Worker_Pool &pool
+                                              = Worker_Pool::shared ())  const;
+
+  };  /* End of class Backtest. */
+
+
+
+  /** A selection of strategies to try when the user has not asked for
+   *  any in particular. */
+  vector <Strategy>  default_strategies  ();
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+#endif  /* Undefined DMBCS__TRADER_DESK__BACKTEST__H. */
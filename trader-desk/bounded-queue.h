@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#ifndef DMBCS__TRADER_DESK__BOUNDED_QUEUE__H
+#define DMBCS__TRADER_DESK__BOUNDED_QUEUE__H
+
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+
+/** \file
+ *
+ *  Definition and complete inline implementation of the \c Bounded_Queue
+ *  class template. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  using namespace std;
+
+
+  /** A first-in, first-out queue of at most \c capacity items, for
+   *  passing work between the stages of a pipeline which run in different
+   *  threads: \c push waits while the queue is full, so that a fast stage
+   *  cannot run far ahead of a slow one, and \c pop waits while it is
+   *  empty.
+   *
+   *  When the producer has finished it calls \c close, after which the
+   *  consumer can \c pop whatever is left before being told that there is
+   *  no more.  Either end can \c abandon the queue, after which both ends
+   *  are told to give up at once. */
+
+  template <typename T>
+  class Bounded_Queue
+  {
+    size_t const  capacity;
+
+    deque <T>  items;
+
+    /** Protects everything below. */
+    mutex  items_mutex;
+
+    condition_variable  not_full,  not_empty;
+
+    bool  closed     {0};
+    bool  abandoned  {0};
+
+
+  public:
+
+    explicit Bounded_Queue (size_t const c)  :  capacity {max <size_t> (1, c)}
+    {}
+
+    Bounded_Queue  (Bounded_Queue const &)  =  delete;
+    Bounded_Queue &operator=  (Bounded_Queue const &)  =  delete;
+
+
+    /** Wait until there is room, and then put \a x at the back of the
+     *  queue.  Returns 0, dropping \a x, if the queue has been abandoned
+     *  (or closed). */
+    bool  push  (T x)
+    {
+      {
+        unique_lock  l  {items_mutex};
+        not_full.wait (l,  [this]
+                           { return abandoned || closed
+                                               || items.size () < capacity; });
+        if (abandoned  ||  closed)    return 0;
+        items.push_back (move (x));
+      }
+      not_empty.notify_one ();
+      return 1;
+    }
+
+
+    /** Wait for an item and take it off the front of the queue.  Returns
+     *  nothing once the queue has been closed and emptied, or has been
+     *  abandoned. */
+    optional <T>  pop  ()
+    {
+      optional <T>  ret;
+      {
+        unique_lock  l  {items_mutex};
+        not_empty.wait (l,  [this]
+                            { return abandoned || closed || ! items.empty (); });
+        if (abandoned  ||  items.empty ())    return ret;
+        ret = move (items.front ());
+        items.pop_front ();
+      }
+      not_full.notify_one ();
+      return ret;
+    }
+
+
+    /** There will be no more items pushed. */
+    void  close  ()
+    {
+      {  lock_guard  l  {items_mutex};   closed = 1;  }
+      not_empty.notify_all ();
+      not_full.notify_all ();
+    }
+
+
+    /** Give up: anything in the queue is dropped, and waiting and future
+     *  calls of \c push and \c pop return at once. */
+    void  abandon  ()
+    {
+      {
+        lock_guard  l  {items_mutex};
+        abandoned = 1;
+        items.clear ();
+      }
+      not_empty.notify_all ();
+      not_full.notify_all ();
+    }
+
+  };  /* End of class Bounded_Queue. */
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+#endif  /* Undefined DMBCS__TRADER_DESK__BOUNDED_QUEUE__H. */
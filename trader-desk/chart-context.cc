@@ -19,6 +19,7 @@
 
 
 #include <trader-desk/chart-context.h>
+#include <cmath>
 
 
 
@@ -64,20 +65,84 @@ namespace DMBCS::Trader_Desk {
 
 
 
+  void Chart_Context::panel_of (Chart_Context const &main,
+                                double const top,
+                                double const bottom)
+  {
+    cairo          =  main.cairo;
+    pango          =  main.pango;
+    left_border    =  main.left_border;
+    right_border   =  main.right_border;
+    width          =  main.width;
+    height         =  main.height;
+    top_border     =  top;
+    bottom_border  =  main.height - bottom;
+
+    outline  =  main.outline;
+    outline.min_value  =  0.0;
+    outline.max_value  =  1.0;
+  }
+
+
+
+  void Chart_Context::decimate (Time_Series const &series,
+                                Series_Pyramid const &pyramid,
+                                vector <Event> &out) const
+  {
+    out.clear ();
+    pyramid.decimate (series,
+                      outline.start_time,
+                      outline.end_time,
+                      width - left_border - right_border,
+                      out);
+
+    /* The pyramid gives us the event before the start as well, so that
+     * the line can be taken right up to the edge; it must not go over
+     * into the margin. */
+    auto const  start  {outline.start_time};
+
+    auto const  inside  {find_if (begin (out),  end (out),
+                                  [start] (Event const &e)
+                                  {  return e.time >= start;  })};
+
+    if (inside == begin (out))    return;
+
+    if (inside == end (out))    {  out.clear ();  return;  }
+
+    auto const &a  {*(inside - 1)};
+    auto const &b  {*inside};
+    auto const  f  {chrono::duration <double> (start - a.time)
+                      /  chrono::duration <double> (b.time - a.time)};
+
+    Event const  edge  {start,  a.price  +  f * (b.price - a.price)};
+
+    out.erase (begin (out),  inside - 1);
+    out.front () = edge;
+  }
+
+
+
   void Chart_Context::draw_time_series (Time_Series const &series,
                                         Colour const &colour,
-                                        double const &alpha) const
+                                        double const &alpha,
+                                        Series_Pyramid const &pyramid) const
   {
     if (series.size () < 2)
       return;
 
+    vector <Event>  points;
+    decimate (series,  pyramid,  points);
+
+    if (points.empty ())
+      return;
+
     set_source_rgb (colour, alpha);
 
-    auto i  =  begin (series);
+    auto i  =  begin (points);
 
     move_to (*i++);
 
-    while (i != end (series)  &&  i->time >= outline.start_time)
+    while (i != end (points))
       line_to (*i++);
 
     cairo->stroke ();
@@ -127,4 +192,30 @@ namespace DMBCS::Trader_Desk {
   }
 
 
+
+  double  Chart_Context::device_scale (Cairo::RefPtr <Cairo::Context> const &c)
+  {
+    double  x  {1.0},  y  {1.0};
+    cairo_surface_get_device_scale (c->get_target ()->cobj (),  &x,  &y);
+    return  max (x,  y);
+  }
+
+
+
+  Cairo::RefPtr <Cairo::ImageSurface>
+  Chart_Context::scaled_image  (int const width,
+                                int const height,
+                                double const scale)
+  {
+    auto const  surface
+      {Cairo::ImageSurface::create (Cairo::FORMAT_ARGB32,
+                                    int (ceil (width * scale)),
+                                    int (ceil (height * scale)))};
+
+    cairo_surface_set_device_scale (surface->cobj (),  scale,  scale);
+
+    return surface;
+  }
+
+
 }  /* End of namespace DMBCS::Trader_Desk. */
@@ -22,6 +22,7 @@
 #define DMBCS__TRADER_DESK__CHART_CONTEXT__H
 
 
+#include <trader-desk/series-pyramid.h>
 #include <trader-desk/text.h>
 #include <trader-desk/time-series.h>
 #include <pangomm.h>
@@ -96,11 +97,31 @@ namespace DMBCS::Trader_Desk {
     Chart_Context &operator= (Chart_Context &&) = delete;
 
 
+    /** Initialize this object as a panel below the \a main chart,
+     *  occupying the strip between \a top and \a bottom (pixels from the
+     *  top of the widget).  The panel draws on the same canvas, and has
+     *  the same time range and horizontal geometry as \a main; its value
+     *  range is left at [0, 1] for the user to set. */
+    void panel_of (Chart_Context const &main,
+                   double const top,
+                   double const bottom);
 
-    /** Plot the chart. */
+
+
+    /** Plot the \a series, as far as it lies in the \c outline.  Only a
+     *  few vertices per pixel column are drawn, however long the series
+     *  is; if a \a pyramid built from the series is given, the work of
+     *  finding them is also independent of the length of the series. */
     void draw_time_series (Time_Series const &series,
                            Colour const &colour,
-                           double const &alpha) const;
+                           double const &alpha,
+                           Series_Pyramid const &pyramid = {}) const;
+
+    /** Put into \a out the vertices which \c draw_time_series would draw
+     *  for the \a series (oldest first). */
+    void decimate (Time_Series const &series,
+                   Series_Pyramid const &pyramid,
+                   vector <Event> &out) const;
         
 
     /** Move the `pen' to the position on the chart corresponding to the
@@ -153,6 +174,17 @@ namespace DMBCS::Trader_Desk {
     void render (Text &);
 
 
+    /** The number of device pixels to each unit of the surface \a cairo
+     *  draws on (two on most high-density displays). */
+    static double  device_scale  (Cairo::RefPtr <Cairo::Context> const &);
+
+    /** A new, clear image of \a width by \a height units, with \a scale
+     *  device pixels to each unit, so that it can be painted onto a
+     *  surface of that scale without being blurred. */
+    static Cairo::RefPtr <Cairo::ImageSurface>
+                         scaled_image  (int width,  int height,  double scale);
+
+
   };  /* End of class Chart_Context. */
 
 
@@ -29,12 +29,79 @@ namespace DMBCS::Trader_Desk {
   constexpr const Currency_Value  Chart_Data::NO_POSITION;
 
 
+
+Chart_Data::~Chart_Data ()
+  {
+    reap_prefetch ();
+
+    lock_guard  l  {change_mutex};
+    if (flush_source)    g_source_remove (flush_source);
+  }
+
+
+
+extern "C"  int  flush_chart_data_changes  (gpointer  chart_data)
+     {
+          auto *const  CD  {(Chart_Data*) chart_data};
+          {lock_guard  l  {CD->change_mutex};    CD->flush_source = 0;}
+          CD->flush_changes ();
+          return 0;
+     }
+
+
+
+/* Source of values for Chart_Data::prices_version. */
+static  atomic <uint64_t>  last_prices_version  {0};
+
+
+uint64_t  Chart_Data::new_prices_version  ()
+  {
+    return  ++last_prices_version;
+  }
+
+
+
+void  Chart_Data::note_change  (uint32_t const  what,
+                                Time_Point const  tail_from)
+  {
+    lock_guard  l  {change_mutex};
+
+    if (what & Change::PRICES)    prices_version  =  new_prices_version ();
+
+    pending_change  |=  Change {what,  tail_from};
+
+    /* Run ahead of GDK's own redraw source, so that subscribers have
+       recomputed by the time the frame is painted. */
+    if (! flush_source)
+      flush_source  =  gdk_threads_add_idle_full  (GDK_PRIORITY_REDRAW - 10,
+                                                   flush_chart_data_changes,
+                                                   this,
+                                                   nullptr);
+  }
+
+
+
+void  Chart_Data::flush_changes  ()
+  {
+    Change  c;
+
+    {lock_guard  l  {change_mutex};
+         if (flush_source)    g_source_remove (flush_source);
+         flush_source  =  0;
+         swap (c,  pending_change);
+    }
+
+    if (c.what)    changed_signal.emit (c);
+  }
+
+
 void  Chart_Data::timeseries__change_span  (DB&  db,  const Duration&  window)
 try  
   {
     const auto  start  {TODAY_MARK - window};
 
     bool test;
+    uint32_t  head_change  {0};
     {lock_guard  l  {prices_mutex};
         test  =  prices.empty ()  ?  1  :  start < prices.back ().time;
     }
@@ -46,13 +113,14 @@ try
               {
                    prices.extend_range  (db,  company_seqid,  window);
                    last_fetch_time  =  start;
+                   head_change  =  Change::EXTENDED_HEAD;
               }
       }
 
     const Time_Series::Range  hold  {extremes};
     update_extremes (window);
-    /* We are always in the GTK thread. */
-    if (hold != extremes)    changed_signal.emit ();
+    if (hold != extremes)
+      note_change  (Change::RANGE  |  head_change);
   }
 catch  (Mysql::DB_Connection::Exception&)  {}
   
@@ -79,7 +147,8 @@ static  void  new_timeseries (Chart_Data *const  CD,
     CD->last_fetch_time   =   t  -  immediate_window;
     
     CD->update_extremes (window);
-    CD->changed_signal.emit ();
+    CD->note_change (Chart_Data::Change::NEW_COMPANY
+                        | Chart_Data::Change::RANGE);
 
     if (window != immediate_window)
             CD->prefetch_ (db.current_preferences,  {window});
@@ -108,12 +177,31 @@ void Chart_Data::new_company (DB&  db,
           new_company_signal.emit ();
      }
 
+void Chart_Data::new_company (const int           company_seqid_,
+                              const string&       name,
+                              Time_Series&&       prices_,
+                              const Time_Point&   fetch_time,
+                              const Duration&     window)
+     {
+          kill_prefetch ();
+          reap_prefetch ();
+
+          return_subsumed ();
+          subsumed_object = nullptr;
 
+          company_seqid = company_seqid_;
+          company_name = name;
 
-extern "C"  int  emit_changed_signal  (gpointer  signal)
-     {
-          ((sigc::signal<void>*) signal)->emit ();
-          return 1;
+          {lock_guard  l  {prices_mutex};
+               prices = move (prices_);
+          }
+
+          extremes = Time_Series::Range {};
+          last_fetch_time = fetch_time - window;
+
+          update_extremes (window);
+          note_change (Change::NEW_COMPANY | Change::RANGE);
+          new_company_signal.emit ();
      }
 
 
@@ -152,18 +240,11 @@ static  void  do_prefetch
           {
             CD.update_extreme_prices ();
 
-            /* !!!! Unfortunate that this appears here--and the gtkmm
-             *      header--(we have nothing to do with the graphics
-             *      plane).  Funny that it doesn't work at the point where
-             *      we actually enter the graphics plane, but I guess
-             *      other parts of the system react to this signal and
-             *      they in turn will trigger the graphics plane.  We are
-             *      going to have to investigate all the points where
-             *      signals are emitted! (Maybe it is just occurrences of
-             *      this one particular signal?) */
-
-            /* ALWAYS outside the GTK thread. */
-            gdk_threads_add_idle  (emit_changed_signal, &CD.changed_signal);
+            /* ALWAYS outside the GTK thread; note_change takes care of
+             * getting the signal over to the other side, and many chunks
+             * arriving in quick succession will result in just one. */
+            CD.note_change  (Chart_Data::Change::EXTENDED_HEAD
+                                 | Chart_Data::Change::RANGE);
           }
         }
   }
@@ -222,8 +303,7 @@ void Chart_Data::note_current_price  (DB&  db,  Currency_Value const &value)
              << number<chrono::seconds>  (latest_price.time.time_since_epoch ())
              << ") where seqid=" << company_seqid;
 
-      /* Always in GTK thread. */
-      changed_signal.emit ();
+      note_change  (Change::NEW_TAIL | Change::RANGE,  latest_price.time);
   }
 
 
@@ -246,7 +326,8 @@ void  Chart_Data::subsume  (Chart_Data *const  c)
           company_name    = c->company_name;
           latest_price    = c->latest_price;
 
-          changed_signal.emit ();
+          note_change  (Change::NEW_COMPANY | Change::RANGE);
+          prices_version  =  c->prices_version.load ();
           new_company_signal.emit ();
       }
 
@@ -269,6 +350,8 @@ void  Chart_Data::return_subsumed  ()
              subsumed_object->last_fetch_time = last_fetch_time;
         }
 
+        subsumed_object->prices_version  =  prices_version.load ();
+
         subsumed_object  =  nullptr;
     }
 
@@ -289,7 +372,9 @@ void  Chart_Data::new_event  (const Event&  e,  const bool&  no_signal)
            extremes.max_value = max (extremes.max_value, e.price);
 
            if (! no_signal)    {    unaccurate = 0;
-                                    changed_signal.emit ();    }
+                                    note_change  (Change::NEW_TAIL
+                                                      | Change::RANGE,
+                                                  e.time);    }
       }
 
     
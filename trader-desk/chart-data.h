@@ -22,8 +22,11 @@
 #define DMBCS__TRADER_DESK__CHART_DATA__H
 
 
+#include <trader-desk/db.h>
 #include <trader-desk/time-series.h>
 #include <sigc++/sigc++.h>
+#include <atomic>
+#include <cstdint>
 #include <mutex>
 #include <thread>
 
@@ -47,6 +50,59 @@ namespace DMBCS::Trader_Desk {
 
   struct Chart_Data
   {
+    /** A description of what has happened to the data since the
+     *  subscribers to \c changed_signal were last told.  Notes of changes
+     *  made between two screen frames are merged into one of these, and
+     *  the signal is emitted once with the union of them all. */
+    struct Change
+    {
+      /** Bits for the \c what member. */
+      enum : uint32_t
+        {
+          /** New events were added at the most recent end of the
+           *  time-series (the front of \c prices); see \c tail_from. */
+          NEW_TAIL       =  1 << 0,
+
+          /** Older history was added at the far end of the time-series,
+           *  usually by the background pre-fetch thread. */
+          EXTENDED_HEAD  =  1 << 1,
+
+          /** The \c extremes (the window of interest, or the price range
+           *  within it) have moved. */
+          RANGE          =  1 << 2,
+
+          /** The user's position (\c number_shares, \c open_position)
+           *  has been altered; the prices themselves are untouched. */
+          POSITION       =  1 << 3,
+
+          /** The whole data set has been replaced with that of another
+           *  company. */
+          NEW_COMPANY    =  1 << 4,
+
+          /** Anything which changes the contents of \c prices. */
+          PRICES         =  NEW_TAIL | EXTENDED_HEAD | NEW_COMPANY
+        };
+
+      /** Bit-wise OR of the above. */
+      uint32_t  what  {0};
+
+      /** If \c NEW_TAIL is set, the time of the oldest of the new events,
+       *  so that incremental computations know where to pick up from. */
+      Time_Point  tail_from  {Time_Point::max ()};
+
+      /** Is any of the bits in \a w set? */
+      bool  any  (uint32_t const  w)  const   {  return  what & w;  }
+
+      /** Merge another change into this one. */
+      Change&  operator|=  (Change const &c)
+      {
+        what  |=  c.what;
+        tail_from  =  min (tail_from,  c.tail_from);
+        return *this;
+      }
+    };
+
+
     /** A placebo value to indicate that no actual position on the chart
      *  is used. */
     static constexpr Currency_Value  const NO_POSITION  {-1.0};
@@ -107,8 +163,33 @@ namespace DMBCS::Trader_Desk {
      *  so that it can subsequently be returned. */
     Chart_Data *subsumed_object {nullptr};
 
-    /** We emit this signal when any aspect of the data are changed. */
-    sigc::signal<void>  changed_signal;
+    /** We emit this signal, in the GTK thread, when any aspect of the
+     *  data are changed.  Do not emit it directly; call \c note_change
+     *  instead, so that bursts of changes result in one emission. */
+    sigc::signal<void,  Change const &>  changed_signal;
+
+    /** Changes noted but not yet delivered through \c changed_signal;
+     *  protected by \c change_mutex. */
+    Change  pending_change;
+
+    /** Access to \c pending_change and \c flush_source needs this. */
+    mutex  change_mutex;
+
+    /** The GLib source id of a scheduled delivery of \c pending_change,
+     *  or zero if none is outstanding. */
+    unsigned  flush_source  {0};
+
+    /** Given a new value every time a change to the contents of \c
+     *  prices is noted.  Values are unique across all \c Chart_Data
+     *  objects, except that when data are subsumed the version goes with
+     *  them.  Background computations tag their results with this, so
+     *  that out-of-date results can be recognized, and cached results can
+     *  be found again. */
+    atomic <uint64_t>  prices_version  {0};
+
+    /** A value for a \c prices_version which is greater than any given
+     *  out so far. */
+    static uint64_t  new_prices_version  ();
 
     /** This signal is emitted after the data have been completely
      *  subsumed by those for another company. */
@@ -133,10 +214,21 @@ namespace DMBCS::Trader_Desk {
 
 
     /** The destructor simply cleans up all of its resources. */
-    ~Chart_Data ()
-    {
-      reap_prefetch ();
-    }
+    ~Chart_Data ();
+
+
+    /** Record that the data have changed as described by \a what (and \a
+     *  tail_from, see the \c Change class), and arrange for \c
+     *  changed_signal to be emitted in the GTK thread before the next
+     *  frame is drawn.  May be called from any thread, any number of
+     *  times; the notes are merged and delivered just once. */
+    void note_change (uint32_t const what,
+                      Time_Point const tail_from = Time_Point::max ());
+
+
+    /** Deliver any pending change immediately.  Must be called in the GTK
+     *  thread; normally this happens automatically. */
+    void flush_changes ();
 
     
     /** Put a flag up to instruct a running background data pre-fetch
@@ -208,6 +300,16 @@ namespace DMBCS::Trader_Desk {
                       const string&    name,
                       const Duration&  window,
                       const Duration&  market_close_time);
+
+
+    /** As the above, but with the \a prices already read from the
+     *  database (perhaps in another thread) over the \a window back from
+     *  \a fetch_time, so that no database access is made here. */
+    void new_company (const int           company_seqid,
+                      const string&       name,
+                      Time_Series&&       prices,
+                      const Time_Point&   fetch_time,
+                      const Duration&     window);
     
 
     /** Flag for the following method. */
@@ -215,8 +317,8 @@ namespace DMBCS::Trader_Desk {
     
     /** Insert the new datum \a e into the \c prices time-series, and
      *  update the extremes if the new point is more recent than the start
-     *  of the current extremes (the usual case).  A \c changed_signal
-     *  will be emitted unless \c NO_SIGNAL is passed as the second
+     *  of the current extremes (the usual case).  A \c NEW_TAIL change
+     *  will be noted unless \c NO_SIGNAL is passed as the second
      *  argument. */
     void new_event (Event const &e, bool const &no_signal = 0);
 
@@ -19,6 +19,7 @@
 
 
 #include <trader-desk/chart-grid.h>
+#include <limits>
 
     
 /** \file
@@ -30,40 +31,173 @@ namespace DMBCS::Trader_Desk {
 
 
   constexpr chrono::hours const Chart_Grid::DEFAULT_SPAN;
+  constexpr int const Chart_Grid::THUMB_WIDTH;
+  constexpr int const Chart_Grid::THUMB_HEIGHT;
+
+
+Chart_Grid::Sheet::Sheet  (Chart_Grid&  g)  :  grid {g}
+   {
+       add_events (Gdk::BUTTON_RELEASE_MASK);
+   }
+
+
+
+Gtk::SizeRequestMode  Chart_Grid::Sheet::get_request_mode_vfunc  ()  const
+  {
+    return Gtk::SIZE_REQUEST_HEIGHT_FOR_WIDTH;
+  }
+
+
+
+void  Chart_Grid::Sheet::get_preferred_width_vfunc  (int&  minimum,
+                                                     int&  natural)  const
+  {
+    minimum = THUMB_WIDTH;
+    natural = THUMB_WIDTH * grid.columns_for (numeric_limits<int>::max ());
+  }
+
+
+
+void  Chart_Grid::Sheet::get_preferred_height_for_width_vfunc
+                                          (int const  width,
+                                           int&  minimum,
+                                           int&  natural)  const
+  {
+    minimum = natural = THUMB_HEIGHT * grid.rows_for (grid.columns_for (width));
+  }
+
+
+
+void  Chart_Grid::Sheet::get_preferred_height_vfunc  (int&  minimum,
+                                                      int&  natural)  const
+  {
+    int  width, ignore;
+    get_preferred_width_vfunc (ignore, width);
+    get_preferred_height_for_width_vfunc (width, minimum, natural);
+  }
+
+
+
+void  Chart_Grid::Sheet::get_preferred_width_for_height_vfunc
+                                          (int,
+                                           int&  minimum,
+                                           int&  natural)  const
+  {
+    get_preferred_width_vfunc (minimum, natural);
+  }
+
+
+
+bool  Chart_Grid::Sheet::on_draw  (const Cairo::RefPtr<Cairo::Context>&  C)
+  {
+    grid.draw_sheet (C);
+    return 1;
+  }
+
+
+
+bool  Chart_Grid::Sheet::on_button_release_event  (GdkEventButton *const  event)
+  {
+    grid.select_at (event->x,  event->y);
+    return 1;
+  }
+
 
 
 Chart_Grid::Chart_Grid   (Preferences&  P,
 			  const Market_Meta_Data&  m)
            :  user_prefs {P},  market {m}
    {
-       add_events (Gdk::BUTTON_RELEASE_MASK);
-       add (table);
+       set_policy (Gtk::POLICY_NEVER,  Gtk::POLICY_AUTOMATIC);
+       add (sheet);
        DB  db  {user_prefs};
        regenerate (db,  P,  1 /* force */);
    }
 
 
 
-Chart*  Chart_Grid::find_chart  (const int&  company_seqid)
+int  Chart_Grid::columns_for  (int const  width)  const
+  {
+    /* As square as possible, but no narrower than a thumb. */
+    return max (1,  min (int (ceil (sqrt (companies.size ()))),
+                         width / THUMB_WIDTH));
+  }
+
+
+
+int  Chart_Grid::rows_for  (int const  columns)  const
   {
-    auto const c = find_if (begin (chart), end (chart),
-                            [company_seqid] (unique_ptr<Chart> const &x)
-                                       { return x->data.company_seqid 
-                                                          == company_seqid; });
+    return (int (companies.size ()) + columns - 1) / columns;
+  }
+
+
+
+shared_ptr<Chart>  Chart_Grid::find_chart  (const int&  company_seqid)
+  {
+    lock_guard  l  {charts_mutex};
+
+    auto const  i  {company_index.find (company_seqid)};
+
+    if (i == end (company_index))    return nullptr;
+
+    auto const  c  {companies [i->second].chart};
+
+    /* The data are going to the database, and will be read from there
+     * when the chart is made, but anything which depends on them needs to
+     * know they have changed. */
+    if (! c)
+      {
+        unseen_version = Chart_Data::new_prices_version ();
+        companies [i->second].stale = 1;
+      }
+
+    return c;
+  }
+
+
+
+Chart*  Chart_Grid::open_chart  (const int&  company_seqid)
+  {
+    auto const  i  {company_index.find (company_seqid)};
+
+    if (i == end (company_index))    return nullptr;
 
-    return  c != end (chart)  ?  c->get ()  :  nullptr;
+    auto &c  {companies [i->second]};
+
+    if (! c.chart)
+      {
+        unique_ptr<DB>  db;
+        materialize (c,  db);
+        c.loaded.reset ();
+      }
+
+    return c.chart.get ();
+  }
+
+
+
+uint64_t  Chart_Grid::prices_version  ()  const
+  {
+    /* Chart_Data::prices_version's are drawn from a single increasing
+     * sequence, so any change to any chart makes a new maximum. */
+    uint64_t  ret  {unseen_version};
+    lock_guard  l  {charts_mutex};
+    for (auto const &c : companies)
+      if (c.chart)
+        ret = max (ret,  c.chart->data.prices_version.load ());
+    return ret;
   }
 
 
 
-void   Chart_Grid::regenerate   (DB&  db,  Preferences&  P,  const bool  force)
+void   Chart_Grid::regenerate   (DB&  db,  Preferences&,  const bool  force)
   {
     if   (force   ||   update_components (market,
                                           db,
                                           (Gtk::Window*) get_toplevel ()))
       {
-        table.resize (1, 1);
-        chart.clear ();
+        selection = nullptr;
+        atlas.clear ();
 
         auto sql = db.row_query ();
 
@@ -74,78 +208,231 @@ void   Chart_Grid::regenerate   (DB&  db,  Preferences&  P,  const bool  force)
 
         sql.execute ();
 
-        int number_columns = int (ceil (sqrt (sql.number_rows ())));
+        vector<Company>  C;
+        unordered_map<int, size_t>  I;
 
-        chart.reserve (sql.number_rows ());
-
-        int  row  {0};
-        int  column  {0};
+        C.reserve (sql.number_rows ());
 
+        /* Nothing else is read until the companies come into view, so
+         * that we donʼt delay getting the application started by
+         * pre-loading tons of data. */
         for (; sql; ++sql)
           {
             const auto  seqid  {sql.next_entry<int> ()};
+            I [seqid] = C.size ();
+            C.push_back ({seqid,  sql.next_entry<string> (),  {},  {},  0});
+          }
 
-            chart.emplace_back (new Chart {Chart::Style::THUMB,  P});
+        {
+          lock_guard  l  {charts_mutex};
+          companies.swap (C);
+          company_index.swap (I);
+        }
 
-            /* We fix up the zero duration when the widget is exposed, so
-             * that we donʼt delay getting the application started by
-             * pre-loading tons of data. */
-            chart.back ()->data.new_company (db,
-                                             seqid,
-                                             sql.next_entry<string> (),
-                                             chrono::hours {50*24},
-                                             market.world_data.close_time);
+        sheet.queue_resize ();
+        show_all ();
+      }
+  }
 
-            table.attach (*chart.back (), column, column + 1, row, row + 1);
 
-            if (0  ==  (column = (column+1) % number_columns))    ++row;
-          }
 
-        show_all ();
-      }
+/* The update threads may hold on to a chart after we have let it go, and
+ * it is a widget, so whoever lets go last has it deleted in the GTK
+ * thread. */
+static  void  delete_in_gtk_thread  (Chart *const  c)
+  {
+    post_to_gtk_thread ([c] { delete c; });
   }
 
 
 
-bool Chart_Grid::on_draw (const Cairo::RefPtr<Cairo::Context>&  C)
+void  Chart_Grid::materialize  (Company&  c,  unique_ptr<DB>&  db)
   {
-    unique_ptr<DB>  db;
+    if (! db)  db  =  make_unique<DB>  (user_prefs);
+
+    auto  chart  {make_unique<Chart> (Chart::Style::THUMB,  user_prefs)};
+
+    chart->data.new_company (*db,
+                             c.seqid,
+                             c.name,
+                             DEFAULT_SPAN,
+                             market.world_data.close_time);
 
-    for (auto &c : chart)
+    chart->data.changed_signal.connect ([this] (Chart_Data::Change const &)
+                                        { sheet.queue_draw (); });
+
+    lock_guard  l  {charts_mutex};
+    c.chart = shared_ptr<Chart> {chart.release (),  delete_in_gtk_thread};
+  }
+
+
+
+void  Chart_Grid::materialize  (Company&  c,  const Loaded&  l)
+  {
+    auto  chart  {make_unique<Chart> (Chart::Style::THUMB,  user_prefs)};
+
+    chart->data.new_company (c.seqid,
+                             c.name,
+                             Time_Series {l.prices},
+                             l.time,
+                             DEFAULT_SPAN);
+
+    chart->data.changed_signal.connect ([this] (Chart_Data::Change const &)
+                                        { sheet.queue_draw (); });
+
+    lock_guard  m  {charts_mutex};
+    c.chart = shared_ptr<Chart> {chart.release (),  delete_in_gtk_thread};
+  }
+
+
+
+void  Chart_Grid::release_outside  (size_t const  begin,  size_t const  end)
+  {
+    lock_guard  l  {charts_mutex};
+
+    for (size_t i = 0;  i < companies.size ();  ++i)
       {
-        if  (c->data.extremes.start_time  ==  c->data.extremes.end_time)
-	  {
-	    if (! db)  db  =  make_unique<DB>  (user_prefs);
-	    c->data.timeseries__change_span (*db,  DEFAULT_SPAN);
-	  }
-        else
-          table.propagate_draw (*c, C);
+        if (i >= begin  &&  i < end)    continue;
+
+        auto &c  {companies [i]};
+
+        c.loaded.reset ();
+
+        if (! c.chart  ||  c.chart.get () == selection)    continue;
+
+        /* prices_version must never go backwards. */
+        unseen_version = max (unseen_version.load (),
+                              c.chart->data.prices_version.load ());
+
+        c.chart.reset ();
       }
+  }
 
-    return 1;
+
+
+void  Chart_Grid::load  (Company&  c)
+  {
+    if (c.loaded)    return;
+
+    c.loaded  =  make_unique<Background_Result<Loaded>> ();
+
+    {
+      lock_guard  l  {charts_mutex};
+      c.stale = 0;
+    }
+
+    c.loaded->request
+          ({1,  0},
+           [&P = user_prefs,
+            seqid = c.seqid,
+            close = market.world_data.close_time]
+           {
+             const auto  t  {chrono::system_clock::now ()};
+
+             /* If the database cannot be had, the chart is made empty and
+              * the update threads will fill it in when they can. */
+             try
+               {
+                 DB  db  {P};
+                 return  Loaded {t,  Time_Series::from_database
+                                           (db,  seqid,  t,
+                                            DEFAULT_SPAN,  close)};
+               }
+             catch (Mysql::DB_Connection::Exception&)
+               {
+                 return  Loaded {t,  Time_Series {close}};
+               }
+           },
+           [this] { sheet.queue_draw (); });
   }
 
 
 
-bool  Chart_Grid::on_button_release_event  (GdkEventButton *const  event)
+void  Chart_Grid::draw_sheet  (const Cairo::RefPtr<Cairo::Context>&  C)
   {
-     if (chart.empty ())   return 0;
+    if (companies.empty ())    return;
+
+    const int  width   {sheet.get_allocated_width ()};
+    const int  height  {sheet.get_allocated_height ()};
+
+    const int  columns  {columns_for (width)};
+    const int  rows     {rows_for (columns)};
+
+    const int  cell_height  {max (1,  height / rows)};
+
+    atlas.arrange (companies.size (),  columns,  width / columns,  cell_height,
+                   Chart_Context::device_scale (C));
+
+    /* Only the rows which can be seen through the window are drawn. */
+    const auto  scroll  {get_vadjustment ()};
+    const double  top  {scroll->get_value ()};
+    const double  bottom  {scroll->get_page_size () > 0
+                              ?  top + scroll->get_page_size ()
+                              :  double (height)};
 
-     const Gtk::Allocation  alloc  {chart.front ()->get_allocation ()};
+    const int  first_row  {min (rows - 1,  max (0,  int (top) / cell_height))};
+    const int  end_row    {min (rows,  int (ceil (bottom / cell_height)))};
 
-     guint rows, columns;
-     table.get_size (rows, columns);
+    atlas.hold_rows (first_row,  max (1,  end_row - first_row));
 
-     const int  index = int (event->x) / alloc.get_width ()
-                          +  columns * (int (event->y) / alloc.get_height ());
+    /* Keep what we have for a page either side of the view, so that
+     * scrolling back and forth a little does not load everything
+     * again. */
+    const int  page  {max (1,  end_row - first_row)};
+    release_outside (size_t (max (0,  first_row - page) * columns),
+                     size_t ((end_row + page) * columns));
 
-     if (index >= 0  &&  index < int (chart.size ()))
+    for (size_t i = size_t (first_row * columns);
+         i < min (companies.size (),  size_t (end_row * columns));
+         ++i)
+      {
+        auto &c  {companies [i]};
+
+        if (! c.chart)
+          {
+            load (c);
+
+            if (auto const  l  {c.loaded->get ()})
+              {
+                bool  stale;
+                {
+                  lock_guard  m  {charts_mutex};
+                  stale = c.stale;
+                }
+
+                if (! stale)    materialize (c,  *l);
+                c.loaded.reset ();
+
+                /* Read again, if more data arrived while we were at it. */
+                if (stale)    load (c);
+              }
+          }
+
+        /* A company with nothing to show keeps its stand-in. */
+        if (! c.chart
+              ||  c.chart->data.extremes.start_time
+                              ==  c.chart->data.extremes.end_time)
+          atlas.placeholder (i,  c.name);
+
+        else
+          atlas.update (i,  c.chart->data,  [this] { sheet.queue_draw (); });
+      }
+
+    atlas.paint (C);
+  }
+
+
+
+void  Chart_Grid::select_at  (double const  x,  double const  y)
+  {
+     const int  index  {atlas.cell_at (x, y)};
+
+     if (index >= 0  &&  index < int (companies.size ())
+                     &&  companies [index].chart)
          {
-              selection = chart [index].get ();
+              selection = companies [index].chart.get ();
               selection_signal.emit ();
          }
-
-     return 1;
   }
 
 
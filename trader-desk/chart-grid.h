@@ -24,6 +24,9 @@
 
 #include <trader-desk/chart.h>
 #include <trader-desk/markets.h>
+#include <trader-desk/thumbnail-atlas.h>
+#include <atomic>
+#include <unordered_map>
 
 
 /** \file
@@ -35,22 +38,67 @@ namespace DMBCS::Trader_Desk {
 
 
   /** Widget which manages a whole bunch of charts, for all companies in a
-   *  market, and displays them all at once in a grid on the screen. */
-
-  struct Chart_Grid : Gtk::EventBox
+   *  market, and displays them all at once in a grid on the screen.  The
+   *  charts themselves are not put on the screen; pictures of them are
+   *  rendered in the background into a \c Thumbnail_Atlas, and that is
+   *  painted in one go.
+   *
+   *  Big markets do not fit on the screen at a useful size, so the grid
+   *  scrolls.  A company's \c Chart is only brought into being when its
+   *  cell first comes into view, and its data are read from the database
+   *  on the worker pool meanwhile, so that scrolling never waits on the
+   *  database.  Charts, and pictures of them, are let go again when they
+   *  are more than a page out of view, so that only those around the
+   *  view take up memory. */
+
+  struct Chart_Grid : Gtk::ScrolledWindow
   {
     Preferences&  user_prefs;
 
     /** The duration displayed in each thumbnail. */
     static constexpr chrono::hours const DEFAULT_SPAN {50 * 24};
 
-    /** Object packed with nothing but \c Chart widgets. */
-    Gtk::Table table;
-
-    /** All the \c Chart's we are managing. */
-    vector <unique_ptr <Chart>> chart;
-
-    /** Pointer into the \c chart list: the one we last clicked on. */
+    /** The smallest size at which we will show a thumbnail; if the
+     *  market does not fit in the window at this size, the grid
+     *  scrolls. */
+    static constexpr int const THUMB_WIDTH  {100};
+    static constexpr int const THUMB_HEIGHT {60};
+
+    /** The prices of a company read from the database in the
+     *  background, and when they were read. */
+    struct Loaded
+    {
+      Time_Point   time;
+      Time_Series  prices;
+    };
+
+    /** What we hold for each company in the market. */
+    struct Company
+    {
+      int     seqid;
+      string  name;
+
+      /** Made when the company's data have been \c loaded, and let go
+       *  when the cell is well out of view.  The update threads may hold
+       *  on to it for a while after that (see \c find_chart). */
+      shared_ptr<Chart>  chart;
+
+      /** The reading of the data, asked for when the company's cell
+       *  first comes into view. */
+      unique_ptr<Background_Result<Loaded>>  loaded;
+
+      /** Set (under the \c charts_mutex) when new data have been sent to
+       *  the database since the reading was asked for, so that it needs
+       *  doing again. */
+      bool  stale  {0};
+    };
+
+    /** All the companies in the market, in name order, which is the
+     *  order of the cells in the grid. */
+    vector <Company> companies;
+
+    /** Pointer to the chart we last clicked on, whose data the hand
+     *  analysis takes over; this one is never let go. */
     Chart *selection {nullptr};
 
     /** We emit this whenever the user clicks on a chart in the grid. */
@@ -60,12 +108,104 @@ namespace DMBCS::Trader_Desk {
     Market_Meta_Data market;
 
 
+  private:
+
+    /** The area inside the scrolled window on which we draw, as tall as
+     *  all the rows of the grid together. */
+    struct Sheet : Gtk::DrawingArea
+    {
+      Chart_Grid &grid;
+
+      explicit Sheet (Chart_Grid &);
+
+      /** Our height depends on how many cells fit across our width. */
+      Gtk::SizeRequestMode get_request_mode_vfunc () const override;
+      void get_preferred_width_vfunc (int &minimum,
+                                      int &natural) const override;
+      void get_preferred_height_for_width_vfunc (int width,
+                                                 int &minimum,
+                                                 int &natural) const override;
+      void get_preferred_height_vfunc (int &minimum,
+                                       int &natural) const override;
+      void get_preferred_width_for_height_vfunc (int height,
+                                                 int &minimum,
+                                                 int &natural) const override;
+
+      bool on_draw (const Cairo::RefPtr<Cairo::Context>&) override;
+      bool on_button_release_event (GdkEventButton *const) override;
+    };
+
+    Sheet sheet  {*this};
+
+    /** The pictures of the cells in view, which we put on the screen. */
+    Thumbnail_Atlas atlas;
+
+    /** The \c seqid of each of the \c companies, and its index. */
+    unordered_map <int, size_t> company_index;
+
+    /** Protects the \c Company::chart's and \c Company::stale's, which
+     *  may be looked up by \c find_chart in another thread while we make
+     *  them. */
+    mutable mutex charts_mutex;
+
+    /** Moved on whenever data arrive for a company whose chart has not
+     *  been made: see \c prices_version. */
+    atomic <uint64_t> unseen_version {0};
+
+    /** The number of cells across a sheet \a width pixels wide. */
+    int columns_for (int width) const;
+
+    /** The number of rows of cells, if there are \a columns of them. */
+    int rows_for (int columns) const;
+
+    /** Make the chart for company \a c, loading its data from the \a db
+     *  (which is connected if necessary). */
+    void materialize (Company &c,  unique_ptr<DB> &db);
+
+    /** Make the chart for company \a c from the data in \a l. */
+    void materialize (Company &c,  Loaded const &l);
+
+    /** Make sure that the data for company \a c are on their way. */
+    void load (Company &c);
+
+    /** Let go of the charts (other than the \c selection) of all the
+     *  companies outside the \a begin to \a end indices, and their
+     *  data. */
+    void release_outside (size_t begin,  size_t end);
+
+    /** Make sure all the charts in view are made, or their data are
+     *  being loaded, and that the \c atlas has up-to-date pictures of
+     *  them (or stand-ins until they are made), and paint it. */
+    void draw_sheet (const Cairo::RefPtr<Cairo::Context>&);
+
+    /** Select the chart under the point (\a x, \a y) of the sheet, and
+     *  emit the \c selection_signal. */
+    void select_at (double x,  double y);
+
+
+  public:
+
     /** Sole constructor, gives us a fully operational object. */
     Chart_Grid (Preferences&, const Market_Meta_Data&);
 
     /** Find the chart corresponding to the company with the database \a
-     *  seqid, or return \c nullptr. */
-    Chart *find_chart (int const &seqid);
+     *  seqid, or return \c nullptr if there is none or it has not been
+     *  made yet (in the latter case the data will be read from the
+     *  database when the chart is made).  May be called in any thread;
+     *  the chart stays alive while the caller holds on to it, even if we
+     *  let it go. */
+    shared_ptr<Chart> find_chart (int const &seqid);
+
+    /** Find the chart corresponding to the company with the database \a
+     *  seqid, making it if necessary, or return \c nullptr if there is no
+     *  such company in our market.  Only to be called in the GTK
+     *  thread. */
+    Chart *open_chart (int const &seqid);
+
+    /** A number which changes whenever the prices held by any of our
+     *  charts do, or \c find_chart is asked for a chart which has not
+     *  been made yet. */
+    uint64_t prices_version () const;
 
     /** Completely re-construct this object based on the data currently in
      *  the database.  If \a force is TRUE, then this object will be
@@ -74,16 +214,7 @@ namespace DMBCS::Trader_Desk {
      *  information about the market components, and if a change is made
      *  in these then this object will be refreshed. */
     void regenerate (DB &,  Preferences&,  bool const force = 0);
-
-    /** Make sure all the individual charts have their data loaded before
-     *  we attempt to render them on-screen. */
-    bool on_draw (const Cairo::RefPtr<Cairo::Context>&) override;
-
-    /** Called when the user selects an individual chart.  We update our
-     *  state and emit the \c selection_signal. */
-    bool on_button_release_event (GdkEventButton *const) override;
     
-
   };  /* End of class Chart_Grid. */
 
     
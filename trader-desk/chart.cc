@@ -20,6 +20,7 @@
 
 #include <trader-desk/chart.h>
 #include <iomanip>
+#include <optional>
 #include <set>
 
 
@@ -31,107 +32,143 @@
 namespace DMBCS::Trader_Desk {
 
 
-  Chart::Chart (uint32_t const features_,  Preferences&  P)
+  Chart_Renderer::Chart_Renderer (uint32_t const features_,  Preferences&  P)
     :  features (features_)
   {
-    data . changed_signal . connect ([this] { queue_draw (); });
+    data . changed_signal
+         . connect ([this] (Chart_Data::Change const &)
+                    { redraw_needed_.emit (); });
       
-    /* Big enough for at least a thumb; we will take up more space if we're
-     * offered it. */
-    set_size_request  (40, 25);
-
-    if (features & Feature::CROSS_HAIRS)
-      add_events (Gdk::POINTER_MOTION_MASK | Gdk::LEAVE_NOTIFY_MASK
-                      | Gdk::BUTTON_PRESS_MASK | Gdk::BUTTON_RELEASE_MASK);
-
     if (features & Feature::ANALYZERS)
-      analyzer =  make_unique<Analyzer_Stack> (data,  P);
+      {
+        analyzer =  make_unique<Analyzer_Stack> (data,  P);
+        analyzer->instrument (timings);
+        analyzer->signal_redraw_needed ()
+                 .connect ([this] { ++analysis_version; });
+      }
   }
-    
 
 
-  bool Chart::on_motion_notify_event (GdkEventMotion *const motion)
+
+  void Chart_Renderer::pointer_moved (double const x,  double const y)
   {
     if (features & Feature::CROSS_HAIRS)
       {
         if (analyzer)
-          analyzer->button_move (motion->x, motion->y);
+          analyzer->button_move (x, y);
     
-        pointer_x = (int) motion->x;
-        pointer_y = (int) motion->y;
+        pointer_x = (int) x;
+        pointer_y = (int) y;
 
-        queue_draw ();
+        redraw_needed_.emit ();
       }
-
-    return 1;
   }
 
 
 
-  bool Chart::on_leave_notify_event (GdkEventCrossing *const)
+  void Chart_Renderer::pointer_left ()
   {
     pointer_x  =  pointer_y  =  -1;
-    queue_draw ();
-    return 1;
+    redraw_needed_.emit ();
   }
 
 
 
-  bool Chart::on_button_press_event (GdkEventButton *const event)
+  bool Chart_Renderer::button_down (double const x,  double const y)
   {
     return  features & Feature::CROSS_HAIRS
                 &&  analyzer
-                &&  analyzer->button_down (event->x, event->y);
+                &&  analyzer->button_down (x, y);
   }
 
     
 
-  bool Chart::on_button_release_event (GdkEventButton *const event)
+  bool Chart_Renderer::button_up (double const x,  double const y)
   {
     return  features & Feature::CROSS_HAIRS
                 &&  analyzer
-                &&  analyzer->button_up (event->x, event->y);
+                &&  analyzer->button_up (x, y);
+  }
+
+
+
+  Chart::Chart (uint32_t const features_,  Preferences&  P)
+    :  Chart_Renderer (features_,  P)
+  {
+    signal_redraw_needed ().connect ([this] { queue_draw (); });
+
+    /* Big enough for at least a thumb; we will take up more space if we're
+     * offered it. */
+    set_size_request  (40, 25);
+
+    if (features_ & Feature::CROSS_HAIRS)
+      add_events (Gdk::POINTER_MOTION_MASK | Gdk::LEAVE_NOTIFY_MASK
+                      | Gdk::BUTTON_PRESS_MASK | Gdk::BUTTON_RELEASE_MASK);
   }
     
 
 
-  /* !! We really want to paint most of the chart into memory, and map it
-   *    to the screen as required.  But we need to re-assess all the
-   *    tide-marks on the cursor line whenever the cursor moves. */
+  bool Chart::on_motion_notify_event (GdkEventMotion *const motion)
+  {
+    pointer_moved (motion->x,  motion->y);
+    return 1;
+  }
+
 
-  bool Chart::on_draw (const Cairo::RefPtr<Cairo::Context>&  cairo)
+
+  bool Chart::on_leave_notify_event (GdkEventCrossing *const)
   {
-    /* This object is constructed as we draw the various aspects of the
-     * chart, and then it is rendered on top of everything else right at
-     * the end of this method. */
-    Tide_Mark::List tide_marks;
+    pointer_left ();
+    return 1;
+  }
 
 
 
-    /***************  Set up the canvas.  **************************/
+  bool Chart::on_button_press_event (GdkEventButton *const event)
+  {
+    return  button_down (event->x,  event->y);
+  }
+
+    
+
+  bool Chart::on_button_release_event (GdkEventButton *const event)
+  {
+    return  button_up (event->x,  event->y);
+  }
+    
+
+
+  bool Chart::on_draw (const Cairo::RefPtr<Cairo::Context>&  cairo)
+  {
+    const Gtk::Allocation  allocation  {get_allocation ()};
+    render (cairo,  allocation.get_width (),  allocation.get_height ());
+    return 1;
+  }
 
-    Chart_Context  canvas;
 
-        {
-             const Gtk::Allocation  allocation  {get_allocation ()};
-             canvas.width   =  allocation.get_width ();
-             canvas.height  =  allocation.get_height ();
-        }
+
+  void Chart_Renderer::lay_out (Chart_Context &canvas,
+                                Cairo::RefPtr<Cairo::Context> const &cairo,
+                                int const width,
+                                int const height)
+  {
+    canvas.width   =  width;
+    canvas.height  =  height;
 
     canvas.left_border   = features & (int) Feature::AXIS_LABELS ? 45 : 4;
     canvas.bottom_border = features & (int) Feature::AXIS_LABELS ? 40 : 4;
     canvas.top_border    = 4;
     canvas.right_border  = 4;
 
+    /* Any analyzers which want panels of their own get a strip across the
+     * bottom of the widget, below the time axis. */
+    canvas.bottom_border += panel_space (height);
+
     canvas.cairo  =   cairo;
 
     canvas.pango  =   Pango::Layout::create (canvas.cairo);
     canvas.pango  ->  set_font_description (Pango::FontDescription ("Sans 7"));
 
-    canvas.set_source_rgb (data.unaccurate ? Colour::NO_DATA_REGION 
-                                           : Colour::CHART_BACKGROUND);
-    canvas.cairo  ->  paint ();
-
     canvas.outline  =  data.extremes;
 
     double const space  =  0.05  *  (canvas.outline.max_value
@@ -143,169 +180,187 @@ namespace DMBCS::Trader_Desk {
     if (analyzer)
       analyzer->stretch_outline (canvas.outline);
 
-    auto cursor_mark
-      = Tide_Mark::price_marker
-           (canvas.date (pointer_x),
-            canvas.outline.contains ({ canvas.date (pointer_x),
-                                       canvas.value (pointer_y)})
-              ?  Colour::CURSOR_TIDES
-              :  Colour::NO_DISPLAY);
-
-    auto current_mark = Tide_Mark::price_marker (canvas.outline.end_time,
-                                                 Colour::CHART_BACKGROUND);
-
     canvas.cairo->set_line_width (1.0);
+  }
 
 
 
-    /************************ No-data region. *******************************/
-
-    {
-      auto const r = data.prices.empty () ? canvas.outline.end_time 
-                                          : data.prices.back ().time;
-
-      if (r > canvas.outline.start_time)
-        {
-          canvas.set_source_rgb (Colour::NO_DATA_REGION);
+  double Chart_Renderer::panel_space (int const height) const
+  {
+    auto const  panels  {analyzer  ?  analyzer->number_panels ()  :  0};
+    return  panels  *  max (40.0,  0.15 * height);
+  }
 
-          canvas.move_to ({canvas.outline.start_time,
-                           canvas.outline.min_value});
 
-          canvas.line_to ({canvas.outline.start_time,
-                           canvas.outline.max_value});
 
-          canvas.line_to ({r, canvas.outline.max_value});
+  bool Chart_Renderer::Layer::current (Key const &k) const
+  {
+    return  surface
+              &&  k.width == key.width  &&  k.height == key.height
+              &&  k.scale == key.scale
+              &&  ! (k.outline != key.outline)
+              &&  k.number_shares == key.number_shares
+              &&  k.unaccurate == key.unaccurate
+              &&  k.prices_version == key.prices_version
+              &&  k.analysis_version == key.analysis_version;
+  }
 
-          canvas.line_to ({r, canvas.outline.min_value});
 
-          canvas.cairo->fill ();
-        }
-    }
 
+  template <typename Draw>
+  void Chart_Renderer::paint_layer
+                            (Layer &layer,
+                             Layer::Key const &key,
+                             Cairo::RefPtr<Cairo::Context> const &target,
+                             Draw  draw)
+  {
+    if (! (features & Feature::CROSS_HAIRS))
+      {
+        /* Nothing moves over this chart, so there is nothing to be gained
+         * by keeping copies of its layers. */
+        Chart_Context  canvas;
+        lay_out (canvas,  target,  key.width,  key.height);
+        draw (canvas);
+        return;
+      }
 
-    /***********  Let the analyzers draw themselves.  *************/
+    if (! layer.current (key))
+      {
+        if (! layer.surface
+                ||  layer.key.width != key.width
+                ||  layer.key.height != key.height
+                ||  layer.key.scale != key.scale)
+          layer.surface = Chart_Context::scaled_image (key.width,
+                                                       key.height,
+                                                       key.scale);
+
+        auto const  cairo  {Cairo::Context::create (layer.surface)};
+        cairo->set_operator (Cairo::OPERATOR_CLEAR);
+        cairo->paint ();
+        cairo->set_operator (Cairo::OPERATOR_OVER);
+
+        Chart_Context  canvas;
+        lay_out (canvas,  cairo,  key.width,  key.height);
+        draw (canvas);
+
+        layer.key = key;
+      }
 
-    if (analyzer)
-      analyzer->graph_draw_hook (canvas,
-                                 tide_marks,
-                                 data.number_shares,
-                                 {cursor_mark, current_mark});
+    target->set_source (layer.surface,  0.0,  0.0);
+    target->paint ();
+  }
 
 
-    /******** X-axis *******/
 
-    if (features  &  Feature::AXIS_LABELS)
-      {
-        canvas.set_source_rgb (Colour::TIME_AXIS);
+  void Chart_Renderer::render (Cairo::RefPtr<Cairo::Context> const &cairo,
+                               int const width,
+                               int const height)
+  {
+    Stage_Timer::Scope  total  {timings.get (),  "chart total"};
 
-        char buffer [200];
+    /* The parts of the chart which do not follow the mouse are kept in
+     * two off-screen layers: the background and axes, which change only
+     * when the geometry of the chart changes, and the data and the
+     * analyzers' drawings on top of those.  Each is re-painted only when
+     * something it shows has changed; otherwise the cross-hairs, tide
+     * marks and labels are simply drawn afresh over copies of them. */
 
-        auto const *disc = Date_Axis::discretization;
+    Chart_Context  canvas;
+    lay_out (canvas,  cairo,  width,  height);
 
-        time_t const t = chrono::system_clock::to_time_t 
-                                               (data.extremes.end_time);
+    /* The layers are kept at the resolution of the device, or else they
+     * would be blurred when painted onto a high-density display. */
+    Layer::Key  key  {width,  height,  Chart_Context::device_scale (cairo),
+                      canvas.outline,
+                      data.number_shares,  data.unaccurate,  0,  0};
 
-        for (; disc->format; ++disc)
-          {
-            /* If the spacing between ticks is less than one pixel,
-             * move on. */
-            if (disc->real_interval.count ()
-                    / double ((data.extremes.end_time
-                                       - data.extremes.start_time).count ())
-                      * (canvas.width - canvas.left_border
-                                             - canvas.right_border)
-                  <  1.0)
-              continue;
-
-            /* Find the box needed to enclose a label showing the
-             * current time. */
-            strftime (buffer, sizeof (buffer),
-                      disc->format,
-                      localtime (&t));
-
-            canvas.pango->set_text (buffer);
-
-            Pango::Rectangle const rect
-                  = canvas.pango->get_pixel_logical_extents ();
-
-            /* If the spacing between ticks is more than the space
-             * required to display the current date-time, then this is
-             * the tick spacing we will use. */
-            if (disc->real_interval.count ()
-                / double ((data.extremes.end_time
-                                   - data.extremes.start_time).count ())
-                  * (canvas.width - canvas.left_border
-                                         - canvas.right_border)
-                > rect.get_width () + 4)
-              break;
-          }
+    paint_layer (static_layer,  key,  cairo,
+                 [this] (Chart_Context &c)
+                 {
+                   Stage_Timer::Scope  s  {timings.get (),
+                                           "background and axes"};
+                   draw_static_layer (c);
+                 });
 
+    key.prices_version    =  data.prices_version;
+    key.analysis_version  =  analysis_version;
 
+    paint_layer (data_layer,  key,  cairo,
+                 [this] (Chart_Context &c)  {  draw_data_layer (c);  });
 
-        auto show_ticks = [&canvas, this]
-                             (Date_Axis::Discretization const &disc,
-                              uint32_t const &line_offset)
-          {
-            char buffer [200];
-
-            for (auto i = data.extremes.start_time;
-                 i <= data.extremes.end_time;
-                 i += disc.interval)
-              {
-                i = disc.round_down (i);
+    draw_overlay (canvas);
+  }
 
-                if (i > data.extremes.start_time)
-                  {
-                    auto i_ = chrono::system_clock::to_time_t (i);
 
-                    strftime (buffer, sizeof (buffer),
-                              disc.format,
-                              localtime (&i_));
 
-                    canvas.pango->set_text (buffer);
+  void Chart_Renderer::draw_static_layer (Chart_Context &canvas)
+  {
+    canvas.set_source_rgb (data.unaccurate ? Colour::NO_DATA_REGION 
+                                           : Colour::CHART_BACKGROUND);
+    canvas.cairo  ->  paint ();
 
-                    canvas.move_to ({i, canvas.outline.min_value});
 
-                    canvas.cairo->rel_move_to (0, line_offset + 1);
+    /******** X-axis *******/
 
-                    canvas.pango->add_to_cairo_context (canvas.cairo);
+    if (features  &  Feature::AXIS_LABELS)
+      {
+        /* The ticks and their laid-out labels are only worked out again
+         * when the time span, width or locale change. */
+        if (time_axis.update (data.extremes.start_time,
+                              data.extremes.end_time,
+                              int (canvas.width - canvas.left_border
+                                                - canvas.right_border),
+                              [&canvas] (string const &label)
+                              {
+                                canvas.pango->set_text (label);
+                                return double (canvas.pango
+                                                 ->get_pixel_logical_extents ()
+                                                 .get_width ());
+                              }))
+          {
+            time_axis_labels.clear ();
 
-                    canvas.cairo->fill ();
-                  }
+            for (auto const &tick : time_axis.ticks)
+              {
+                auto  label  {Pango::Layout::create (canvas.cairo)};
+                label->set_font_description
+                               (canvas.pango->get_font_description ());
+                label->set_text (tick.label);
+                time_axis_labels.push_back (label);
               }
-          };
-
+          }
 
+        canvas.set_source_rgb (Colour::TIME_AXIS);
 
-        if (disc->format)
+        for (size_t i = 0;  i < time_axis.ticks.size ();  ++i)
           {
-            show_ticks (*disc, 0);
+            auto const &tick   {time_axis.ticks [i]};
+            auto const &label  {time_axis_labels [i]};
 
-            if ((disc + 1)->format)
-              {
-                show_ticks (*(disc + 1), 11);
+            label->update_from_cairo_context (canvas.cairo);
 
-                if ((disc + 2)->format)
-                  show_ticks (*(disc + 2), 22);
-              }
+            canvas.move_to ({tick.time,  canvas.outline.min_value});
+            canvas.cairo->rel_move_to (0,  11 * tick.line + 1);
+            label->add_to_cairo_context (canvas.cairo);
+            canvas.cairo->fill ();
           }
       }
 
 
     /******** Y-axis ********/
 
-    canvas.pango
-      ->set_markup (string {"<span size=\"large\">"}
-                      + pgettext ("Label", "Position value (pounds)")
-                      + "</span>");
+    if (features & (int) Feature::AXIS_LABELS)
+      {
+        canvas.pango
+          ->set_markup (string {"<span size=\"large\">"}
+                          + pgettext ("Label", "Position value (pounds)")
+                          + "</span>");
 
-    const Pango::Rectangle extents
-                  = canvas.pango->get_pixel_logical_extents ();
+        const Pango::Rectangle extents
+                      = canvas.pango->get_pixel_logical_extents ();
 
-    const int font_height = extents.get_height ();
+        const int font_height = extents.get_height ();
 
-    if (features & (int) Feature::AXIS_LABELS)
-      {
         canvas.cairo->save ();
         canvas.cairo->rotate (- M_PI / 2.0);
         canvas.cairo->move_to (- (canvas.height - extents.get_width ()) 
@@ -315,10 +370,7 @@ namespace DMBCS::Trader_Desk {
         canvas.set_source_rgb (Colour::PRICE_AXIS);
         canvas.cairo->fill ();
         canvas.cairo->restore ();
-      }
 
-    if (features & (int) Feature::AXIS_LABELS)
-      {
         double const share_scale = data.number_shares / 100.0;
 
         double inc = 0.01;
@@ -353,8 +405,94 @@ namespace DMBCS::Trader_Desk {
               canvas.cairo->fill ();
             }
       }
+  }
+
+
+
+  void Chart_Renderer::draw_data_layer (Chart_Context &canvas)
+  {
+    /************************ No-data region. *******************************/
+
+    {
+      auto const r = data.prices.empty () ? canvas.outline.end_time 
+                                          : data.prices.back ().time;
+
+      if (r > canvas.outline.start_time)
+        {
+          canvas.set_source_rgb (Colour::NO_DATA_REGION);
+
+          canvas.move_to ({canvas.outline.start_time,
+                           canvas.outline.min_value});
+
+          canvas.line_to ({canvas.outline.start_time,
+                           canvas.outline.max_value});
+
+          canvas.line_to ({r, canvas.outline.max_value});
+
+          canvas.line_to ({r, canvas.outline.min_value});
+
+          canvas.cairo->fill ();
+        }
+    }
+
+
+    /***********  Let the analyzers draw themselves.  *************/
+
+    /* The analyzer stack times each analyzer itself. */
+    if (analyzer)
+      analyzer->graph_draw_hook (canvas);
+
+
+    /*****  Analyzer panels.  *****/
+
+    if (analyzer)
+      analyzer->draw_panels (canvas,
+                             canvas.height - panel_space (canvas.height),
+                             canvas.height - 4);
 
 
+    if (data.prices.empty ())
+      return;
+
+
+    Stage_Timer::Scope  stage  {timings.get (),  "price line"};
+
+    canvas.set_source_rgb (Colour::PRICE_AXIS);
+    canvas.move_to ({data.extremes.start_time, canvas.outline.max_value});
+    canvas.line_to ({data.extremes.start_time, canvas.outline.min_value});
+    canvas.cairo->stroke ();    
+
+    canvas.set_source_rgb (Colour::TIME_AXIS);
+    canvas.move_to ({data.extremes.start_time, canvas.outline.min_value});
+    canvas.line_to ({data.extremes.end_time, canvas.outline.min_value});
+    canvas.cairo->stroke ();
+
+    lock_guard<mutex> l {data.prices_mutex};
+
+    if (price_pyramid_version != data.prices_version
+               ||  ! price_pyramid.describes (data.prices))
+      {
+        price_pyramid = Series_Pyramid {data.prices};
+        price_pyramid_version = data.prices_version;
+      }
+
+    canvas.draw_time_series (data.prices, Colour::PRICE_GRAPH, 1.0,
+                             price_pyramid);
+  }
+
+
+
+  void Chart_Renderer::draw_overlay (Chart_Context &canvas)
+  {
+    /* This object is constructed as we draw the various aspects of the
+     * chart, and then it is rendered on top of everything else right at
+     * the end of this method. */
+    Tide_Mark::List tide_marks;
+
+    /* The stage of the drawing now being timed; emplacing the next stage
+     * records the time taken by the last. */
+    optional <Stage_Timer::Scope>  stage;
+
     if (data.prices.empty ())
       {
         if (features & Feature::COMPANY_NAME)
@@ -365,25 +503,32 @@ namespace DMBCS::Trader_Desk {
 
         canvas.render (canvas.text);
 
-        return 1;
+        return;
       }
 
+    stage.emplace (timings.get (),  "tide marks");
 
-    canvas.set_source_rgb (Colour::PRICE_AXIS);
-    canvas.move_to ({data.extremes.start_time, canvas.outline.max_value});
-    canvas.line_to ({data.extremes.start_time, canvas.outline.min_value});
-    canvas.cairo->stroke ();    
+    auto cursor_mark
+      = Tide_Mark::price_marker
+           (canvas.date (pointer_x),
+            canvas.outline.contains ({ canvas.date (pointer_x),
+                                       canvas.value (pointer_y)})
+              ?  Colour::CURSOR_TIDES
+              :  Colour::NO_DISPLAY);
 
-    canvas.set_source_rgb (Colour::TIME_AXIS);
-    canvas.move_to ({data.extremes.start_time, canvas.outline.min_value});
-    canvas.line_to ({data.extremes.end_time, canvas.outline.min_value});
-    canvas.cairo->stroke ();
+    auto current_mark = Tide_Mark::price_marker (canvas.outline.end_time,
+                                                 Colour::CHART_BACKGROUND);
+
+    if (analyzer)
+      {
+        analyzer->tide_mark_hook (canvas,  tide_marks,
+                                  {cursor_mark,  current_mark});
+        analyzer->overlay_draw_hook (canvas,  data.number_shares);
+      }
 
     {
       lock_guard<mutex> l {data.prices_mutex};
 
-      canvas.draw_time_series (data.prices, Colour::PRICE_GRAPH, 1.0);
-
       tide_marks.emplace_back (current_mark (data.prices.front ().price,
                                              Colour::PRICE_TIDES));
 
@@ -473,11 +618,69 @@ namespace DMBCS::Trader_Desk {
             }
       }
 
+    /*****  Analyzer panels.  *****/
+
+    stage.reset ();
+
+    if (analyzer  &&  analyzer->number_panels () > 0)
+      {
+        /* A time before the start of the chart indicates no cursor. */
+        auto const  cursor
+             {pointer_y >= 0
+                  &&  pointer_x >= canvas.left_border
+                  &&  pointer_x <= canvas.width - canvas.right_border
+                ?  canvas.date (pointer_x)
+                :  Time_Point {}};
+
+        analyzer->draw_panel_cursors (canvas,
+                                      canvas.height
+                                           - panel_space (canvas.height),
+                                      canvas.height - 4,
+                                      cursor);
+      }
+
+    stage.emplace (timings.get (),  "text layout");
     canvas.render (canvas.text);
+    stage.reset ();
+
+    if (show_timings)
+      draw_timings (canvas);
+
+  }  /* End of draw_overlay method. */
 
-    return 1;
 
-  }  /* End of on_draw method. */
+
+  void  Chart_Renderer::draw_timings  (Chart_Context &canvas)  const
+  {
+    ostringstream  out;
+    out << fixed << setprecision (2)
+        << "<tt>" << setw (24) << left << "stage (ms)" << right
+        << setw (7) << "last" << setw (7) << "mean" << setw (7) << "max";
+
+    for (auto const &s  :  timings->snapshot ())
+      out << '\n' << setw (24) << left << s.stage << right
+          << setw (7) << s.last << setw (7) << s.mean << setw (7) << s.max;
+
+    out << "</tt>";
+
+    canvas.pango->set_markup (out.str ());
+    auto const  extents  {canvas.pango->get_pixel_logical_extents ()};
+
+    auto const  x  {canvas.width - canvas.right_border
+                        - extents.get_width () - 8};
+    auto const  y  {canvas.top_border + 4.0};
+
+    canvas.set_source_rgb (Colour::CHART_BACKGROUND,  0.85);
+    canvas.cairo->rectangle (x - 4,  y - 4,
+                             extents.get_width () + 8,
+                             extents.get_height () + 8);
+    canvas.cairo->fill ();
+
+    canvas.cairo->move_to (x,  y);
+    canvas.pango->add_to_cairo_context (canvas.cairo);
+    canvas.set_source_rgb (Colour::COMPANY_NAME_TITLE);
+    canvas.cairo->fill ();
+  }
 
     
 }  /* End of namespace DMBCS::Trader_Desk. */
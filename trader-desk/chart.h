@@ -35,17 +35,20 @@
 namespace DMBCS::Trader_Desk {
 
 
-  /** This is a GTK widget which displays a chart complete with all its
-   *  trimmings.  Most of the bulk of the implementation deals with the
-   *  gooey details of actually rendering all the parts into the part of
-   *  the screen occupied by the widget, but there is also some code to
-   *  support a stack of analyzers, which will pass along mouse events to
-   *  them if appropriate. */
-
-
-  struct Chart : Gtk::DrawingArea
+  /** Everything about a chart except its being a widget: the data, the
+   *  stack of analyzers, and the rendering of a chart complete with all
+   *  its trimmings onto any Cairo surface.  Mouse movements and button
+   *  presses are passed in by whoever owns us, and we pass them along to
+   *  the analyzers if appropriate.
+   *
+   *  Nothing here needs a display, so that a chart can be drawn off-screen
+   *  (the render benchmark does this); the \c Chart widget below puts one
+   *  on the screen. */
+
+
+  struct Chart_Renderer
   {
-  private:
+  protected:
     /** Set of selectable ‘trimmings’ which may adorn the chart. */
     struct Feature
     {
@@ -101,40 +104,173 @@ namespace DMBCS::Trader_Desk {
     uint32_t const features;
 
     /** The last known coordinates of the mouse cursor, when it was over
-     *  our chart; used to convey mouse place into expose() method. */
-    int pointer_x, pointer_y;
+     *  our chart, or -1 if it is not; used to convey mouse place into
+     *  the \c render method. */
+    int pointer_x  {-1},  pointer_y  {-1};
+
+    /** Emitted when something we show has changed, and we need to be
+     *  rendered again. */
+    sigc::signal <void>  redraw_needed_;
+
+    /** Summary of \c data.prices for fast drawing, and the
+     *  \c Chart_Data::prices_version it was built from. */
+    Series_Pyramid  price_pyramid;
+    uint64_t  price_pyramid_version  {0};
+
+    /** The time taken by each stage of drawing the chart, and of the
+     *  analyzers' work. */
+    shared_ptr <Stage_Timer>  timings  {make_shared <Stage_Timer> ()};
+
+    /** Whether to lay a summary of the \c timings over the chart. */
+    bool  show_timings  {0};
+
+    /** Draw the summary of the \c timings in the top-right corner of the
+     *  \a canvas. */
+    void  draw_timings  (Chart_Context &canvas)  const;
+
+    /** Incremented whenever the analyzers signal that they have something
+     *  new to draw. */
+    uint64_t  analysis_version  {0};
+
+
+    /** An off-screen copy of some of the parts of the chart, together
+     *  with a note of everything those parts depend on. */
+    struct Layer
+    {
+      struct Key
+      {
+        int                 width,  height;
+        double              scale;
+        Time_Series::Range  outline;
+        unsigned            number_shares;
+        bool                unaccurate;
+        uint64_t            prices_version;
+        uint64_t            analysis_version;
+      };
+
+      Cairo::RefPtr <Cairo::ImageSurface>  surface;
+      Key  key;
+
+      /** Does the \c surface show the chart as described by \a k? */
+      bool  current  (Key const &k)  const;
+    };
+
+    /** The background and axes. */
+    Layer  static_layer;
+
+    /** The price line, the analyzers' drawings and their panels. */
+    Layer  data_layer;
+
+    /** The ticks along the time axis, and their labels laid out ready to
+     *  draw (one per tick). */
+    Date_Axis::Axis  time_axis;
+    vector <Glib::RefPtr <Pango::Layout>>  time_axis_labels;
+
+
+    /** Set up the \a canvas to draw the chart with the given \a width and
+     *  \a height onto \a cairo. */
+    void  lay_out  (Chart_Context &canvas,
+                    Cairo::RefPtr<Cairo::Context> const &cairo,
+                    int width,
+                    int height);
+
+    /** The height of the strip at the bottom of the chart which is given
+     *  over to analyzer panels, if the chart is \a height pixels high. */
+    double  panel_space  (int height)  const;
+
+    /** Unless it is already \c current, \a draw the \a layer afresh;
+     *  then paint it onto the \a target.  Charts without cross-hairs are
+     *  not redrawn often enough to be worth keeping layers for, and are
+     *  drawn directly onto the \a target. */
+    template <typename Draw>
+    void  paint_layer  (Layer &layer,
+                        Layer::Key const &key,
+                        Cairo::RefPtr<Cairo::Context> const &target,
+                        Draw  draw);
+
+    /** The three parts of the drawing: the background and axes, the data
+     *  and analyses, and the parts which follow the mouse. */
+    void  draw_static_layer  (Chart_Context &);
+    void  draw_data_layer  (Chart_Context &);
+    void  draw_overlay  (Chart_Context &);
+
   public:
 
     /** Sole constructor which partially initializes an object (note in
      *  particular that no company is specified here). */
-    Chart (uint32_t const features_,  Preferences&);
+    Chart_Renderer (uint32_t const features_,  Preferences&);
 
-    /** A \c Chart is a very heavy object and we do not want to be copying
+    /** A chart is a very heavy object and we do not want to be copying
      *  or even moving these around. */
-    Chart (Chart const &)          = delete;
-    Chart (Chart&&)                = delete;
-    void operator= (Chart const &) = delete;
-    void operator= (Chart &&)      = delete;
+    Chart_Renderer (Chart_Renderer const &)          = delete;
+    Chart_Renderer (Chart_Renderer&&)                = delete;
+    void operator= (Chart_Renderer const &)          = delete;
+    void operator= (Chart_Renderer &&)               = delete;
+
+    /** The rolling statistics of the time taken by each stage of our
+     *  drawing, and by the analyzers. */
+    Stage_Timer const  &stage_timings ()  const   { return *timings; }
+
+    /** Turn the display of the \c stage_timings over the chart on or
+     *  off. */
+    void  set_show_timings  (bool const s)
+    {  show_timings = s;  redraw_needed_.emit ();  }
+
+    /** Draw the whole chart, with the given \a width and \a height, onto
+     *  \a cairo. */
+    void  render  (Cairo::RefPtr<Cairo::Context> const &cairo,
+                   int width,
+                   int height);
+
+    /** If cross-hairs are live, move them to follow the mouse to (\a x,
+     *  \a y), and pass the movement on to the analyzers. */
+    void  pointer_moved  (double x,  double y);
+
+    /** The mouse has left the chart: take the cross-hairs away. */
+    void  pointer_left  ();
+
+    /** If cross-hairs are live, pass a mouse button press at (\a x, \a
+     *  y) to the analyzers; returns whether any of them took it. */
+    bool  button_down  (double x,  double y);
+
+    /** If cross-hairs are live, pass a mouse button release at (\a x,
+     *  \a y) to the analyzers; returns whether any of them took it. */
+    bool  button_up  (double x,  double y);
+
+    /** Connect to this to be told when we need to be rendered again. */
+    sigc::signal <void>  &signal_redraw_needed ()   { return redraw_needed_; }
+
+  };  /* End of class Chart_Renderer. */
+
+
+
+  /** This is a GTK widget which displays a chart complete with all its
+   *  trimmings.  All the real work is done by the \c Chart_Renderer we
+   *  are; we simply give it the part of the screen occupied by the widget
+   *  to draw in, and pass the mouse events on to it. */
+
+  struct Chart : Gtk::DrawingArea,  Chart_Renderer
+  {
+    /** Sole constructor which partially initializes an object (note in
+     *  particular that no company is specified here). */
+    Chart (uint32_t const features_,  Preferences&);
 
   private:
     /** Run all of the analyzers, and then render them, the chart, and all
      *  of its selected trimmings. */
     bool on_draw                (const Cairo::RefPtr<Cairo::Context>&) override;
     
-    /** If cross-hairs are live, send the button event to the analyzer
-     *  stack. */
+    /** Pass the button event to the renderer. */
     bool on_button_press_event   (GdkEventButton *const) override;
 
-    /** If cross-hairs are live, send the button event to the analyzer
-     *  stack. */
+    /** Pass the button event to the renderer. */
     bool on_button_release_event (GdkEventButton *const) override;
 
-    /** If cross-hairs are live, update all of them and get the chart
-     *  re-drawn.  Finally pass the motion event to the analyzers. */
+    /** Pass the motion event to the renderer, which will have us re-drawn
+     *  if the cross-hairs are live. */
     bool on_motion_notify_event  (GdkEventMotion *const motion) override;
 
-    /** If cross-hairs are live, remove them by re-drawing the chart
-     *  without. */
+    /** Remove any cross-hairs by re-drawing the chart without. */
     bool on_leave_notify_event   (GdkEventCrossing *const) override;
 
 
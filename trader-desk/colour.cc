@@ -42,6 +42,13 @@ namespace DMBCS::Trader_Desk {
   const Colour  Colour::POSITIVE_DELTA     {0.5, 1.0, 0.5};
   const Colour  Colour::NEGATIVE_DELTA     {1.0, 0.5, 0.5};
   const Colour  Colour::DELTA_VALUE        {0.0, 0.0, 0.0};
+  const Colour  Colour::FAST_EMA           {0.0, 0.6, 0.8};
+  const Colour  Colour::SLOW_EMA           {0.6, 0.0, 0.8};
+  const Colour  Colour::MACD_LINE          {0.0, 0.4, 0.8};
+  const Colour  Colour::MACD_SIGNAL        {0.9, 0.5, 0.0};
+  const Colour  Colour::RSI_LINE           {0.5, 0.0, 0.5};
+  const Colour  Colour::STOCHASTIC_K       {0.0, 0.4, 0.8};
+  const Colour  Colour::STOCHASTIC_D       {0.9, 0.5, 0.0};
 
   const Colour  Colour::NO_DISPLAY         {-1.0, -1.0, -1.0};
 
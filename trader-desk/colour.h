@@ -67,6 +67,13 @@ namespace DMBCS::Trader_Desk {
     static const Colour  POSITIVE_DELTA;
     static const Colour  NEGATIVE_DELTA;
     static const Colour  DELTA_VALUE;
+    static const Colour  FAST_EMA;
+    static const Colour  SLOW_EMA;
+    static const Colour  MACD_LINE;
+    static const Colour  MACD_SIGNAL;
+    static const Colour  RSI_LINE;
+    static const Colour  STOCHASTIC_K;
+    static const Colour  STOCHASTIC_D;
 
     /** Extra-special value which indicates that this feature should not
      *  be drawn at all. */
@@ -60,7 +60,7 @@ namespace DMBCS::Trader_Desk {
                        .connect ([this] { next_company_required (); });
 
     chart_data . changed_signal
-               . connect ([this]
+               . connect ([this] (Chart_Data::Change const &)
                           { if (chart_data.company_name != entry.get_text ())
                               entry.set_text (chart_data.company_name); });
 
@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <trader-desk/correlation.h>
+#include <trader-desk/markets.h>
+#include <cmath>
+
+
+/** \file
+ *
+ *  Implementation of the \c Aligned_Returns and \c Correlation_Matrix
+ *  classes, and the \c correlate_market function. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  Aligned_Returns::Aligned_Returns  (Market_History const &history)
+  {
+    for (auto const &c  :  history)
+      for (auto const &e  :  c.prices)
+        dates.push_back (e.time);
+
+    sort (begin (dates),  end (dates));
+    dates.erase (unique (begin (dates),  end (dates)),  end (dates));
+
+    /* The first date only starts the first return. */
+    if (! dates.empty ())    dates.erase (begin (dates));
+
+    auto const  T  {dates.size ()};
+    stride = (T + 7) / 8 * 8;
+
+    vector <double>  r (stride);
+
+    for (auto const &c  :  history)
+      {
+        if (c.prices.size () < 2)    continue;
+
+        fill (begin (r),  end (r),  0.0);
+
+        /* Walk the company's prices oldest first, alongside the dates. */
+        auto  e  {c.prices.rbegin ()};
+        auto  last  {e->price};
+        double  sum  {0.0};
+
+        for (size_t t = 0;  t < T;  ++t)
+          {
+            auto  p  {last};
+            for (;  e != c.prices.rend ()  &&  e->time <= dates [t];  ++e)
+              p = e->price;
+
+            if (p > 0.0  &&  last > 0.0)    sum += r [t] = log (p / last);
+            last = p;
+          }
+
+        auto const  mean  {sum / T};
+        double  ss  {0.0};
+        for (size_t t = 0;  t < T;  ++t)
+          {
+            r [t] -= mean;
+            ss += r [t] * r [t];
+          }
+
+        if (ss <= 0.0)    continue;
+
+        auto const  norm  {sqrt (ss)};
+        for (size_t t = 0;  t < T;  ++t)    r [t] /= norm;
+
+        seqid.push_back (c.seqid);
+        name.push_back (c.name);
+        standard_deviation.push_back (T > 1  ?  sqrt (ss / (T - 1))  :  0.0);
+        values.insert (end (values),  begin (r),  end (r));
+      }
+  }
+
+
+
+  /* The dot products of each of the four rows starting at \a a with
+   * each of the four starting at \a b, over the columns [k0, k1), added
+   * into \a c.  Holding the sixteen sums in registers means that each
+   * value loaded is used four times; the loop body is free of
+   * dependencies between columns so that the compiler may vectorize it. */
+  static void  tile_4x4  (double const *const a,
+                          double const *const b,
+                          size_t const stride,
+                          size_t const k0,
+                          size_t const k1,
+                          double  c [4][4])
+  {
+    double  s00 {0}, s01 {0}, s02 {0}, s03 {0},
+            s10 {0}, s11 {0}, s12 {0}, s13 {0},
+            s20 {0}, s21 {0}, s22 {0}, s23 {0},
+            s30 {0}, s31 {0}, s32 {0}, s33 {0};
+
+    auto const *const  a0  {a};
+    auto const *const  a1  {a + stride};
+    auto const *const  a2  {a + 2 * stride};
+    auto const *const  a3  {a + 3 * stride};
+    auto const *const  b0  {b};
+    auto const *const  b1  {b + stride};
+    auto const *const  b2  {b + 2 * stride};
+    auto const *const  b3  {b + 3 * stride};
+
+    for (auto k = k0;  k < k1;  ++k)
+      {
+        s00 += a0 [k] * b0 [k];   s01 += a0 [k] * b1 [k];
+        s02 += a0 [k] * b2 [k];   s03 += a0 [k] * b3 [k];
+        s10 += a1 [k] * b0 [k];   s11 += a1 [k] * b1 [k];
+        s12 += a1 [k] * b2 [k];   s13 += a1 [k] * b3 [k];
+        s20 += a2 [k] * b0 [k];   s21 += a2 [k] * b1 [k];
+        s22 += a2 [k] * b2 [k];   s23 += a2 [k] * b3 [k];
+        s30 += a3 [k] * b0 [k];   s31 += a3 [k] * b1 [k];
+        s32 += a3 [k] * b2 [k];   s33 += a3 [k] * b3 [k];
+      }
+
+    c[0][0] += s00;  c[0][1] += s01;  c[0][2] += s02;  c[0][3] += s03;
+    c[1][0] += s10;  c[1][1] += s11;  c[1][2] += s12;  c[1][3] += s13;
+    c[2][0] += s20;  c[2][1] += s21;  c[2][2] += s22;  c[2][3] += s23;
+    c[3][0] += s30;  c[3][1] += s31;  c[3][2] += s32;  c[3][3] += s33;
+  }
+
+
+
+  Correlation_Matrix::Correlation_Matrix  (Aligned_Returns const &returns,
+                                           Worker_Pool &pool)
+    :  seqid {returns.seqid},
+       name {returns.name},
+       standard_deviation {returns.standard_deviation},
+       number_returns {returns.dates.size ()}
+  {
+    auto const  n  {size ()};
+    auto const  stride  {returns.stride};
+
+    correlation_.assign (n * n,  0.0);
+
+    if (n == 0)    return;
+
+    /* Pad the rows out to a multiple of four with zeros, so that every
+     * tile is full. */
+    auto const  N  {(n + 3) / 4 * 4};
+    vector <double>  padded  (returns.values);
+    padded.resize (N * stride,  0.0);
+
+    vector <double>  C  (N * N,  0.0);
+
+    /* The work is divided into square blocks of BLOCK rows by BLOCK
+     * columns of the (upper triangle of the) result, and the returns are
+     * taken DEPTH at a time, so that the rows of the two blocks being
+     * combined stay in the cache while all the tiles between them are
+     * computed. */
+    constexpr size_t  BLOCK  {64};
+    constexpr size_t  DEPTH  {256};
+
+    auto const  number_blocks  {(N + BLOCK - 1) / BLOCK};
+
+    pool.parallel_for
+      (number_blocks,
+       [&] (size_t const  first,  size_t const  last)
+       {
+         for (auto I = first;  I < last;  ++I)
+           for (auto J = I;  J < number_blocks;  ++J)
+             for (size_t k0 = 0;  k0 < stride;  k0 += DEPTH)
+               {
+                 auto const  k1  {min (stride,  k0 + DEPTH)};
+
+                 auto const  i_end  {min (N,  (I + 1) * BLOCK)};
+                 auto const  j_end  {min (N,  (J + 1) * BLOCK)};
+
+                 for (auto i = I * BLOCK;  i < i_end;  i += 4)
+                   for (auto j = max (i,  J * BLOCK);  j < j_end;  j += 4)
+                     {
+                       double  c [4][4]  {};
+                       tile_4x4 (padded.data () + i * stride,
+                                 padded.data () + j * stride,
+                                 stride,  k0,  k1,  c);
+                       for (size_t r = 0;  r < 4;  ++r)
+                         for (size_t s = 0;  s < 4;  ++s)
+                           C [(i + r) * N + j + s] += c [r][s];
+                     }
+               }
+       });
+
+    /* Only the upper triangle (and the tiles straddling the diagonal) has
+     * been computed; mirror it into the full matrix. */
+    for (size_t i = 0;  i < n;  ++i)
+      for (auto j = i;  j < n;  ++j)
+        correlation_ [i * n + j]  =  correlation_ [j * n + i]
+                                  =  max (-1.0,  min (1.0,  C [i * N + j]));
+  }
+
+
+
+  auto  Correlation_Matrix::strongest  (size_t const count)  const
+    ->  vector <Pair>
+  {
+    vector <Pair>  ret;
+    ret.reserve (size () * (size () - 1) / 2);
+
+    for (size_t i = 0;  i < size ();  ++i)
+      for (auto j = i + 1;  j < size ();  ++j)
+        ret.push_back ({i,  j,  correlation (i, j)});
+
+    auto const  m  {min (count,  ret.size ())};
+    partial_sort (begin (ret),  begin (ret) + m,  end (ret),
+                  [] (Pair const &x,  Pair const &y)
+                  {  return x.correlation > y.correlation;  });
+    ret.resize (m);
+
+    return ret;
+  }
+
+
+
+  shared_ptr <Correlation_Matrix const>  correlate_market
+                                          (DB &db,
+                                           Market_Meta_Data const &market,
+                                           Duration const &history,
+                                           uint64_t const data_version,
+                                           Analysis_Cache &cache)
+  {
+    /* The period is taken in whole days, so that the key does not change
+     * from one moment to the next. */
+    Time_Point const  end_time
+          {chrono::floor <chrono::duration <int, ratio <24 * 3600>>>
+                (chrono::system_clock::now ())
+             +  chrono::hours {24}};
+
+    Analysis_Cache::Key const  key  {"correlation",
+                                     data_version,
+                                     end_time - history,
+                                     end_time,
+                                     {double (market.seqid)}};
+
+    if (auto  c  {cache.find <Correlation_Matrix> (key)})    return c;
+
+    auto  ret  {make_shared <Correlation_Matrix const>
+                    (Aligned_Returns {Market_History::from_database
+                                          (db,  market,  end_time,  history)})};
+
+    cache.insert (key,  ret);
+
+    return ret;
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
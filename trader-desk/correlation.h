@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#ifndef DMBCS__TRADER_DESK__CORRELATION__H
+#define DMBCS__TRADER_DESK__CORRELATION__H
+
+
+#include <trader-desk/analysis-cache.h>
+#include <trader-desk/market-history.h>
+#include <trader-desk/worker-pool.h>
+
+
+/** \file
+ *
+ *  Declaration of the \c Aligned_Returns and \c Correlation_Matrix
+ *  classes, and of the \c correlate_market function, which together
+ *  tell which companies in a market move together.  None of this
+ *  requires any graphics. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  /** The daily returns of all the companies in a market, aligned on a
+   *  common set of trading dates: the union of the dates on which any of
+   *  the companies has a closing price.  A company which has no price on
+   *  one of those dates is taken to have not moved since its previous
+   *  price (and before its first price in the period, to have not moved
+   *  at all).
+   *
+   *  The returns are logarithmic, and are stored with their mean removed
+   *  and scaled to unit length, one company per row, so that the
+   *  correlation of two companies is just the dot product of their rows.
+   *  Companies without at least two prices, or whose price never moves,
+   *  are left out. */
+
+  struct Aligned_Returns
+  {
+    vector <int>     seqid;
+    vector <string>  name;
+
+    /** The dates at the ends of the periods of the returns, oldest
+     *  first. */
+    vector <Time_Point>  dates;
+
+    /** The length of each row in \c values: \c dates.size () rounded up
+     *  so that every row starts on a cache-line boundary; the padding is
+     *  all zeros. */
+    size_t  stride  {0};
+
+    /** The normalized returns, \c seqid.size () rows of \c stride. */
+    vector <double>  values;
+
+    /** The standard deviation of each company's daily returns. */
+    vector <double>  standard_deviation;
+
+    explicit Aligned_Returns (Market_History const &);
+
+    /** The start of the row of the \a i'th company. */
+    double const  *row  (size_t const i)  const
+    {  return  values.data () + i * stride;  }
+  };
+
+
+
+  /** The correlations between the daily returns of every pair of
+   *  companies in a market. */
+
+  class Correlation_Matrix
+  {
+  public:
+
+    vector <int>     seqid;
+    vector <string>  name;
+
+    /** The standard deviation of each company's daily returns. */
+    vector <double>  standard_deviation;
+
+    /** The number of returns the correlations are computed over. */
+    size_t  number_returns  {0};
+
+  private:
+
+    /** The full, symmetric, matrix, row by row. */
+    vector <double>  correlation_;
+
+  public:
+
+    /** Compute the matrix from the \a returns, sharing the work out over
+     *  the \a pool.  The time taken is proportional to the square of the
+     *  number of companies times the number of returns. */
+    explicit Correlation_Matrix (Aligned_Returns const &returns,
+                                 Worker_Pool &pool = Worker_Pool::shared ());
+
+    /** The number of companies. */
+    size_t  size  ()  const   {  return seqid.size ();  }
+
+    double  correlation  (size_t const i,  size_t const j)  const
+    {  return  correlation_ [i * size () + j];  }
+
+    /** The covariance of the daily returns of the \a i'th and \a j'th
+     *  companies. */
+    double  covariance  (size_t const i,  size_t const j)  const
+    {  return  correlation (i, j)
+                  *  standard_deviation [i]  *  standard_deviation [j];  }
+
+    /** A pair of distinct companies, by index. */
+    struct Pair  {  size_t  a,  b;  double  correlation;  };
+
+    /** The \a count pairs with the highest correlations, highest
+     *  first. */
+    vector <Pair>  strongest  (size_t const count)  const;
+
+  };  /* End of class Correlation_Matrix. */
+
+
+
+  /** The correlations over the last \a history of the companies in the
+   *  \a market.  The result is taken from the \a cache if one has been
+   *  computed for the same market, period and \a data_version (which the
+   *  caller must change whenever the prices in the database do);
+   *  otherwise it is computed and left in the \a cache. */
+  shared_ptr <Correlation_Matrix const>  correlate_market
+                                          (DB&,
+                                           Market_Meta_Data const &market,
+                                           Duration const &history,
+                                           uint64_t const data_version,
+                                           Analysis_Cache &cache);
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+#endif  /* Undefined DMBCS__TRADER_DESK__CORRELATION__H. */
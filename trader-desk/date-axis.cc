@@ -19,6 +19,8 @@
 
 
 #include <trader-desk/date-axis.h>
+#include <clocale>
+#include <mutex>
 
 
 namespace DMBCS::Trader_Desk { namespace Date_Axis {
@@ -76,6 +78,298 @@ namespace DMBCS::Trader_Desk { namespace Date_Axis {
   Duration round_hour   (Duration t) { return round_count (t, 2); }
   Duration round_minute (Duration t) { return round_count (t, 1); }
   Duration round_second (Duration t) { return t; }
+
+
+
+  /* Whole days and the remaining seconds, rounding towards the past. */
+  inline int64_t  days_of  (int64_t const seconds)
+  {
+    return  (seconds >= 0  ?  seconds  :  seconds - 86399)  /  86400;
+  }
+
+
+  /* The number of days since 1970-01-01 of the given date in the
+   * proleptic Gregorian calendar, and the reverse; these are Howard
+   * Hinnantʼs algorithms, which work in whole 400-year eras. */
+
+  static constexpr int64_t  days_from_civil  (int64_t y,
+                                              unsigned const m,
+                                              unsigned const d)
+  {
+    y -= m <= 2;
+    int64_t const  era  {(y >= 0  ?  y  :  y - 399)  /  400};
+    unsigned const  yoe  (y - era * 400);
+    unsigned const  doy  {(153 * (m > 2  ?  m - 3  :  m + 9) + 2) / 5
+                             + d - 1};
+    unsigned const  doe  {yoe * 365  +  yoe / 4  -  yoe / 100  +  doy};
+    return  era * 146097  +  int64_t (doe)  -  719468;
+  }
+
+
+  static constexpr void  civil_from_days  (int64_t z,  Civil &c)
+  {
+    c.weekday  =  unsigned (z >= -4  ?  (z + 4) % 7  :  (z + 5) % 7 + 6);
+
+    z += 719468;
+    int64_t const  era  {(z >= 0  ?  z  :  z - 146096)  /  146097};
+    unsigned const  doe  (z - era * 146097);
+    unsigned const  yoe  {(doe - doe / 1460 + doe / 36524 - doe / 146096)
+                             / 365};
+    unsigned const  doy  {doe  -  (365 * yoe  +  yoe / 4  -  yoe / 100)};
+    unsigned const  mp   {(5 * doy + 2) / 153};
+
+    c.day    =  doy  -  (153 * mp + 2) / 5  +  1;
+    c.month  =  mp < 10  ?  mp + 3  :  mp - 9;
+    c.year   =  int (yoe  +  era * 400  +  (c.month <= 2));
+  }
+
+
+  static_assert (days_from_civil (1970, 1, 1) == 0);
+  static_assert (days_from_civil (2000, 3, 1) == 11017);
+
+
+
+  static chrono::seconds  utc_offset  (Time_Point const &t)
+  {
+    time_t const  t_  {chrono::system_clock::to_time_t (t)};
+    tm  local;
+    localtime_r (&t_, &local);
+    return chrono::seconds (local.tm_gmtoff);
+  }
+
+
+
+  optional <Fixed_Offset>  Fixed_Offset::over  (Time_Point const start,
+                                                Time_Point const end)
+  {
+    /* Changes of offset can come only weeks apart (Morocco leaves and
+     * returns to its usual offset for Ramadan), so agreement at the ends
+     * of a span proves nothing.  But no zone changes twice within a day,
+     * so if the offset is the same at every day through the span, and at
+     * its end, it is the same throughout.  Longer spans are not worth
+     * the checking, as they have few ticks anyway. */
+    if (end - start  >  chrono::hours {24 * 60})    return {};
+
+    auto const  offset  {utc_offset (start)};
+
+    for (auto t = start + chrono::hours {24};  t < end;
+         t += chrono::hours {24})
+      if (utc_offset (t) != offset)    return {};
+
+    if (utc_offset (end) != offset)    return {};
+
+    return Fixed_Offset {offset};
+  }
+
+
+
+  Civil  Fixed_Offset::civil  (Time_Point const t)  const
+  {
+    auto const  s  {unix (t.time_since_epoch ()) + offset.count ()};
+    auto const  d  {days_of (s)};
+    auto const  r  {unsigned (s - d * 86400)};
+
+    Civil  ret;
+    civil_from_days (d, ret);
+    ret.hour    =  r / 3600;
+    ret.minute  =  r / 60 % 60;
+    ret.second  =  r % 60;
+    return ret;
+  }
+
+
+
+  Time_Point  Fixed_Offset::round_down  (Unit const unit,
+                                         Time_Point const t)  const
+  {
+    auto const  s  {unix (t.time_since_epoch ()) + offset.count ()};
+    auto const  d  {days_of (s)};
+    auto const  r  {s - d * 86400};
+
+    int64_t  local;
+
+    switch (unit)
+      {
+      case Unit::SECOND:  return t;
+      case Unit::MINUTE:  local = s - r % 60;    break;
+      case Unit::HOUR:    local = s - r % 3600;  break;
+      case Unit::DAY:     local = d * 86400;     break;
+
+      case Unit::WEEK:
+        {
+          /* Go back to the previous Monday. */
+          Civil  c;
+          civil_from_days (d, c);
+          local = (d - (c.weekday == 0  ?  6  :  c.weekday - 1)) * 86400;
+          break;
+        }
+
+      case Unit::MONTH:
+      case Unit::YEAR:
+        {
+          Civil  c;
+          civil_from_days (d, c);
+          local = days_from_civil (c.year,
+                                   unit == Unit::YEAR  ?  1  :  c.month,
+                                   1)
+                    * 86400;
+          break;
+        }
+      }
+
+    return chrono::system_clock::from_time_t (local - offset.count ());
+  }
+
+
+
+  /* The same as Fixed_Offset::civil, but going through the C library so
+   * that it is right at all times. */
+  static Civil  local_civil  (Time_Point const &t)
+  {
+    time_t const  t_  {chrono::system_clock::to_time_t (t)};
+    tm  x;
+    localtime_r (&t_, &x);
+    return {x.tm_year + 1900,  unsigned (x.tm_mon + 1),  unsigned (x.tm_mday),
+            unsigned (x.tm_wday),
+            unsigned (x.tm_hour),  unsigned (x.tm_min),  unsigned (x.tm_sec)};
+  }
+
+
+
+  /* The abbreviated name of the \a month (1 to 12) in the current
+   * locale.  The names are got from the C library only when the locale
+   * changes. */
+  static string  month_name  (unsigned const month)
+  {
+    static mutex   names_mutex;
+    static string  names_locale  {"\n"};
+    static string  names [12];
+
+    char const *const  l  {setlocale (LC_TIME, nullptr)};
+
+    lock_guard  lock  {names_mutex};
+
+    if (names_locale != (l ? l : ""))
+      {
+        names_locale = l ? l : "";
+
+        for (int m = 0;  m < 12;  ++m)
+          {
+            tm  x  {};
+            x.tm_mon = m;
+            char  buffer [100];
+            strftime (buffer, sizeof (buffer), "%b", &x);
+            names [m] = buffer;
+          }
+      }
+
+    return names [(month - 1) % 12];
+  }
+
+
+
+  string  format  (char const *f,  Civil const &c)
+  {
+    string  ret;
+
+    auto const  two_digits  {[&ret] (unsigned const n)
+                             {
+                               ret += char ('0' + n / 10 % 10);
+                               ret += char ('0' + n % 10);
+                             }};
+
+    for (;  *f;  ++f)
+      {
+        if (*f != '%'  ||  ! f [1])    {  ret += *f;  continue;  }
+
+        switch (*++f)
+          {
+          case 'Y':  ret += to_string (c.year);      break;
+          case 'b':  ret += month_name (c.month);    break;
+          case 'd':  two_digits (c.day);             break;
+          case 'H':  two_digits (c.hour);            break;
+          case 'M':  two_digits (c.minute);          break;
+          case 'S':  two_digits (c.second);          break;
+          default:   ret += '%';  ret += *f;         break;
+          }
+      }
+
+    return ret;
+  }
+
+
+
+  bool  Axis::update  (Time_Point const &start_,
+                       Time_Point const &end_,
+                       int const pixels_,
+                       function <double (string const &)> const &label_width)
+  {
+    char const *const  l  {setlocale (LC_TIME, nullptr)};
+
+    if (start_ == start  &&  end_ == end  &&  pixels_ == pixels
+            &&  locale == (l ? l : ""))
+      return 0;
+
+    start   =  start_;
+    end     =  end_;
+    pixels  =  pixels_;
+    locale  =  l ? l : "";
+
+    ticks.clear ();
+
+    auto const  span  {double ((end - start).count ())};
+
+    if (span <= 0.0)    return 1;
+
+    /* Most spans are short enough to need no C library calls per
+     * tick. */
+    auto const  civil  {[] (optional <Fixed_Offset> const &f,
+                            Time_Point const &t)
+                        {  return  f  ?  f->civil (t)  :  local_civil (t);  }};
+
+    auto const *disc  {discretization};
+
+    {
+      auto const  fixed  {Fixed_Offset::over (end, end)};
+
+      for (; disc->format; ++disc)
+        {
+          auto const  spacing  {disc->real_interval.count () / span * pixels};
+
+          /* If the spacing between ticks is less than one pixel, move
+           * on. */
+          if (spacing < 1.0)    continue;
+
+          /* If the spacing between ticks is more than the space required
+           * to display the latest date-time, then this is the tick
+           * spacing we will use. */
+          if (spacing  >  label_width (format (disc->format,
+                                               civil (fixed, end))) + 4)
+            break;
+        }
+    }
+
+    /* The chosen spacing, and the next two coarser ones on lines below
+     * it. */
+    for (unsigned line = 0;  line < 3  &&  disc->format;  ++line, ++disc)
+      {
+        /* The ticks are found by rounding down times from one interval
+         * before the start onwards. */
+        auto const  fixed  {Fixed_Offset::over (start - disc->interval, end)};
+
+        for (auto i = start;  i <= end;  i += disc->interval)
+          {
+            i = fixed  ?  fixed->round_down (disc->unit, i)
+                       :  disc->round_down (i);
+
+            if (i > start)
+              ticks.push_back ({i,  format (disc->format, civil (fixed, i)),
+                                line});
+          }
+      }
+
+    return 1;
+  }
     
  
 } }  /* End of namespace DMBCS::Trader_Desk::Date_Axis. */
@@ -24,6 +24,8 @@
 
 #include <gtkmm.h>
 #include <trader-desk/time-series.h>
+#include <functional>
+#include <optional>
 
 
 namespace DMBCS::Trader_Desk {
@@ -31,8 +33,9 @@ namespace DMBCS::Trader_Desk {
 
   /** Really part of the implementation of \c Chart to help with drawing
    *  the date axis along the bottom edge.  The class provides information
-   *  about the possible spacings between tick marks, and methods which
-   *  round any date down to the nearest tick. */
+   *  about the possible spacings between tick marks, methods which round
+   *  any date down to the nearest tick, and the \c Axis which works out
+   *  (and remembers) all the ticks and their labels for a span of time. */
 
   namespace Date_Axis
   {
@@ -45,6 +48,10 @@ namespace DMBCS::Trader_Desk {
      *  interval, and then we use the system's calendar functions to \c
      *  round_down to the last appropriate real date. */
 
+    /** The calendar unit to which a \c Discretization rounds. */
+    enum class Unit  {  SECOND,  MINUTE,  HOUR,  DAY,  WEEK,  MONTH,  YEAR  };
+
+
     struct Discretization 
     {
       /** Slightly bigger than the largest real interval between ticks
@@ -64,6 +71,9 @@ namespace DMBCS::Trader_Desk {
        *  tick. */
       Duration (*round_down_) (Duration);
 
+      /** The unit which \c round_down_ rounds to. */
+      Unit unit;
+
       /** Convenience wrapper around above function. */
       Duration round_down (Duration const &d)  { return (*round_down_) (d); }
 
@@ -99,29 +109,104 @@ namespace DMBCS::Trader_Desk {
     static constexpr const Discretization discretization []
              = { { C::seconds (1), 
                    C::seconds (1),
-                   "%H:%M:%S", &round_second },
+                   "%H:%M:%S", &round_second, Unit::SECOND },
                  { C::seconds (70), 
                    C::seconds (60),
-                   "%H:%M", &round_minute },
+                   "%H:%M", &round_minute, Unit::MINUTE },
                  { C::seconds (6 * 60),
                    C::seconds (5 * 60),
-                   "%H:%M", &round_minute },
+                   "%H:%M", &round_minute, Unit::MINUTE },
                  { C::seconds (70 * 60),
                    C::seconds (60 * 60),
-                   "%H:00", &round_hour },
+                   "%H:00", &round_hour, Unit::HOUR },
                  { C::seconds (25 * 60 * 60),
                    C::seconds (24 * 60 * 60),
-                   "%d", &round_day },
+                   "%d", &round_day, Unit::DAY },
                  { C::seconds (8 * 24 * 60 * 60),
                    C::seconds (7 * 24 * 60 * 60),
-                   "%d", &round_week },
+                   "%d", &round_week, Unit::WEEK },
                  { C::seconds (35 * 24 * 60 * 60),
                    C::seconds (31 * 24 * 60 * 60),
-                   "%b", &round_month },
+                   "%b", &round_month, Unit::MONTH },
                  { C::seconds (380 * 24 * 60 * 60),
                    C::seconds (365 * 24 * 60 * 60),
-                   "%Y", &round_year },
-                 { C::seconds (0), C::seconds (0), nullptr, nullptr } };
+                   "%Y", &round_year, Unit::YEAR },
+                 { C::seconds (0), C::seconds (0), nullptr, nullptr,
+                   Unit::SECOND } };
+
+
+
+    /** A local date and time of day. */
+    struct Civil
+    {
+      int       year;
+      unsigned  month;     /* 1 to 12. */
+      unsigned  day;       /* 1 to 31. */
+      unsigned  weekday;   /* 0 (Sunday) to 6. */
+      unsigned  hour,  minute,  second;
+    };
+
+
+    /** Conversion between times and local \c Civil dates and times by
+     *  calendar arithmetic alone, given the offset of local time from
+     *  UTC.  This only holds while the offset does not change, i.e. not
+     *  across a change to or from daylight-saving time, but it saves
+     *  going through the C library for every tick. */
+    struct Fixed_Offset
+    {
+      chrono::seconds  offset;
+
+      /** A \c Fixed_Offset which is good for all times between \a start
+       *  and \a end, if we can be sure there is one. */
+      static optional <Fixed_Offset>  over  (Time_Point start,
+                                             Time_Point end);
+
+      Civil  civil  (Time_Point)  const;
+
+      /** Round \a t down to the start of the \a unit it is in. */
+      Time_Point  round_down  (Unit,  Time_Point t)  const;
+    };
+
+
+    /** Write \a c according to the \c strftime \a format, of which only
+     *  the conversions used in the \c discretization are understood.  The
+     *  month names are those of the current locale. */
+    string  format  (char const *format,  Civil const &c);
+
+
+
+    /** A tick on the time axis, with its label, which belongs on one of
+     *  three lines below the axis, line zero showing the finest
+     *  divisions. */
+    struct Tick
+    {
+      Time_Point  time;
+      string      label;
+      unsigned    line;
+    };
+
+
+    /** The ticks along an axis, together with what they were worked out
+     *  for, so that they need only be worked out again when that
+     *  changes. */
+    struct Axis
+    {
+      Time_Point  start,  end;
+      int         pixels  {-1};
+      string      locale;
+
+      vector <Tick>  ticks;
+
+      /** Make sure the \c ticks are those for an axis spanning \a start_
+       *  to \a end_ over \a pixels_, in the current locale.  The finest
+       *  divisions are the smallest for which the labels, whose widths in
+       *  pixels \a label_width gives, will fit between the ticks.  Returns
+       *  TRUE if the ticks had to be worked out afresh. */
+      bool  update  (Time_Point const &start_,
+                     Time_Point const &end_,
+                     int pixels_,
+                     function <double (string const &)> const &label_width);
+    };
 
 
   }  /* End of namespace Date_Axis. */
@@ -33,8 +33,6 @@ Date_Range_Scale::Date_Range_Scale (Chart_Data &d,  Preferences&  P)
                          50 /* Initial setting. */),
       db  {P}
   {
-      d . changed_signal . connect ([this] { on_data_changed (); });
-
       value_adjustment -> signal_value_changed ()
                         . connect ([this] { on_value_changed (); });
   }
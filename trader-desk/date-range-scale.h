@@ -22,6 +22,7 @@
 #define DMBCS__TRADER_DESK__DATE_RANGE_SCALE__H
 
 
+#include <trader-desk/db.h>
 #include <trader-desk/scale.h>
 
 
@@ -32,11 +32,8 @@ namespace DMBCS::Trader_Desk {
 
 
 
-  void Delta_Analyzer::graph_draw_hook
-                              (Chart_Context &canvas,
-                               Tide_Mark::List &,
-                               unsigned number_shares,
-                               vector <Tide_Mark::Price_Marker> const &)
+  void Delta_Analyzer::overlay_draw_hook  (Chart_Context &canvas,
+                                           unsigned number_shares)
   {
     if (end_place.x != start_place.x  ||  end_place.y != start_place.y)
       {
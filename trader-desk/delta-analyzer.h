@@ -65,13 +65,19 @@ namespace DMBCS::Trader_Desk {
     explicit Delta_Analyzer (Chart_Data &chart_data);
 
 
+    string name () const  override   { return "delta"; }
+
+
+    /** The region follows the mouse, so we draw nothing which the chart
+     *  keeps. */
+    void graph_draw_hook (Chart_Context &)  override   {}
+
+
     /** If there is anything to draw then set up \c delta_region if
      *  necessary and call through that object to get the actual work of
      *  drawing the region done. */
-    void graph_draw_hook (Chart_Context &context,
-                          Tide_Mark::List &,
-                          unsigned number_shares,
-                          vector <Tide_Mark::Price_Marker> const &)  override;
+    void overlay_draw_hook (Chart_Context &context,
+                            unsigned number_shares)  override;
     
 
     /** Provide our signal handler. */
@@ -75,7 +75,7 @@ void  Hand_Analysis_Widget::new_chart  (Preferences&  P)
                    {chrono::hours {24 * (int)date_range.value ()->get_value ()},
                     chrono::hours {10 * 365 * 24}});
 
-    chart.data.changed_signal.emit ();
+    chart.data.note_change (Chart_Data::Change::RANGE);
   }
     
 
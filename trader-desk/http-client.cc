@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <trader-desk/http-client.h>
+#include <curlpp/Exception.hpp>
+#include <curlpp/Infos.hpp>
+#include <curlpp/Multi.hpp>
+#include <curlpp/Options.hpp>
+#include <algorithm>
+#include <thread>
+#include <sys/select.h>
+
+
+/** \file
+ *
+ *  Implementation of the \c Http_Client class. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  namespace Opt  =  curlpp::Options;
+
+
+  Http_Client::Http_Client  (size_t const n)  :  max_idle {n}
+  {}
+
+
+
+  Http_Client::Status_Error::Status_Error  (string const &url,
+                                            long const status_)
+    :  runtime_error {"HTTP status " + to_string (status_)
+                        + " from " + url.substr (0,  url.find ('?'))},
+       status {status_}
+  {}
+
+
+
+  Http_Client  &Http_Client::shared  ()
+  {
+    static Http_Client *const  client  {new Http_Client};
+    return *client;
+  }
+
+
+
+  auto  Http_Client::take  (string const &url)  ->  unique_ptr <Handle>
+  {
+    unique_ptr <Handle>  h;
+
+    {
+      lock_guard  l  {m};
+      if (! idle.empty ())
+        {
+          h = move (idle.back ());
+          idle.pop_back ();
+        }
+    }
+
+    /* Everything but the URL stays set on a handle between requests. */
+    if (! h)
+      {
+        h = make_unique <Handle> ();
+        auto *const  H  {h.get ()};
+
+        H->easy.setOpt (Opt::WriteFunction
+                          {[H] (char *const buffer,  size_t const size,
+                                size_t const n)
+                           {
+                             H->body.append (buffer,  size * n);
+                             return  size * n;
+                           }});
+
+        H->easy.setOpt (Opt::SslVerifyPeer {0});
+
+        /* An empty string asks for any encoding libcurl can undo. */
+        H->easy.setOpt (Opt::Encoding {""});
+
+        H->easy.setOpt (curlpp::OptionTrait <long,  CURLOPT_TCP_KEEPALIVE>
+                                                                        {1});
+
+        /* We are used from several threads. */
+        H->easy.setOpt (Opt::NoSignal {1});
+
+        H->easy.setOpt (Opt::ConnectTimeout {30});
+        H->easy.setOpt (Opt::Timeout {120});
+      }
+
+    h->body.clear ();
+    h->easy.setOpt (Opt::Url {url});
+
+    return h;
+  }
+
+
+
+  void  Http_Client::give_back  (unique_ptr <Handle> h)
+  {
+    lock_guard  l  {m};
+    if (idle.size () < max_idle)    idle.push_back (move (h));
+  }
+
+
+
+  string  Http_Client::finish  (unique_ptr <Handle> h,  string const &url)
+  {
+    auto  ret  {move (h->body)};
+
+    /* The connection is good for another request, whatever the server
+     * thought of this one. */
+    long const  status  {curlpp::infos::ResponseCode::get (h->easy)};
+    give_back (move (h));
+
+    if (status >= 400)    throw Status_Error {url,  status};
+
+    return ret;
+  }
+
+
+
+  string  Http_Client::get  (string const &url)
+  {
+    auto  h  {take (url)};
+
+    /* If this throws the handle is simply dropped, as we cannot be sure
+     * what state it is left in. */
+    h->easy.perform ();
+
+    return  finish (move (h),  url);
+  }
+
+
+
+  void  Http_Client::get_all
+           (vector <string> const &urls,
+            size_t const parallel,
+            function <void (size_t,  string &&,  exception_ptr)>  done,
+            function <Wait ()>  admit)
+  {
+    struct Flight
+    {
+      size_t  index;
+      unique_ptr <Handle>  handle;
+    };
+
+    /* This must outlive the multi handle, which lets go of the easy
+     * handles still in it when it is destroyed. */
+    vector <Flight>  flying;
+
+    curlpp::Multi  multi;
+
+    size_t  next  {0};
+
+    /* How long we have been told to wait before asking \c admit again. */
+    Wait  hold  {0};
+
+    auto const  start_more
+      {[&]
+       {
+         hold = Wait {0};
+         while (next < urls.size ()  &&  flying.size () < max <size_t>
+                                                            (parallel,  1))
+           {
+             if (admit)
+               if (auto const  w  {admit ()};  w != Wait {0})
+                 {
+                   hold = w;
+                   return;
+                 }
+
+             auto  h  {take (urls [next])};
+             multi.add (&h->easy);
+             flying.push_back ({next++,  move (h)});
+           }
+       }};
+
+    start_more ();
+
+    while (! flying.empty ()  ||  next < urls.size ())
+      {
+        int  running;
+        while (! multi.perform (&running))    ;
+
+        for (auto const &[easy, info]  :  multi.info ())
+          {
+            if (info.msg != CURLMSG_DONE)    continue;
+
+            auto const  f  {find_if (begin (flying),  end (flying),
+                                     [e = easy] (Flight const &f)
+                                     { return &f.handle->easy == e; })};
+            if (f == end (flying))    continue;
+
+            auto  F  {move (*f)};
+            flying.erase (f);
+            multi.remove (&F.handle->easy);
+
+            if (info.code == CURLE_OK)
+              {
+                string  body;
+                exception_ptr  error;
+
+                try  {  body = finish (move (F.handle),  urls [F.index]);  }
+                catch (Status_Error const &)
+                  {  error = current_exception ();  }
+
+                done (F.index,  move (body),  error);
+              }
+            else
+              done (F.index,  {},
+                    make_exception_ptr (curlpp::LibcurlRuntimeError
+                                           {curl_easy_strerror (info.code),
+                                            info.code}));
+          }
+
+        start_more ();
+
+        /* Wait for something to happen on the connections, or for the
+         * time to come to start another request, but not too long, as
+         * libcurl has time-outs of its own to look after. */
+        Wait  timeout  {100};
+        if (hold != Wait {0})    timeout = min (timeout,  hold);
+
+        if (flying.empty ())
+          {
+            this_thread::sleep_for (timeout);
+            continue;
+          }
+
+        fd_set  read,  write,  error;
+        FD_ZERO (&read);
+        FD_ZERO (&write);
+        FD_ZERO (&error);
+        int  max_fd  {-1};
+        multi.fdset (&read,  &write,  &error,  &max_fd);
+
+        timeval  tv  {0,  long (chrono::microseconds {timeout}.count ())};
+        select (max_fd + 1,  &read,  &write,  &error,  &tv);
+      }
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
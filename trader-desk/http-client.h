@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#ifndef DMBCS__TRADER_DESK__HTTP_CLIENT__H
+#define DMBCS__TRADER_DESK__HTTP_CLIENT__H
+
+
+#include <curlpp/Easy.hpp>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+/** \file
+ *
+ *  Declaration of the \c Http_Client class. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  using namespace std;
+
+
+  /** The means by which we talk to market-data services over HTTP.
+   *
+   *  Making a new \c curlpp::Easy for every request means that every
+   *  request pays for a DNS look-up, a TCP connection and a TLS hand-shake.
+   *  Instead we keep a pool of handles which have been used before, each
+   *  of which keeps its connections alive for the next request to the same
+   *  server, and ask for responses to be compressed.
+   *
+   *  Single requests are made with \c get.  When there are several to
+   *  make, \c get_all puts them in flight together through \c
+   *  curlpp::Multi, and hands each response back as it arrives.
+   *
+   *  Nothing here knows about any particular service: the URLs are given
+   *  whole, so that plain \c http to a stand-in server on the local
+   *  machine works just as well as the real thing.
+   *
+   *  Failures of the network, or of the server to speak HTTP, are
+   *  reported by throwing the \c curlpp exceptions, and responses with an
+   *  error status by throwing a \c Status_Error; what is in the body of
+   *  any other response is the callerʼs business. */
+
+  class Http_Client
+  {
+  public:
+
+    /** What the pool holds: a handle, and the body of the response to
+     *  the request it last made. */
+    struct Handle
+    {
+      curlpp::Easy  easy;
+      string  body;
+    };
+
+    typedef  chrono::milliseconds  Wait;
+
+    /** The server answered, but with a status of 400 or more (the body,
+     *  which is only an explanation, is thrown away). */
+    struct Status_Error  :  runtime_error
+    {
+      long  status;
+      Status_Error (string const &url,  long status_);
+    };
+
+  private:
+
+    /** The most handles we keep hold of when they are idle. */
+    size_t const  max_idle;
+
+    /** The idle handles; the most recently used is at the back, as it is
+     *  the most likely to still have a live connection. */
+    vector <unique_ptr <Handle>>  idle;
+
+    mutex  m;
+
+    /** Take a handle from the pool, or make a new one, set up to fetch
+     *  the \a url. */
+    unique_ptr <Handle>  take  (string const &url);
+
+    /** Put the handle \a h back in the pool, if there is room. */
+    void  give_back  (unique_ptr <Handle> h);
+
+    /** Return the body of the response to the request \a h has just
+     *  made to the \a url, and put \a h back in the pool; but throw a \c
+     *  Status_Error instead of returning an error response. */
+    string  finish  (unique_ptr <Handle> h,  string const &url);
+
+  public:
+
+    explicit Http_Client (size_t max_idle = 8);
+
+    /** The client which the whole application shares.  It is never
+     *  destroyed, so that it cannot outlive the \c curlpp::Cleanup in \c
+     *  main. */
+    static Http_Client  &shared  ();
+
+    /** Fetch the \a url, and return the body of the response.  An error
+     *  status is thrown as a \c Status_Error. */
+    string  get  (string const &url);
+
+    /** Fetch all the \a urls, with at most \a parallel requests in flight
+     *  at once.  As each request finishes \a done is called, in this
+     *  thread, with the index of its URL and either the body of the
+     *  response or the exception which explains why there is none (a \c
+     *  Status_Error if the server answered with an error status).
+     *
+     *  Before each request is started \a admit, if given, is asked
+     *  whether it may be: it returns zero if so, or else the time after
+     *  which it should be asked again (\c Rate_Limiter::try_acquire is
+     *  just such a function).
+     *
+     *  If \a done or \a admit throws, the requests still in flight are
+     *  abandoned and the exception is passed on. */
+    void  get_all  (vector <string> const &urls,
+                    size_t parallel,
+                    function <void (size_t,  string &&,  exception_ptr)>  done,
+                    function <Wait ()>  admit  =  {});
+
+  };  /* End of class Http_Client. */
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+#endif  /* Undefined DMBCS__TRADER_DESK__HTTP_CLIENT__H. */
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <trader-desk/indicators.h>
+#include <trader-desk/market-history.h>
+
+
+/** \file
+ *
+ *  Implementation of the \c Price_Columns constructor and the \c
+ *  market_macd function. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  Price_Columns::Price_Columns  (Time_Series const &series)
+  {
+    time.reserve (series.size ());
+    close.reserve (series.size ());
+
+    for (auto i = series.rbegin ();  i != series.rend ();  ++i)
+      {
+        time.push_back (i->time);
+        close.push_back (i->price);
+      }
+  }
+
+
+
+  vector <Company_Macd>  market_macd  (DB &db,
+                                       Market_Meta_Data const &market,
+                                       Duration const &history,
+                                       Macd::Parameters const &parameters)
+  {
+    auto const  companies  {Market_History::from_database
+                                  (db,  market,  chrono::system_clock::now (),
+                                   history)};
+
+    vector <Company_Macd>  ret;
+    ret.reserve (companies.size ());
+
+    for (auto const &c : companies)
+      {
+        if (c.prices.empty ())    continue;
+
+        auto const  M  {Macd_Series::over (Price_Columns {c.prices},
+                                           Macd {parameters})};
+
+        ret.push_back ({c.seqid,  c.name,  c.prices.front (),
+                        M.points.back ()});
+      }
+
+    return ret;
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
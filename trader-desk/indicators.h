@@ -0,0 +1,375 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#ifndef DMBCS__TRADER_DESK__INDICATORS__H
+#define DMBCS__TRADER_DESK__INDICATORS__H
+
+
+#include <trader-desk/kernels.h>
+#include <deque>
+
+
+/** \file
+ *
+ *  Declaration of the streaming technical-indicator kernels, \c Ema, \c
+ *  Macd, \c Rsi and \c Stochastic, of the \c Price_Columns they are
+ *  usually run over, and of the \c Indicator_Series which holds their
+ *  output in a form suitable for drawing and incremental extension.
+ *
+ *  The kernels consume one closing price at a time, in chronological
+ *  order, and do a constant (amortized) amount of work per price.  Each
+ *  has a \c Point type which is the result of one \c update.  They know
+ *  nothing of charts or widgets, and can be used equally from an \c
+ *  Analyzer or in a batch run over a whole market. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  struct Market_Meta_Data;
+
+
+  /** The closing prices of a \c Time_Series laid out as separate columns
+   *  of times and prices, oldest first, so that kernels can stream
+   *  through the prices without touching the times. */
+
+  struct Price_Columns
+  {
+    vector <Time_Point>      time;
+    vector <Currency_Value>  close;
+
+    /** Lay out the events of \a series (which runs newest first). */
+    explicit Price_Columns (Time_Series const &series);
+  };
+
+
+  /** Exponential moving average of a sequence of values.  The first value
+   *  seeds the average. */
+
+  class Ema
+  {
+    /** Smoothing factor, 2 / (period + 1). */
+    double  alpha;
+
+    /** The current average. */
+    double  value_  {0.0};
+
+    /** Whether we have seen any values yet. */
+    bool  primed  {0};
+
+  public:
+
+    /** Set up an average over (nominally) \a period values. */
+    explicit Ema (unsigned const period)  :  alpha {2.0 / (period + 1)}  {}
+
+    /** Take the next value \a x into account, and return the new
+     *  average. */
+    double  update  (double const x)
+    {
+      value_  =  primed  ?  value_ + alpha * (x - value_)  :  x;
+      primed  =  1;
+      return value_;
+    }
+
+    /** The current average. */
+    double  value  ()  const   {  return value_;  }
+
+  };  /* End of class Ema. */
+
+
+
+  /** Moving Average Convergence/Divergence: the difference between a fast
+   *  and a slow \c Ema of price, together with an \c Ema of that
+   *  difference (the signal line) and the difference between the two
+   *  (the histogram). */
+
+  class Macd
+  {
+  public:
+
+    /** The periods, in trading days, of the three averages.  The defaults
+     *  are the conventional ones. */
+    struct Parameters
+    {
+      unsigned  fast    {12};
+      unsigned  slow    {26};
+      unsigned  signal  {9};
+    };
+
+    /** The state of the indicator after one price. */
+    struct Point
+    {
+      double  fast;
+      double  slow;
+      double  macd;
+      double  signal;
+      double  histogram;
+    };
+
+  private:
+
+    Ema  fast,  slow,  signal;
+
+  public:
+
+    explicit Macd (Parameters const &p)
+      :  fast {p.fast},  slow {p.slow},  signal {p.signal}
+    {}
+
+    Macd ()  :  Macd {Parameters {}}  {}
+
+    /** Take the next closing \a price into account. */
+    Point  update  (double const price)
+    {
+      Point  ret;
+      ret.fast       =  fast.update (price);
+      ret.slow       =  slow.update (price);
+      ret.macd       =  ret.fast - ret.slow;
+      ret.signal     =  signal.update (ret.macd);
+      ret.histogram  =  ret.macd - ret.signal;
+      return ret;
+    }
+
+  };  /* End of class Macd. */
+
+
+
+  /** Wilder's Relative Strength Index: the proportion of recent price
+   *  movement which has been upwards, smoothed over \c period changes,
+   *  expressed on a scale of 0 to 100. */
+
+  class Rsi
+  {
+    unsigned  period;
+
+    /** Smoothed average gain and loss per change. */
+    double  gain  {0.0},  loss  {0.0};
+
+    /** The previous price. */
+    double  last  {0.0};
+
+    /** The number of prices seen so far. */
+    unsigned  count  {0};
+
+  public:
+
+    typedef  double  Point;
+
+    explicit Rsi (unsigned const p = 14)  :  period {p}  {}
+
+    /** Take the next closing \a price into account; returns \c NO_VALUE
+     *  until \c period changes have been seen. */
+    Point  update  (double const price)
+    {
+      if (count++ == 0)    {  last = price;  return NO_VALUE;  }
+
+      auto const  d  {price - last};
+      last = price;
+
+      auto const  g  {d > 0.0  ?  d  :  0.0};
+      auto const  l  {d < 0.0  ?  -d  :  0.0};
+
+      if (count <= period + 1)
+        {
+          gain += g / period;
+          loss += l / period;
+          if (count <= period)    return NO_VALUE;
+        }
+      else
+        {
+          gain = (gain * (period - 1) + g) / period;
+          loss = (loss * (period - 1) + l) / period;
+        }
+
+      return  loss == 0.0  ?  (gain == 0.0  ?  50.0  :  100.0)
+                           :  100.0  -  100.0 / (1.0 + gain / loss);
+    }
+
+  };  /* End of class Rsi. */
+
+
+
+  /** The stochastic oscillator: where the latest price lies between the
+   *  lowest and highest of the last \c period prices (%K), on a scale of 0
+   *  to 100, together with a simple moving average of that over \c
+   *  smoothing values (%D).
+   *
+   *  The textbook indicator uses the intra-day highs and lows; we only
+   *  hold closing prices, so the extremes are those of the closes.  They
+   *  are maintained in monotonic queues, so that each update costs
+   *  constant amortized time whatever the period. */
+
+  class Stochastic
+  {
+    unsigned  period;
+    unsigned  smoothing;
+
+    /** (index, price) pairs of candidates for the window maximum (prices
+     *  decreasing) and minimum (prices increasing). */
+    deque <pair <uint64_t, double>>  highs,  lows;
+
+    /** The last \c smoothing values of %K, and their sum. */
+    deque <double>  recent_k;
+    double  sum_k  {0.0};
+
+    /** The number of prices seen so far. */
+    uint64_t  count  {0};
+
+  public:
+
+    struct Point  {  double  k,  d;  };
+
+    explicit Stochastic (unsigned const p = 14,  unsigned const s = 3)
+      :  period {p},  smoothing {s}
+    {}
+
+    /** Take the next closing \a price into account; the components are \c
+     *  NO_VALUE until enough prices have been seen. */
+    Point  update  (double const price)
+    {
+      auto const  i  {count++};
+
+      while (! highs.empty ()  &&  highs.back ().second <= price)
+        highs.pop_back ();
+      highs.emplace_back (i,  price);
+      if (highs.front ().first + period <= i)    highs.pop_front ();
+
+      while (! lows.empty ()  &&  lows.back ().second >= price)
+        lows.pop_back ();
+      lows.emplace_back (i,  price);
+      if (lows.front ().first + period <= i)    lows.pop_front ();
+
+      if (count < period)    return {NO_VALUE,  NO_VALUE};
+
+      auto const  range  {highs.front ().second - lows.front ().second};
+      auto const  k  {range > 0.0
+                         ?  100.0 * (price - lows.front ().second) / range
+                         :  50.0};
+
+      recent_k.push_back (k);
+      sum_k += k;
+      if (recent_k.size () > smoothing)
+        {
+          sum_k -= recent_k.front ();
+          recent_k.pop_front ();
+        }
+
+      return {k,  recent_k.size () < smoothing  ?  NO_VALUE
+                                                :  sum_k / smoothing};
+    }
+
+  };  /* End of class Stochastic. */
+
+
+
+  /** The output of a \c Kernel run over a series of prices, held oldest
+   *  first (the opposite way round to \c Time_Series) so that new events
+   *  are appended at the end, together with the kernel state so that the
+   *  run can be continued. */
+
+  template <typename Kernel>
+  struct Indicator_Series
+  {
+    typedef  typename Kernel::Point  Point;
+
+    /** The kernel, in the state after the last of \c points. */
+    Kernel  kernel;
+
+    /** The times of the \c points. */
+    vector <Time_Point>  time;
+
+    /** The indicator values, one per event of the input. */
+    vector <Point>  points;
+
+
+    explicit Indicator_Series (Kernel const &k = Kernel {})  :  kernel {k}  {}
+
+
+    /** Feed all of the events in \a series which are more recent than
+     *  the last of our \c points into the kernel.  This costs time
+     *  proportional to the number of new events only. */
+    void  extend  (Time_Series const &series)
+    {
+      /* The series runs newest-first, so the new events are all at the
+       * front; find the first one we have already seen and work back
+       * towards the front from there. */
+      auto  i  {end (series)};
+
+      if (! time.empty ())
+        i = find_if (begin (series),  end (series),
+                     [this] (Event const &e)  { return e.time <= time.back (); });
+
+      time.reserve (time.size () + (i - begin (series)));
+      points.reserve (time.capacity ());
+
+      while (i != begin (series))
+        {
+          --i;
+          time.push_back (i->time);
+          points.push_back (kernel.update (i->price));
+        }
+    }
+
+
+    /** Compute the indicator over the whole of the \a prices, with a
+     *  kernel starting in the state \a k. */
+    static Indicator_Series  over  (Price_Columns const &prices,
+                                    Kernel const &k = Kernel {})
+    {
+      Indicator_Series  ret  {k};
+      ret.time = prices.time;
+      ret.points.resize (prices.close.size ());
+      run_kernel (ret.kernel,  prices.close,  ret.points);
+      return ret;
+    }
+
+  };  /* End of class Indicator_Series. */
+
+
+  typedef  Indicator_Series <Macd>        Macd_Series;
+  typedef  Indicator_Series <Rsi>         Rsi_Series;
+  typedef  Indicator_Series <Stochastic>  Stochastic_Series;
+
+
+
+  /** The latest indicator state for one company in a market. */
+  struct Company_Macd
+  {
+    int          company_seqid;
+    string       company_name;
+    Event        latest;
+    Macd::Point  point;
+  };
+
+
+  /** Run a \c Macd over the last \a history of the closing prices of
+   *  every company in \a market, and return the final state of each.
+   *  This does not require any graphics. */
+  vector <Company_Macd>  market_macd  (DB&,
+                                       Market_Meta_Data const &market,
+                                       Duration const &history,
+                                       Macd::Parameters const &
+                                                  = Macd::Parameters {});
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+#endif  /* Undefined DMBCS__TRADER_DESK__INDICATORS__H. */
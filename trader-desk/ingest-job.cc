@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+
+
+#include <trader-desk/ingest-job.h>
+
+
+/** \file
+ *
+ *  Implementation of the \c Ingest_Job class. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  void  Ingest_Job::create_tables  (DB &db)
+  {
+    db.instruction ("create table if not exists ingest_job "
+                             "(seqid int(6) primary key auto_increment, "
+                              "market int(6) not null, "
+                              "started int(11) not null)");
+
+    db.instruction ("create table if not exists ingest_checkpoint "
+                             "(job int(6) not null, "
+                              "company int(6) not null, "
+                              "state enum ('fetched', 'done') not null, "
+                              "response mediumtext, "
+                              "primary key (job, company))");
+  }
+
+
+
+  Ingest_Job::Ingest_Job  (Preferences &P,
+                           size_t const  market_seqid,
+                           time_t const  fresh_after)
+    :  db {P}
+  {
+    /* Databases made before there were jobs do not have the tables. */
+    create_tables (db);
+
+    seqid = db.scalar_result (0,
+                              "select seqid from ingest_job "
+                              " where market=%d and started>=%ld "
+                              " order by seqid desc limit 1",
+                              int (market_seqid),  long (fresh_after));
+
+    resumed_ = seqid != 0;
+
+    if (resumed_)
+      {
+        auto  row  {db.row_query ()};
+        row << "select company, state from ingest_checkpoint "
+            << " where job=" << seqid;
+        row.execute ();
+
+        for (;  row;  ++row)
+          {
+            auto const  company  {row.next_entry <int> ()};
+            states [company] = row.next_entry <string> () == "done"
+                                    ?  State::DONE  :  State::FETCHED;
+          }
+      }
+
+    /* Anything older on this market is stale. */
+    {
+      auto  I  {db.instruction ()};
+      I << "delete from ingest_checkpoint where job in "
+        <<     "(select seqid from ingest_job "
+        <<     "  where market=" << market_seqid
+        <<     "    and seqid<>" << seqid << ")";
+      I.execute ();
+    }
+    {
+      auto  I  {db.instruction ()};
+      I << "delete from ingest_job where market=" << market_seqid
+        <<                         " and seqid<>" << seqid;
+      I.execute ();
+    }
+
+    if (! resumed_)
+      {
+        auto  I  {db.instruction ()};
+        I << "insert into ingest_job set market=" << market_seqid
+          <<                         ", started=" << time (nullptr);
+        I.execute ();
+        seqid = I.insert_id ();
+      }
+  }
+
+
+
+  auto  Ingest_Job::state  (int const  company_seqid)  ->  State
+  {
+    lock_guard  l  {m};
+    auto const  i  {states.find (company_seqid)};
+    return  i == states.end ()  ?  State::PENDING  :  i->second;
+  }
+
+
+
+  optional <string>  Ingest_Job::response  (int const  company_seqid)
+  {
+    lock_guard  l  {m};
+
+    auto const  i  {states.find (company_seqid)};
+    if (i == states.end ()  ||  i->second != State::FETCHED)    return {};
+
+    try
+      {
+        auto  row  {db.row_query ()};
+        row << "select response from ingest_checkpoint "
+            << " where job=" << seqid << " and company=" << company_seqid;
+        row.execute ();
+
+        if (row)    return  row.next_entry <string> ();
+      }
+    catch (Mysql::DB_Connection::Exception &)  {}
+
+    return {};
+  }
+
+
+
+  /* Losing a checkpoint only means doing some work again, so trouble
+   * with the database is not allowed to stop the update. */
+
+  void  Ingest_Job::fetched  (int const  company_seqid,
+                              string const &response)
+  {
+    lock_guard  l  {m};
+    states [company_seqid] = State::FETCHED;
+
+    try
+      {
+        auto  I  {db.instruction ()};
+        I << "replace into ingest_checkpoint "
+          <<    "set job=" << seqid << ", company=" << company_seqid << ", "
+          <<        "state='fetched', "
+          <<        "response='" << db.escape (response) << "'";
+        I.execute ();
+      }
+    catch (Mysql::DB_Connection::Exception &)  {}
+  }
+
+
+
+  void  Ingest_Job::done  (int const  company_seqid)
+  {
+    lock_guard  l  {m};
+    states [company_seqid] = State::DONE;
+
+    try
+      {
+        auto  I  {db.instruction ()};
+        I << "replace into ingest_checkpoint "
+          <<    "set job=" << seqid << ", company=" << company_seqid << ", "
+          <<        "state='done', response=null";
+        I.execute ();
+      }
+    catch (Mysql::DB_Connection::Exception &)  {}
+  }
+
+
+
+  void  Ingest_Job::finish  ()
+  {
+    lock_guard  l  {m};
+    states.clear ();
+
+    db.instruction ("delete from ingest_checkpoint where job=%d",  seqid);
+    db.instruction ("delete from ingest_job where seqid=%d",  seqid);
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+
+
+#ifndef DMBCS__TRADER_DESK__INGEST_JOB__H
+#define DMBCS__TRADER_DESK__INGEST_JOB__H
+
+
+#include <trader-desk/db.h>
+#include <map>
+#include <mutex>
+#include <optional>
+
+
+/** \file
+ *
+ *  Declaration of the \c Ingest_Job class. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  /** The record in the database of an update of the closing prices of a
+   *  market, which lets an update that was stopped, or that failed part
+   *  of the way through, be taken up again where it left off.
+   *
+   *  For each company we note when its response has been downloaded,
+   *  keeping the response itself until its data have been written away,
+   *  and then when it is done with.  When the update is started again the
+   *  companies which are done are passed over, and those whose responses
+   *  are to hand are not asked for again, which saves both time and calls
+   *  against the dayʼs quota.  When the whole market has been done the
+   *  record is removed.
+   *
+   *  The record is kept in the \c ingest_job and \c ingest_checkpoint
+   *  tables, through a database connection of our own; all the methods
+   *  may be called from any thread. */
+
+  class Ingest_Job
+  {
+  public:
+
+    enum class State  {PENDING,  FETCHED,  DONE};
+
+  private:
+
+    DB  db;
+
+    /** Our sequence ID in the \c ingest_job table. */
+    int  seqid;
+
+    bool  resumed_  {0};
+
+    /** The state of each company which is not PENDING. */
+    map <int, State>  states;
+
+    mutex  m;
+
+  public:
+
+    /** Make the tables, if they are not already there. */
+    static void  create_tables  (DB&);
+
+    /** Take up the unfinished job on the market with \a market_seqid, if
+     *  it was started at or after the time \a fresh_after, or else start a
+     *  new one (and forget any old one). */
+    Ingest_Job (Preferences&,  size_t market_seqid,  time_t fresh_after);
+
+    Ingest_Job (Ingest_Job const &) = delete;
+    Ingest_Job &operator= (Ingest_Job const &) = delete;
+
+    /** Whether we took up an earlier job. */
+    bool  resumed  ()  const   {  return resumed_;  }
+
+    State  state  (int company_seqid);
+
+    /** The response which was downloaded for the company, if its state is
+     *  FETCHED. */
+    optional <string>  response  (int company_seqid);
+
+    /** Keep the \a response downloaded for the company until it is
+     *  \c done. */
+    void  fetched  (int company_seqid,  string const &response);
+
+    /** All the companyʼs data have been written away, or there are none
+     *  to be had. */
+    void  done  (int company_seqid);
+
+    /** The whole market has been done; remove the record of the job. */
+    void  finish  ();
+
+  };  /* End of class Ingest_Job. */
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+#endif  /* Undefined DMBCS__TRADER_DESK__INGEST_JOB__H. */
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <trader-desk/kernels.h>
+#include <cmath>
+
+
+/** \file
+ *
+ *  Implementation of the numerical kernels. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  double  mean  (Span <double const> const x)
+  {
+    double  sum  {0.0};
+    for (auto const  v  :  x)    sum += v;
+    return  sum / x.size ();
+  }
+
+
+
+  double  sample_deviation  (Span <double const> const x,  double const mean)
+  {
+    double  ss  {0.0};
+    for (auto const  v  :  x)    ss += (v - mean) * (v - mean);
+    return  std::sqrt (ss / (x.size () - 1));
+  }
+
+
+
+  double  sum_squared_difference  (Span <double const> const a,
+                                   Span <double const> const b)
+  {
+    auto const  n  {min (a.size (),  b.size ())};
+
+    double  ret  {0.0};
+    for (size_t i = 0;  i < n;  ++i)
+      ret += (a [i] - b [i]) * (a [i] - b [i]);
+
+    return ret;
+  }
+
+
+
+  void  centred_moving_average  (Span <Time_Point const> const time,
+                                 Span <double const> const price,
+                                 Duration const window,
+                                 Span <double> const out)
+  {
+    auto const  forward   {window / 2};
+    auto const  backward  {window - forward};
+
+    /* The window for event i covers the events from index back up to
+     * (but not including) front. */
+    size_t  back  {0},  front  {0};
+    double  sum  {0.0};
+
+    for (size_t i = 0;  i < price.size ();  ++i)
+      {
+        for (;  front < price.size ()  &&  time [front] < time [i] + forward;
+                ++front)
+          sum += price [front];
+
+        for (;  back < front  &&  time [back] < time [i] - backward;  ++back)
+          sum -= price [back];
+
+        out [i]  =  front > back  ?  sum / (front - back)  :  0.0;
+      }
+  }
+
+
+
+  void  trailing_mean  (Span <double const> const x,
+                        unsigned const period,
+                        Span <double> const out)
+  {
+    double  sum  {0.0};
+
+    for (size_t i = 0;  i < x.size ();  ++i)
+      {
+        sum += x [i];
+        if (i >= period)    sum -= x [i - period];
+        out [i]  =  i + 1 >= period  ?  sum / period  :  NO_VALUE;
+      }
+  }
+
+
+
+  void  trailing_deviation  (Span <double const> const x,
+                             unsigned const period,
+                             Span <double> const out)
+  {
+    if (x.empty ())    return;
+
+    /* The sums are taken about the first value rather than about zero, so
+     * that the subtraction at the end does not lose all precision for
+     * prices which move little relative to their size. */
+    auto const  origin  {x [0]};
+    double  sum  {0.0},  sum_sq  {0.0};
+
+    for (size_t i = 0;  i < x.size ();  ++i)
+      {
+        auto const  d  {x [i] - origin};
+        sum += d;
+        sum_sq += d * d;
+
+        if (i >= period)
+          {
+            auto const  e  {x [i - period] - origin};
+            sum -= e;
+            sum_sq -= e * e;
+          }
+
+        if (i + 1 < period  ||  period < 2)    {  out [i] = NO_VALUE;  continue;  }
+
+        auto const  var  {(sum_sq - sum * sum / period) / (period - 1)};
+        out [i]  =  var > 0.0  ?  std::sqrt (var)  :  0.0;
+      }
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#ifndef DMBCS__TRADER_DESK__KERNELS__H
+#define DMBCS__TRADER_DESK__KERNELS__H
+
+
+#include <trader-desk/time-series.h>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+
+/** \file
+ *
+ *  Declaration of the \c Span class template, and of the numerical
+ *  kernels which lie under the analyzers, the screener and the
+ *  backtester.
+ *
+ *  A kernel is a plain function over contiguous columns of values, held
+ *  oldest first, with all of its parameters passed explicitly.  Kernels
+ *  know nothing of charts, widgets or the database, and allocate no
+ *  memory: the caller provides the output columns.  This keeps the inner
+ *  loops simple enough for the compiler to vectorize, and lets the same
+ *  code run under the GUI, in a batch job or in a benchmark. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  /** Value given by kernels where there is not enough data to say
+   *  anything. */
+  constexpr double  const  NO_VALUE  {numeric_limits<double>::quiet_NaN ()};
+
+
+
+  /** A non-owning view of \c size contiguous objects of type \a T
+   *  (which may be const-qualified), in the manner of C++20's \c
+   *  std::span which our compilers do not all provide. */
+
+  template <typename T>
+  class Span
+  {
+    T       *first  {nullptr};
+    size_t   count  {0};
+
+  public:
+
+    constexpr Span  ()  =  default;
+
+    constexpr Span  (T *const f,  size_t const n)  :  first {f},  count {n}  {}
+
+    /** View the whole of a contiguous container, usually a \c vector or
+     *  another \c Span (so any \c Span can be viewed as a \c Span of \c
+     *  const). */
+    template <typename Container,
+              typename = enable_if_t <is_convertible_v
+                                         <decltype (declval <Container&> ().data ()),
+                                          T*>>>
+    constexpr Span  (Container &c)  :  first {c.data ()},  count {c.size ()}  {}
+
+    constexpr T      *data   ()  const   {  return first;  }
+    constexpr T      *begin  ()  const   {  return first;  }
+    constexpr T      *end    ()  const   {  return first + count;  }
+    constexpr size_t  size   ()  const   {  return count;  }
+    constexpr bool    empty  ()  const   {  return count == 0;  }
+
+    constexpr T  &operator[]  (size_t const i)  const   {  return first [i];  }
+
+    constexpr T  &front  ()  const   {  return first [0];  }
+    constexpr T  &back   ()  const   {  return first [count - 1];  }
+
+    /** The \a n objects starting at \a offset. */
+    constexpr Span  sub  (size_t const offset,  size_t const n)  const
+    {  return {first + offset,  n};  }
+
+    /** The last \a n objects. */
+    constexpr Span  last  (size_t const n)  const
+    {  return {first + count - n,  n};  }
+
+  };  /* End of class Span. */
+
+
+
+  /** The arithmetic mean of the \a x, which must not be empty. */
+  double  mean  (Span <double const> x);
+
+
+  /** The sample standard deviation of the \a x about their \a mean;
+   *  there must be at least two of them. */
+  double  sample_deviation  (Span <double const> x,  double mean);
+
+
+  /** The sum of the squares of the differences between corresponding
+   *  elements of \a a and \a b, over the length of the shorter. */
+  double  sum_squared_difference  (Span <double const> a,
+                                   Span <double const> b);
+
+
+  /** The mean of each \a price over a \a window of time centred on it,
+   *  from half a window before to half a window after, into \a out
+   *  (which must be as long as \a price).  Events near the ends of the
+   *  series are averaged over the part of the window which is
+   *  available. */
+  void  centred_moving_average  (Span <Time_Point const> time,
+                                 Span <double const> price,
+                                 Duration window,
+                                 Span <double> out);
+
+
+  /** The mean of the \a period values of \a x up to and including each
+   *  one, into \a out (which must be as long as \a x); the first \a
+   *  period - 1 outputs are \c NO_VALUE. */
+  void  trailing_mean  (Span <double const> x,
+                        unsigned period,
+                        Span <double> out);
+
+
+  /** The sample standard deviation of the \a period values of \a x up
+   *  to and including each one, into \a out (which must be as long as \a
+   *  x); the first \a period - 1 outputs are \c NO_VALUE. */
+  void  trailing_deviation  (Span <double const> x,
+                             unsigned period,
+                             Span <double> out);
+
+
+  /** Run one of the streaming kernels of \c indicators.h, starting in the
+   *  state it is given, over the \a close prices, putting each resulting
+   *  point in \a out (which must be as long as \a close). */
+  template <typename Kernel>
+  void  run_kernel  (Kernel &kernel,
+                     Span <double const> const close,
+                     Span <typename Kernel::Point> const out)
+  {
+    for (size_t i = 0;  i < close.size ();  ++i)
+      out [i] = kernel.update (close [i]);
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+#endif  /* Undefined DMBCS__TRADER_DESK__KERNELS__H. */
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <trader-desk/macd-analyzer.h>
+
+
+/** \file
+ *
+ *  Implementation of the \c Macd_Analyzer class. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  Macd_Analyzer::Macd_Analyzer (Chart_Data &cd)
+    :  Streaming_Analyzer {cd,  Macd {}}
+  {}
+
+
+
+  void  Macd_Analyzer::graph_draw_hook  (Chart_Context &canvas)
+  {
+    /* The two averages are on the price scale, so go straight onto the
+     * chart. */
+    draw_line (canvas,  [] (Macd::Point const &p) { return p.fast; },
+               Colour::FAST_EMA,  0.7);
+    draw_line (canvas,  [] (Macd::Point const &p) { return p.slow; },
+               Colour::SLOW_EMA,  0.7);
+  }
+
+
+
+  void  Macd_Analyzer::panel_draw_hook  (Chart_Context &panel)
+  {
+    auto const  first  {first_visible (panel)};
+    ptrdiff_t const  n  (series.time.size ());
+
+    double  extent  {0.0};
+    for (auto i = first;  i < n;  ++i)
+      extent = max ({extent,
+                     abs (series.points [i].macd),
+                     abs (series.points [i].signal),
+                     abs (series.points [i].histogram)});
+
+    if (extent <= 0.0)    extent = 1.0;
+
+    panel.outline.min_value  =  -1.05 * extent;
+    panel.outline.max_value  =   1.05 * extent;
+
+    draw_guides (panel,  {0.0},  "MACD (12, 26, 9)");
+
+    if (n - first < 2)    return;
+
+    auto const  bar_width
+          {max (1.0,  (panel.x (series.time [n - 1])
+                          - panel.x (series.time [first]))
+                       / (n - first)  *  0.6)};
+
+    for (auto i = first;  i < n;  ++i)
+      {
+        auto const  h  {series.points [i].histogram};
+        panel.set_source_rgb (h >= 0.0  ?  Colour::POSITIVE_DELTA
+                                        :  Colour::NEGATIVE_DELTA);
+        panel.cairo->rectangle (panel.x (series.time [i]) - bar_width / 2,
+                                panel.y (0.0),
+                                bar_width,
+                                panel.y (h) - panel.y (0.0));
+        panel.cairo->fill ();
+      }
+
+    draw_line (panel,  [] (Macd::Point const &p) { return p.macd; },
+               Colour::MACD_LINE);
+    draw_line (panel,  [] (Macd::Point const &p) { return p.signal; },
+               Colour::MACD_SIGNAL);
+  }
+
+
+
+  void  Macd_Analyzer::panel_cursor_hook  (Chart_Context &panel,
+                                           Time_Point const &cursor)
+  {
+    if (auto const *const  p  {at (cursor)})
+      label_cursor (panel,  cursor,  p->macd,  Colour::MACD_LINE);
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
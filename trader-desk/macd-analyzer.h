@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#ifndef DMBCS__TRADER_DESK__MACD_ANALYZER__H
+#define DMBCS__TRADER_DESK__MACD_ANALYZER__H
+
+
+#include <trader-desk/streaming-analyzer.h>
+
+
+/** \file
+ *
+ *  Declaration of the \c Macd_Analyzer class. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  /** An \c Analyzer which draws the fast and slow exponential moving
+   *  averages of price over the chart, and the MACD line, its signal line
+   *  and the histogram of their difference in a panel below it.  The
+   *  computation is kept up to date incrementally by the \c
+   *  Streaming_Analyzer base. */
+
+  class Macd_Analyzer : public Streaming_Analyzer <Macd>
+  {
+  public:
+
+    /** Sole constructor, which registers the \a chart_data to be
+     *  analyzed. */
+    explicit Macd_Analyzer (Chart_Data &);
+
+
+    /************************* Analyzer interface. **************************/
+
+    string name () const  override   { return "MACD"; }
+
+    /** Draw the fast and slow averages. */
+    void graph_draw_hook (Chart_Context &)  override;
+
+    /** We show the MACD itself in a panel. */
+    bool wants_panel () const  override   { return 1; }
+
+    /** Draw the MACD, signal and histogram, on a scale symmetric about
+     *  zero. */
+    void panel_draw_hook (Chart_Context &panel)  override;
+
+    /** Show the value of the MACD at the \a cursor. */
+    void panel_cursor_hook (Chart_Context &panel,
+                            Time_Point const &cursor)  override;
+
+  };  /* End of class Macd_Analyzer. */
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+#endif  /* Undefined DMBCS__TRADER_DESK__MACD_ANALYZER__H. */
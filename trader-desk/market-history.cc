@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <trader-desk/market-history.h>
+#include <trader-desk/markets.h>
+#include <unordered_map>
+
+
+/** \file
+ *
+ *  Implementation of the \c Market_History::from_database method. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  Market_History  Market_History::from_database
+                                     (DB &db,
+                                      Market_Meta_Data const &market,
+                                      Time_Point const &latest_time,
+                                      Duration const &window_size)
+  {
+    auto const  T  =  [] (Time_Point const &t)
+                         {  return number<chrono::seconds>
+                                          (t.time_since_epoch ());  };
+
+    auto const  close_time  {market.world_data.close_time};
+
+    Market_History  ret;
+
+    /* The latest price the user has entered for each company, which is
+     * spliced in ahead of the closing prices if it is more recent. */
+    vector <Event>  user_price;
+
+    unordered_map <int, size_t>  index;
+
+    {
+      auto sql = db.row_query ();
+
+      sql << "   select seqid, rtrim(name), "
+          << "          coalesce(unix_timestamp(last_price_date), 0), "
+          << "          coalesce(last_price, 0) "
+          << "     from company "
+          << "    where market=" << market.seqid
+          << " order by name asc";
+
+      for (sql.execute ();  sql;  ++sql)
+        {
+          auto const  seqid  {sql.next_entry<int> ()};
+          auto  name  {sql.next_entry<string> ()};
+          auto const  date  {sql.next_entry<time_t> ()};
+          auto const  price  {sql.next_entry<Currency_Value> ()};
+
+          index [seqid] = ret.size ();
+          ret.push_back ({seqid,  move (name),  Time_Series {close_time}});
+          user_price.emplace_back (date > T (latest_time)  ?  0  :  date,
+                                   price);
+        }
+    }
+
+    {
+      auto sql = db.row_query ();
+
+      sql << "  select prices.company, unix_timestamp(prices.date), "
+          << "         prices.close "
+          << "    from prices, company "
+          << "   where prices.company=company.seqid "
+          << "         and company.market=" << market.seqid
+          << "         and prices.date >= from_unixtime("
+          <<                               T (latest_time - window_size) << ") "
+          << "         and prices.date <= from_unixtime("
+          <<                               T (latest_time) << ") "
+          << "order by prices.company, prices.date desc";
+
+      for (sql.execute ();  sql;  ++sql)
+        {
+          auto const  i  {index.find (sql.next_entry<int> ())};
+          auto const  date  {sql.next_entry<Time_Point> () + close_time};
+          auto const  price  {sql.next_entry<Currency_Value> ()};
+
+          if (i == index.end ())    continue;
+
+          auto &prices  {ret [i->second].prices};
+          auto &user  {user_price [i->second]};
+
+          if (prices.empty ()  &&  user.time > date)
+            prices.push_back (user);
+
+          prices.emplace_back (date,  price);
+        }
+    }
+
+    return ret;
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#ifndef DMBCS__TRADER_DESK__MARKET_HISTORY__H
+#define DMBCS__TRADER_DESK__MARKET_HISTORY__H
+
+
+#include <trader-desk/time-series.h>
+
+
+/** \file
+ *
+ *  Declaration of the \c Company_History and \c Market_History
+ *  classes. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  struct Market_Meta_Data;
+
+
+  /** The identity and closing-price history of one company. */
+
+  struct Company_History
+  {
+    int          seqid;
+    string       name;
+    Time_Series  prices;
+  };
+
+
+
+  /** The closing-price histories of all the companies in a market, ordered
+   *  by company name, for analyses which range across the whole market.
+   *  Companies with no prices in the requested period are included, with
+   *  empty \c prices. */
+
+  struct Market_History  :  vector <Company_History>
+  {
+    /** Read the prices of every company in the \a market over a period of
+     *  \a window_size back from \a latest_time.  This is done in just two
+     *  database queries, however many companies there are; the results
+     *  are the same as \c Time_Series::from_database would give for each
+     *  company, including any latest price the user has entered. */
+    static Market_History  from_database  (DB&,
+                                           Market_Meta_Data const &market,
+                                           Time_Point const &latest_time,
+                                           Duration const &window_size);
+
+  };  /* End of class Market_History. */
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+#endif  /* Undefined DMBCS__TRADER_DESK__MARKET_HISTORY__H. */
@@ -29,11 +29,16 @@
 namespace DMBCS::Trader_Desk {
 
 
-  Moving_Average_Analyzer::Moving_Average_Analyzer (Chart_Data &cd)
+  Moving_Average_Analyzer::Moving_Average_Analyzer (Chart_Data &cd,
+                                                    Analysis_Cache &c)
     : chart_data (cd),
-      mean_series {cd.prices.market_close_time}
+      cache (c)
   {
-    chart_data . changed_signal . connect ([this] { compute (); });
+    chart_data . changed_signal
+               . connect ([this] (Chart_Data::Change const &c)
+                          { if (c.any (Chart_Data::Change::PRICES
+                                          | Chart_Data::Change::RANGE))
+                                compute (); });
   }
 
 
@@ -55,10 +60,10 @@ namespace DMBCS::Trader_Desk {
 
   void Moving_Average_Analyzer::stretch_outline (Time_Series::Range &outline)
   {
-    /* !!!!  When we re-visit this, need to ensure that the mean
-     *       time-series has been previously computed. */
+    auto const  R  {latest ()};
+    if (! R)    return;
 
-    auto const range  =  mean_series.get_range ();
+    auto const range  =  R->mean_series.get_range ();
 
     auto const margin =  (std::max (outline.max_value, range.max_value)
                                - std::min (outline.min_value, range.min_value)) 
@@ -71,13 +76,13 @@ namespace DMBCS::Trader_Desk {
 
 
 
-  void Moving_Average_Analyzer::graph_draw_hook
-                         (Chart_Context &canvas,
-                          Tide_Mark::List &marks,
-                          unsigned,
-                          vector <Tide_Mark::Price_Marker> const &markers)
+  void Moving_Average_Analyzer::graph_draw_hook  (Chart_Context &canvas)
   {
-    canvas . draw_time_series  (mean_series,  Colour::MEAN_GRAPH,  0.5);
+    auto const  R  {latest ()};
+    if (! R)    return;
+
+    canvas . draw_time_series  (R->mean_series,  Colour::MEAN_GRAPH,  0.5,
+                                R->pyramid);
 
 
     /* The vertical bar which shows the mid-point of the latest window. */
@@ -90,12 +95,22 @@ namespace DMBCS::Trader_Desk {
                         canvas.outline.max_value});
 
     canvas . cairo -> stroke ();
+  }
 
 
+
+  void Moving_Average_Analyzer::tide_mark_hook
+                         (Chart_Context const &,
+                          Tide_Mark::List &marks,
+                          vector <Tide_Mark::Price_Marker> const &markers)
+  {
+    auto const  R  {latest ()};
+    if (! R)    return;
+
     /* Put a tide-mark at the mean value at all points in time at which a
      * marker has been specified. */
     for (auto const &marker : markers)
-      marks.emplace_back (marker (mean_series.interpolated_value 
+      marks.emplace_back (marker (R->mean_series.interpolated_value 
                                          (marker (0.0, Colour::MEAN_TIDE).time),
                                   Colour::MEAN_TIDE));
   }
@@ -104,7 +119,12 @@ namespace DMBCS::Trader_Desk {
 
   void  Moving_Average_Analyzer::control_moved  (Scale const *const scale)
   {
-    mean_window =  chrono::hours  ((int) scale->value ()->get_value () * 24);
+    auto const  w  {chrono::hours  ((int) scale->value ()->get_value () * 24)};
+
+    if (w == mean_window)    return;
+
+    mean_window = w;
+    ++parameter_version;
     compute ();
   }
 
@@ -112,16 +132,53 @@ namespace DMBCS::Trader_Desk {
 
   void Moving_Average_Analyzer::compute ()
   {
+    if (chart_data.extremes.start_time != computed_start)
+      {
+        computed_start = chart_data.extremes.start_time;
+        ++parameter_version;
+      }
+
+    Input_Version const  v  {chart_data.prices_version,  parameter_version};
+
+    if (! result.needs (v))    return;
+
+    Analysis_Cache::Key  key  {"moving-average",
+                               v.data,
+                               chart_data.extremes.start_time,
+                               chart_data.extremes.end_time,
+                               {double (number<chrono::hours> (mean_window))}};
+
+    if (auto  hit  {cache.find <Result> (key)})
+      {
+        result.adopt (v,  move (hit));
+        redraw_needed_.emit ();
+        return;
+      }
+
+    shared_ptr <Time_Series const>  snapshot;
     {
       lock_guard<mutex> l {chart_data.prices_mutex};
-
-      mean_series = Time_Series::compute_moving_average 
-                                             (chart_data.prices,
-                                              mean_window,
-                                              chart_data.extremes.start_time);
+      snapshot = make_shared <Time_Series const> (chart_data.prices);
     }
-    
-    redraw_needed_.emit ();
+
+    result.request (v,
+                    [snapshot,  window = mean_window,  start = computed_start,
+                     key]
+                    {
+                      auto  mean  {Time_Series::compute_moving_average
+                                                  (*snapshot, window, start)};
+                      Series_Pyramid  pyramid  {mean};
+                      return Result {snapshot,
+                                     start,
+                                     move (mean),
+                                     move (pyramid),
+                                     key};
+                    },
+                    [this]
+                    {
+                      cache.insert (result.get ()->key,  result.get ());
+                      redraw_needed_.emit ();
+                    });
   }
 
 
@@ -24,6 +24,7 @@
 
 #include <trader-desk/analyzer.h>
 #include <trader-desk/scale.h>
+#include <trader-desk/worker-pool.h>
 
 
 /** \file
@@ -63,11 +64,40 @@ namespace DMBCS::Trader_Desk {
     /** The data that we are to analyze. */
     Chart_Data  &chart_data;
 
+    /** Where we keep results for re-use. */
+    Analysis_Cache  &cache;
+
     /** The size of the window over which we compute means. */
     Duration     mean_window {chrono::hours {14*24}};
 
-    /** The resulting time-series of local mean values. */
-    Time_Series  mean_series;
+    /** The outcome of one computation. */
+    struct Result
+    {
+      /** The snapshot of the prices which the means were computed from. */
+      shared_ptr <Time_Series const>  prices;
+
+      /** The earliest time of interest when the computation was made. */
+      Time_Point   earliest;
+
+      /** The resulting time-series of local mean values. */
+      Time_Series  mean_series;
+
+      /** Summary of \c mean_series for fast drawing. */
+      Series_Pyramid  pyramid;
+
+      /** The key under which this result is held in the \c cache. */
+      Analysis_Cache::Key  key;
+    };
+
+    /** The latest result of computing on the worker pool. */
+    Background_Result <Result>  result;
+
+    /** Incremented whenever \c mean_window or the start of the period of
+     *  interest changes, so that results may be tagged with it. */
+    uint64_t     parameter_version  {0};
+
+    /** The start of the period of interest at the last \c compute. */
+    Time_Point   computed_start;
 
     /** Fired whenever the analysis of data produces new results, which will
      *  need rendering in the GUI. */
@@ -79,29 +109,46 @@ namespace DMBCS::Trader_Desk {
     void control_moved (Scale const *const);
 
     /** Called whenever we must re-compute the moving-average
-     *  time-series, including when the \c chart_data change. */
+     *  time-series, including when the \c chart_data change.  The work
+     *  is done on the shared \c Worker_Pool, and \c redraw_needed_ is
+     *  emitted when it is finished; until then \c latest () returns the
+     *  previous result. */
     void compute ();
 
+    /** The most recently completed result, or \c nullptr if we have not
+     *  managed to compute anything yet. */
+    shared_ptr <Result const>  latest ()  const   {  return result.get ();  }
+
 
     /** Sole constructor which registers the \a chart_data we are to
-     *  analyze. */
-    explicit Moving_Average_Analyzer (Chart_Data &);
+     *  analyze, and the \a cache in which results are kept. */
+    Moving_Average_Analyzer (Chart_Data &,  Analysis_Cache &);
 
 
     /********************** Analyzer interface. ****************************/
 
 
+    string name () const  override   { return "moving average"; }
+
+
+    /** Have our computations timed. */
+    void instrument (shared_ptr <Stage_Timer> const &timer)  override
+    {  result.time_with (timer,  name () + " compute");  }
+
+
     /** Make a single widget which controls the size of the moving average
      *  window. */
     vector <Gtk::Widget*> make_control_widgets ()  override;
 
 
-    /** Draw the \c mean_series and add a \a tide label at all the \a
-     *  marked points in time. */
-    void graph_draw_hook (Chart_Context &,
-                          Tide_Mark::List &tide,
-                          unsigned number_shares,
-                          vector <Tide_Mark::Price_Marker> const &marked) 
+    /** Draw the \c mean_series. */
+    void graph_draw_hook (Chart_Context &)  override;
+
+
+    /** Add a \a tide label at all the \a marked points in time. */
+    void tide_mark_hook (Chart_Context const &,
+                         Tide_Mark::List &tide,
+                         vector <Tide_Mark::Price_Marker> const &marked)
       override;
 
 
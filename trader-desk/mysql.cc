@@ -81,6 +81,16 @@ namespace DMBCS::Trader_Desk { namespace Mysql {
 
 
 
+  string DB_Connection::escape  (string const &s)
+  {
+    string  ret  (s.length () * 2 + 1,  '\0');
+    ret.resize (mysql_real_escape_string (&mysql,  ret.data (),
+                                          s.data (),  s.length ()));
+    return ret;
+  }
+
+
+
   static int _run_query (MYSQL *const mysql,
                          string const &_template,
                          va_list arguments)
@@ -355,6 +355,12 @@ namespace DMBCS::Trader_Desk {
     
 
 
+    /** Return \a s with any characters which have a special meaning in
+     *  an SQL string escaped, ready to go between quotes in a query. */
+    string escape (string const &s);
+
+
+
     /** Implementation of following (\c instruction) method. */
     static void void_database_result (MYSQL *const mysql,
                                       string const &template_,
@@ -42,7 +42,9 @@ Preferences  Preferences::defaults  ()
              .database_port             =  3306,
              .market_meta_data_service  =  "https://rdmp.org:9443/trader-desk/",
              .market_data_service       =  "https://www.alphavantage.co/query",
-             .market_data_service_key   =  ""
+             .market_data_service_key   =  "",
+             .market_data_calls_per_minute  =  5,
+             .market_data_calls_per_day     =  500
          };
      }
 
@@ -73,7 +75,11 @@ void  dump  (const Preferences&  P,  ostream&&  O)
          << "database_port: "     << P.database_port     << "\n"
          << "market_meta_data_service: " << P.market_meta_data_service << "\n"
          << "market_data_service: " << P.market_data_service << "\n"
-         << "market_data_service_key: " << P.market_data_service_key << "\n";
+         << "market_data_service_key: " << P.market_data_service_key << "\n"
+         << "market_data_calls_per_minute: "
+                                     << P.market_data_calls_per_minute << "\n"
+         << "market_data_calls_per_day: "
+                                     << P.market_data_calls_per_day << "\n";
    }
 
 
@@ -118,6 +124,16 @@ Preferences  Preferences::from_file  (istream&&  I)
        ret.market_meta_data_service  =  read_line (I);
        ret.market_data_service  =  read_line (I);
        ret.market_data_service_key  =  read_line (I);
+
+       /* Files written before these were added will not have them. */
+       const auto  budget  {[&I] (const unsigned  fallback)  ->  unsigned
+                             {   const string  x  {read_line (I)};
+                                 return  x.empty ()  ?  fallback
+                                                     :  atoi (x.data ());  }};
+       ret.market_data_calls_per_minute
+                  =  budget (defaults ().market_data_calls_per_minute);
+       ret.market_data_calls_per_day
+                  =  budget (defaults ().market_data_calls_per_day);
        return  ret;
    }
 
@@ -152,6 +168,10 @@ static  void  commit_prefs  (Preferences_Dialog&  D,  Preferences&  P)
   P.market_meta_data_service  =  D.market_meta_data_service.get_text ();
   P.market_data_service  =  D.market_data_service.get_text ();
   P.market_data_service_key  =  D.market_data_service_key.get_text ();
+  P.market_data_calls_per_minute
+                  =  D.market_data_calls_per_minute.get_value_as_int ();
+  P.market_data_calls_per_day
+                  =  D.market_data_calls_per_day.get_value_as_int ();
 
   dump (P);
 }
@@ -322,11 +342,39 @@ Preferences_Dialog::Preferences_Dialog
     market_data_service_key.set_text (preferences.market_data_service_key);
     servers_->attach (market_data_service_key, 1, 2);
 
+    servers_->attach (*Gtk::make_managed<Gtk::Label>
+                            (pgettext ("Label", "Calls allowed per minute"),
+                             Gtk::ALIGN_END),
+                     0, 3);
+    market_data_calls_per_minute.set_increments (1.0, 10.0);
+    market_data_calls_per_minute.set_range (0.0, 10000.0);
+    market_data_calls_per_minute.set_value
+                                    (preferences.market_data_calls_per_minute);
+    servers_->attach (market_data_calls_per_minute, 1, 3);
+    servers_->attach (*Gtk::make_managed<Gtk::Label>
+                            (pgettext ("Label", "(0 for no limit)"),
+                             Gtk::ALIGN_START),
+                     2, 3);
+
+    servers_->attach (*Gtk::make_managed<Gtk::Label>
+                            (pgettext ("Label", "Calls allowed per day"),
+                             Gtk::ALIGN_END),
+                     0, 4);
+    market_data_calls_per_day.set_increments (100.0, 1000.0);
+    market_data_calls_per_day.set_range (0.0, 1000000.0);
+    market_data_calls_per_day.set_value
+                                    (preferences.market_data_calls_per_day);
+    servers_->attach (market_data_calls_per_day, 1, 4);
+    servers_->attach (*Gtk::make_managed<Gtk::Label>
+                            (pgettext ("Label", "(0 for no limit)"),
+                             Gtk::ALIGN_START),
+                     2, 4);
+
     if  (alpha_vantage__message.length ())
       {
         Gtk::Frame *const  F   {Gtk::make_managed<Gtk::Frame>
                                       ("Message from AlphaVantage service:")};
-        servers_->attach (*F, 0, 3, 2, 1);
+        servers_->attach (*F, 0, 5, 3, 1);
         F->set_margin_top (18);
         Gtk::TextView *const  T  {Gtk::make_managed<Gtk::TextView> ()};
         F->add  (*T);
@@ -61,6 +61,10 @@ namespace DMBCS::Trader_Desk {
     string    market_data_service;
     /* ... and private key. */
     string    market_data_service_key;
+    /* The number of calls the key allows us to make to the service; zero
+     * means no limit. */
+    unsigned  market_data_calls_per_minute;
+    unsigned  market_data_calls_per_day;
 
     /* Not really a user preference at this time. */
     static constexpr const int  time_horizon  {10};
@@ -121,7 +125,10 @@ namespace DMBCS::Trader_Desk {
     Gtk::Entry      market_data_service;
     /* ... and private key. */
     Gtk::Entry      market_data_service_key;
-    
+    /* ... and the limits it comes with. */
+    Gtk::SpinButton market_data_calls_per_minute {1.0, 0};
+    Gtk::SpinButton market_data_calls_per_day    {1.0, 0};
+
 
     Preferences_Dialog (Gtk::Window &,  Preferences&,
                         const string&  alpha_vantage_message  =  {});
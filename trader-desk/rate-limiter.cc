@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <trader-desk/rate-limiter.h>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+/** \file
+ *
+ *  Implementation of the \c Rate_Limiter class. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  Rate_Limiter::Rate_Limiter  (string const &provider,  Budget const &b)
+    :  budget {b},
+       local {HUGE_VAL,  HUGE_VAL,  Clock::now ()}
+  {
+    if (char const *const  home  {getenv ("HOME")})
+      {
+        auto const  dir  {home + string {"/.cache"}};
+        mkdir (dir.data (),  0755);
+        fd = open ((dir + "/trader-desk-" + provider + ".rate").data (),
+                   O_RDWR | O_CREAT | O_CLOEXEC,
+                   0644);
+      }
+  }
+
+
+
+  Rate_Limiter::~Rate_Limiter  ()
+  {
+    if (fd >= 0)    close (fd);
+  }
+
+
+
+  /* The state file holds a single line with the tokens in the minute and
+   * day buckets, and the time they were counted in nanoseconds since the
+   * epoch.  A missing or garbled file is taken to mean full buckets. */
+
+  auto  Rate_Limiter::read_state  ()  const  ->  State
+  {
+    char  buffer [128];
+    auto const  n  {pread (fd,  buffer,  sizeof buffer - 1,  0)};
+
+    double  minute,  day;
+    long long  ns;
+
+    if (n > 0
+          &&  (buffer [n] = '\0',
+               sscanf (buffer,  "%lf %lf %lld",  &minute,  &day,  &ns) == 3))
+      return  {minute,  day,
+               Clock::time_point {chrono::duration_cast <Clock::duration>
+                                           (chrono::nanoseconds {ns})}};
+
+    return  {HUGE_VAL,  HUGE_VAL,  Clock::now ()};
+  }
+
+
+
+  bool  Rate_Limiter::write_state  (State const &s)
+  {
+    char  buffer [128];
+    auto const  n  {snprintf (buffer,  sizeof buffer,  "%.6f %.6f %lld\n",
+                              s.minute,  s.day,
+                              (long long) chrono::duration_cast
+                                              <chrono::nanoseconds>
+                                                  (s.time.time_since_epoch ())
+                                            .count ())};
+
+    return  pwrite (fd,  buffer,  n,  0) == n  &&  ftruncate (fd,  n) == 0;
+  }
+
+
+
+  void  Rate_Limiter::refill  (State &s,  Clock::time_point const &now)  const
+  {
+    /* Another machine's idea of the time may be behind ours. */
+    auto const  seconds  {max (0.0,  chrono::duration <double> (now - s.time)
+                                              .count ())};
+
+    /* A bucket without a limit is always infinitely full, and one which
+     * has just been given a limit is topped up to it. */
+    s.minute = budget.per_minute
+                 ?  min (1.0,  s.minute + seconds * budget.per_minute / 60.0)
+                 :  HUGE_VAL;
+
+    s.day = budget.per_day
+              ?  min ((double) budget.per_day,
+                      s.day + seconds * budget.per_day / (24 * 60 * 60.0))
+              :  HUGE_VAL;
+
+    s.time = now;
+  }
+
+
+
+  template <typename Action>
+  auto  Rate_Limiter::with_state  (Action &&action)
+  {
+    lock_guard  l  {m};
+
+    if (fd < 0)
+      {
+        refill (local,  Clock::now ());
+        return action (local);
+      }
+
+    while (flock (fd,  LOCK_EX) != 0  &&  errno == EINTR)    ;
+
+    auto  s  {read_state ()};
+    refill (s,  Clock::now ());
+    auto const  ret  {action (s)};
+    bool const  written  {write_state (s)};
+
+    flock (fd,  LOCK_UN);
+
+    /* If the file cannot be kept, we carry on alone, in memory. */
+    if (! written)
+      {
+        close (fd);
+        fd = -1;
+        local = s;
+      }
+
+    return ret;
+  }
+
+
+
+  /* The time until a bucket which fills at \a per_period tokens in \a
+   * period seconds has its first whole token, given that it has \a tokens
+   * now. */
+  static Rate_Limiter::Wait  until_whole  (double const tokens,
+                                           unsigned const per_period,
+                                           double const period)
+  {
+    if (tokens >= 1.0)    return  Rate_Limiter::Wait {0};
+
+    return  Rate_Limiter::Wait
+              {(long) ceil ((1.0 - tokens) * period / per_period * 1000.0)};
+  }
+
+
+
+  auto  Rate_Limiter::wait_in  (State const &s)  const  ->  Wait
+  {
+    return  max (until_whole (s.minute,  budget.per_minute,  60.0),
+                 until_whole (s.day,  budget.per_day,  24 * 60 * 60.0));
+  }
+
+
+
+  void  Rate_Limiter::set_budget  (Budget const &b)
+  {
+    lock_guard  l  {m};
+    budget = b;
+  }
+
+
+
+  auto  Rate_Limiter::try_acquire  ()  ->  Wait
+  {
+    return  with_state ([this] (State &s)
+               {
+                 auto const  w  {wait_in (s)};
+
+                 if (w == Wait {0})    {  s.minute -= 1.0;  s.day -= 1.0;  }
+
+                 return w;
+               });
+  }
+
+
+
+  auto  Rate_Limiter::wait  ()  ->  Wait
+  {
+    return  with_state ([this] (State &s)  {  return wait_in (s);  });
+  }
+
+
+
+  void  Rate_Limiter::acquire  ()
+  {
+    for (Wait w;  (w = try_acquire ()) != Wait {0};  )
+      this_thread::sleep_for (w);
+  }
+
+
+
+  void  Rate_Limiter::reconcile_day  (unsigned const used)
+  {
+    with_state ([this,  used] (State &s)
+                {
+                  if (budget.per_day)
+                    s.day = min (s.day,
+                                 max (0.0,  (double) budget.per_day - used));
+                  return 0;
+                });
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
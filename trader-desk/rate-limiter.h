@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#ifndef DMBCS__TRADER_DESK__RATE_LIMITER__H
+#define DMBCS__TRADER_DESK__RATE_LIMITER__H
+
+
+#include <chrono>
+#include <mutex>
+#include <string>
+
+
+/** \file
+ *
+ *  Declaration of the \c Rate_Limiter class. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  using namespace std;
+
+
+  /** Keeps the calls we make to one data provider within the budget that
+   *  the provider allows us, both per minute and per day.
+   *
+   *  Each budget is a token bucket: a call takes one token from each, and
+   *  the buckets fill up again at the rate the budget allows.  The minute
+   *  bucket only ever holds a single token, so that calls are spread
+   *  evenly and no sixty-second window ever sees more than the budget; the
+   *  day bucket holds the whole day's allowance.
+   *
+   *  The state of the buckets is kept in a small file under \c
+   *  ~/.cache, which is locked with \c flock while it is read and
+   *  re-written, so that every thread and every instance of the
+   *  application which talks to the same provider draws from the same
+   *  buckets.  If the file cannot be used the buckets are simply kept in
+   *  memory, and shared by the threads of this process alone. */
+
+  class Rate_Limiter
+  {
+  public:
+
+    typedef  chrono::system_clock  Clock;
+    typedef  chrono::milliseconds  Wait;
+
+    /** The number of calls which may be made in a minute and in a day. */
+    struct Budget
+    {
+      /* Zero means that there is no limit. */
+      unsigned  per_minute;
+      unsigned  per_day;
+    };
+
+  private:
+
+    /** The tokens available in each bucket, as of the \c time. */
+    struct State
+    {
+      double  minute;
+      double  day;
+      Clock::time_point  time;
+    };
+
+    Budget  budget;
+
+    /** The shared state file, or -1 if we are working in memory. */
+    int  fd  {-1};
+
+    /** Only used when \c fd is -1. */
+    State  local;
+
+    mutex  m;
+
+    State  read_state  ()  const;
+
+    /** Returns FALSE if the state could not be written in full. */
+    bool   write_state  (State const &);
+
+    /** Bring the buckets in \a s up to the present time, \a now. */
+    void   refill  (State &s,  Clock::time_point const &now)  const;
+
+    /** The time until both buckets in \a s will have a whole token. */
+    Wait   wait_in  (State const &s)  const;
+
+    /** Run \a action on the refilled state with the state file locked, and
+     *  write the state back if \a action says so. */
+    template <typename Action>  auto  with_state  (Action &&);
+
+  public:
+
+    /** Set up the buckets for the \a provider, whose name is used to
+     *  form the name of the state file. */
+    Rate_Limiter (string const &provider,  Budget const &);
+
+    ~Rate_Limiter ();
+
+    Rate_Limiter (Rate_Limiter const &) = delete;
+    Rate_Limiter &operator= (Rate_Limiter const &) = delete;
+
+    /** Change the budget, for example when a premium key is entered on the
+     *  preferences panel.  This only affects our own view of the buckets;
+     *  other processes keep their own budget until they are told. */
+    void  set_budget  (Budget const &);
+
+    /** Take a token from each bucket and return zero, if they both have
+     *  one; otherwise take nothing and return the time until they
+     *  will. */
+    Wait  try_acquire  ();
+
+    /** The time until a call could be made, without making one. */
+    Wait  wait  ();
+
+    /** Wait until a call may be made, and take the tokens for it. */
+    void  acquire  ();
+
+    /** The provider tells us (by way of the \c alphavantage_ticks table,
+     *  say) that \a used calls have been made in the last day; take that
+     *  into account if our own day bucket is more generous. */
+    void  reconcile_day  (unsigned used);
+
+  };  /* End of class Rate_Limiter. */
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+#endif  /* Undefined DMBCS__TRADER_DESK__RATE_LIMITER__H. */
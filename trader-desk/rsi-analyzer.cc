@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <trader-desk/rsi-analyzer.h>
+
+
+/** \file
+ *
+ *  Implementation of the \c Rsi_Analyzer class. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  Rsi_Analyzer::Rsi_Analyzer (Chart_Data &cd)
+    :  Streaming_Analyzer {cd,  Rsi {14}}
+  {}
+
+
+
+  void  Rsi_Analyzer::panel_draw_hook  (Chart_Context &panel)
+  {
+    panel.outline.min_value  =    0.0;
+    panel.outline.max_value  =  100.0;
+
+    draw_guides (panel,  {30.0,  50.0,  70.0},  "RSI (14)");
+
+    draw_line (panel,  [] (Rsi::Point const &p) { return p; },
+               Colour::RSI_LINE);
+  }
+
+
+
+  void  Rsi_Analyzer::panel_cursor_hook  (Chart_Context &panel,
+                                          Time_Point const &cursor)
+  {
+    if (auto const *const  p  {at (cursor)})
+      label_cursor (panel,  cursor,  *p,  Colour::RSI_LINE);
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
@@ -58,7 +58,8 @@ namespace DMBCS::Trader_Desk {
           . connect ([this] { on_slider_changed (); });
 
     data . changed_signal
-         . connect ([this] { on_data_changed (); });
+         . connect ([this] (Chart_Data::Change const &c)
+                    { on_data_changed (c); });
   }
 
 
@@ -73,9 +73,9 @@ namespace DMBCS::Trader_Desk {
     virtual void on_slider_changed ()   { setup_label (); }
 
     /** Called when an externally generated signal fires on the \c data
-     *  object to indicate that some change has taken place in those
-     *  data. */
-    virtual void on_data_changed   () {}
+     *  object to indicate that some change, described by the argument,
+     *  has taken place in those data. */
+    virtual void on_data_changed   (Chart_Data::Change const &) {}
 
     
   public:
@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <trader-desk/screener.h>
+#include <trader-desk/markets.h>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+
+/** \file
+ *
+ *  Implementation of the market screener. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  static constexpr double  const  NaN  {numeric_limits<double>::quiet_NaN ()};
+
+
+
+  /* Read a period from \a in into \a p.  Extracting straight into an
+   * unsigned would take a minus sign and wrap the number round, so it is
+   * read signed and checked. */
+  static void  read_period  (istream &in,  unsigned &p)
+  {
+    long long  n;
+
+    if (in.peek () == '-'  ||  ! (in >> n)
+              ||  n < 1  ||  n > Screen_Expression::MAX_PERIOD)
+      in.setstate (ios::failbit);
+    else
+      p = unsigned (n);
+  }
+
+
+
+  Screen_Expression  Screen_Expression::parse  (string const &text)
+  {
+    istringstream  in  {text};
+    string  kind;
+    getline (in,  kind,  ':');
+
+    Screen_Expression  ret  {Kind::RETURN,  0};
+    char  colon  {':'};
+
+    if (kind == "envelope")
+      {
+        ret.kind = Kind::ENVELOPE_DISTANCE;
+        read_period (in,  ret.period);
+        if (! in.eof ())    in >> colon >> ret.width;
+      }
+    else if (kind == "return")
+      read_period (in,  ret.period);
+    else if (kind == "crossover")
+      {
+        ret.kind = Kind::MA_CROSSOVER;
+        read_period (in,  ret.period);
+        in >> colon;
+        read_period (in,  ret.slow_period);
+      }
+    else
+      in.setstate (ios::failbit);
+
+    if (in.fail ()  ||  ! in.eof ()  ||  colon != ':'
+              ||  ret.period < 1
+              ||  (ret.kind == Kind::MA_CROSSOVER
+                        &&  ret.slow_period <= ret.period)
+              ||  (ret.kind == Kind::ENVELOPE_DISTANCE
+                        &&  (ret.period < 2  ||  ret.width <= 0.0)))
+      throw runtime_error {"bad screen expression \"" + text + "\""};
+
+    return ret;
+  }
+
+
+
+  string  Screen_Expression::title  ()  const
+  {
+    ostringstream  ret;
+
+    switch (kind)
+      {
+      case Kind::ENVELOPE_DISTANCE:
+        ret << "envelope:" << period << ':' << width;    break;
+      case Kind::RETURN:
+        ret << "return:" << period;                       break;
+      case Kind::MA_CROSSOVER:
+        ret << "crossover:" << period << ':' << slow_period;    break;
+      }
+
+    return ret.str ();
+  }
+
+
+
+  size_t  Screen_Expression::events_needed  ()  const
+  {
+    switch (kind)
+      {
+      case Kind::RETURN:         return size_t {period} + 1;
+      case Kind::MA_CROSSOVER:   return slow_period;
+      default:                   return period;
+      }
+  }
+
+
+
+  double  Screen_Expression::evaluate  (Span <double const> const close)  const
+  {
+    if (close.size () < events_needed ())    return NaN;
+
+    auto const  latest  {close.back ()};
+
+    switch (kind)
+      {
+      case Kind::RETURN:
+        {
+          auto const  then  {close [close.size () - 1 - period]};
+          return  then == 0.0  ?  NaN  :  100.0 * (latest / then - 1.0);
+        }
+
+      case Kind::MA_CROSSOVER:
+        {
+          auto const  slow  {mean (close.last (slow_period))};
+          return  slow == 0.0
+                    ?  NaN
+                    :  100.0 * (mean (close.last (period)) / slow - 1.0);
+        }
+
+      case Kind::ENVELOPE_DISTANCE:
+        {
+          auto const  window  {close.last (period)};
+          auto const  m  {mean (window)};
+          auto const  sd  {sample_deviation (window,  m)};
+
+          return  sd == 0.0  ?  NaN  :  (latest - m)  /  (width * sd);
+        }
+      }
+
+    return NaN;
+  }
+
+
+
+  /* The closing prices of the last \a n (or fewer) events of \a prices,
+   * oldest first. */
+  static void  last_closes  (Time_Series const &prices,
+                             size_t n,
+                             vector <double> &out)
+  {
+    n = min (n,  prices.size ());
+    out.resize (n);
+    for (size_t i = 0;  i < n;  ++i)
+      out [n - 1 - i] = prices [i].price;
+  }
+
+
+
+  double  Screen_Expression::evaluate  (Time_Series const &prices)  const
+  {
+    vector <double>  close;
+    last_closes (prices,  events_needed (),  close);
+    return evaluate (close);
+  }
+
+
+
+  vector <Screen_Expression>  default_screen  ()
+  {
+    using  K  =  Screen_Expression::Kind;
+
+    return {{K::ENVELOPE_DISTANCE,  20,   0,  2.0},
+            {K::RETURN,              5},
+            {K::RETURN,             20},
+            {K::MA_CROSSOVER,       10,  50}};
+  }
+
+
+
+  void  Screen::rank  (size_t const column,  bool const descending)
+  {
+    stable_sort (begin (rows),  end (rows),
+                 [column,  descending] (Row const &a,  Row const &b)
+                 {
+                   auto const  x  {a.values [column]};
+                   auto const  y  {b.values [column]};
+                   if (std::isnan (y))    return ! std::isnan (x);
+                   if (std::isnan (x))    return false;
+                   return  descending  ?  x > y  :  x < y;
+                 });
+  }
+
+
+
+  Screen  run_screen  (Market_History const &history,
+                       vector <Screen_Expression> const &expressions,
+                       Worker_Pool &pool)
+  {
+    Screen  ret  {expressions,  {}};
+
+    for (auto const &c  :  history)
+      if (! c.prices.empty ())
+        ret.rows.push_back ({c.seqid,  c.name,  c.prices.front (),
+                             vector <double> (expressions.size (),  NaN)});
+
+    /* Each company's series is only read, and each row only written, by
+     * the one block which contains it. */
+    vector <Time_Series const *>  series;
+    series.reserve (ret.rows.size ());
+    for (auto const &c  :  history)
+      if (! c.prices.empty ())
+        series.push_back (&c.prices);
+
+    size_t  events  {1};
+    for (auto const &e  :  expressions)
+      events = max (events,  e.events_needed ());
+
+    pool.parallel_for (ret.rows.size (),
+                       [&] (size_t const b,  size_t const e)
+                       {
+                         vector <double>  close;
+
+                         for (auto i = b;  i < e;  ++i)
+                           {
+                             last_closes (*series [i],  events,  close);
+                             for (size_t j = 0;  j < expressions.size ();  ++j)
+                               ret.rows [i].values [j]
+                                    =  expressions [j].evaluate (close);
+                           }
+                       },
+                       16);
+
+    if (! expressions.empty ())    ret.rank (0);
+
+    return ret;
+  }
+
+
+
+  Screen  screen_market  (DB &db,
+                          Market_Meta_Data const &market,
+                          vector <Screen_Expression> const &expressions)
+  {
+    size_t  events  {1};
+    for (auto const &e  :  expressions)
+      events = max (events,  e.events_needed ());
+
+    /* Allow for weekends and holidays when converting trading days to
+     * calendar time. */
+    auto const  days  {events * 7 / 5  +  10};
+
+    return  run_screen (Market_History::from_database
+                               (db,  market,  chrono::system_clock::now (),
+                                chrono::hours {24 * days}),
+                        expressions);
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
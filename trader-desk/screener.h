@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#ifndef DMBCS__TRADER_DESK__SCREENER__H
+#define DMBCS__TRADER_DESK__SCREENER__H
+
+
+#include <trader-desk/kernels.h>
+#include <trader-desk/market-history.h>
+#include <trader-desk/worker-pool.h>
+
+
+/** \file
+ *
+ *  Declaration of the \c Screen_Expression and \c Screen classes, and of
+ *  the \c run_screen and \c screen_market functions which together make a
+ *  market-wide stock screener.  None of this requires any graphics. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  /** One quantity which the screener computes from the closing prices of
+   *  every company.  Periods are counted in trading days (i.e. events in
+   *  the time series), not calendar days. */
+
+  struct Screen_Expression
+  {
+    enum class Kind
+      {
+        /** Where the latest price lies relative to an envelope of \c width
+         *  standard deviations about the mean of the last \c period
+         *  prices: 0 at the mean, +1 or -1 at the edges of the envelope. */
+        ENVELOPE_DISTANCE,
+
+        /** The percentage change in price over the last \c period
+         *  days. */
+        RETURN,
+
+        /** The percentage by which the mean of the last \c period prices
+         *  exceeds the mean of the last \c slow_period; it changes sign
+         *  when the averages cross. */
+        MA_CROSSOVER
+      };
+
+    Kind      kind;
+    unsigned  period;
+    unsigned  slow_period  {0};
+    double    width        {2.0};
+
+    /** The longest period \c parse will accept: about a century of
+     *  trading days. */
+    static constexpr unsigned const  MAX_PERIOD  {100 * 261};
+
+
+    /** Parse one of \c "envelope:PERIOD:WIDTH", \c "return:PERIOD" or \c
+     *  "crossover:PERIOD:SLOW_PERIOD".  Throws \c runtime_error if \a
+     *  text is not understood. */
+    static Screen_Expression  parse  (string const &text);
+
+    /** A short title for the results of this expression, suitable for a
+     *  column heading; also acceptable to \c parse. */
+    string  title  ()  const;
+
+    /** The number of the most recent events of a series needed to
+     *  evaluate this expression. */
+    size_t  events_needed  ()  const;
+
+    /** Evaluate against the \a close prices, oldest first, giving \c
+     *  NaN if there are not enough of them. */
+    double  evaluate  (Span <double const> close)  const;
+
+    /** Evaluate against the \a prices, giving \c NaN if there are not
+     *  enough of them. */
+    double  evaluate  (Time_Series const &prices)  const;
+
+  };  /* End of class Screen_Expression. */
+
+
+
+  /** The expressions used when the user has not asked for any in
+   *  particular. */
+  vector <Screen_Expression>  default_screen  ();
+
+
+
+  /** The results of evaluating a set of \c Screen_Expression's over all
+   *  the companies in a market. */
+
+  struct Screen
+  {
+    struct Row
+    {
+      int             seqid;
+      string          company_name;
+      Event           latest;
+
+      /** One value for each of the \c expressions. */
+      vector <double> values;
+    };
+
+    vector <Screen_Expression>  expressions;
+
+    vector <Row>  rows;
+
+    /** Sort the \c rows on the values in \a column, largest first unless
+     *  \a descending is false; rows without a value go at the end. */
+    void  rank  (size_t const column,  bool const descending = 1);
+
+  };  /* End of class Screen. */
+
+
+
+  /** Evaluate the \a expressions over every company in \a history which
+   *  has any prices, sharing the work out over the \a pool, and return
+   *  the results ranked on the first expression. */
+  Screen  run_screen  (Market_History const &history,
+                       vector <Screen_Expression> const &expressions,
+                       Worker_Pool &pool = Worker_Pool::shared ());
+
+
+  /** Read just enough history for the \a expressions from the database
+   *  and \c run_screen over it. */
+  Screen  screen_market  (DB&,
+                          Market_Meta_Data const &market,
+                          vector <Screen_Expression> const &expressions);
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+#endif  /* Undefined DMBCS__TRADER_DESK__SCREENER__H. */
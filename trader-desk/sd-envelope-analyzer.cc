@@ -18,8 +18,8 @@
  */
 
 
-#include <numeric>
 #include <trader-desk/sd-envelope-analyzer.h>
+#include <trader-desk/kernels.h>
 
 
 /** \file
@@ -30,8 +30,10 @@
 namespace DMBCS::Trader_Desk {
     
 
-  SD_Envelope_Analyzer::SD_Envelope_Analyzer (Chart_Data &cd)
-    : moving_average {cd}
+  SD_Envelope_Analyzer::SD_Envelope_Analyzer (Chart_Data &cd,
+                                              Analysis_Cache &c)
+    : moving_average {cd,  c},
+      cache (c)
   {
     moving_average  .  signal_redraw_needed ()
                     .  connect ([this] { data_changed (); });
@@ -56,12 +58,10 @@ namespace DMBCS::Trader_Desk {
 
 
 
-  template <typename X>  inline X sq (X const &x)  { return x*x; }
-
-
-  static Currency_Value standard_deviation_ (Time_Series const &t,
-                                             Time_Series const &mean,
-                                             Time_Point  const &earliest_time)
+  Currency_Value
+  SD_Envelope_Analyzer::standard_deviation (Time_Series const &t,
+                                            Time_Series const &mean,
+                                            Time_Point  const &earliest_time)
   {
     if (mean.size () < 2)
       return 0.0;
@@ -73,29 +73,56 @@ namespace DMBCS::Trader_Desk {
                                    Time_Series::value_type const &a)
                                            { return a.time < val; });
 
-    return std::sqrt (std::inner_product (begin (mean),  end_,
-                                          begin (t),
-                                          Currency_Value {0.0},
-                                          plus<Currency_Value> {},
-                                          [] (Event const &a, Event const &b)
-                                             { return sq (a.price - b.price); })
-                         / (mean.size () - 1));
+    /* Both series run newest first, and from the same latest event, so
+     * the prices pair off index by index. */
+    auto const n  =  min <size_t> (end_ - begin (mean),  t.size ());
+
+    vector<double> a (n),  b (n);
+    for (size_t i = 0;  i < n;  ++i)
+      {
+        a [i] = mean [i].price;
+        b [i] = t [i].price;
+      }
+
+    return std::sqrt (sum_squared_difference (a, b)  /  (mean.size () - 1));
   }
 
 
 
   void SD_Envelope_Analyzer::data_changed ()
   {
-    {
-      lock_guard<mutex> l {moving_average.chart_data.prices_mutex};
-
-      standard_deviation 
-        = standard_deviation_ (moving_average.chart_data.prices,
-                               moving_average.mean_series,
-                               moving_average.chart_data.extremes.start_time);
-    }
-    
-    redraw_needed_.emit ();
+    auto const  mean  {moving_average.latest ()};
+    if (! mean)    return;
+
+    auto const &v  {moving_average.result.version ()};
+
+    if (! result.needs (v))    return;
+
+    /* The deviation depends on nothing but the mean series, so it can be
+     * filed under the same key with our own name. */
+    auto  key  {mean->key};
+    key.analyzer  =  "sd-envelope";
+
+    if (auto  hit  {cache.find <Result> (key)})
+      {
+        result.adopt (v,  move (hit));
+        redraw_needed_.emit ();
+        return;
+      }
+
+    result.request (v,
+                    [mean]
+                    {
+                      return Result {mean,
+                                     standard_deviation (*mean->prices,
+                                                         mean->mean_series,
+                                                         mean->earliest)};
+                    },
+                    [this,  key]
+                    {
+                      cache.insert (key,  result.get ());
+                      redraw_needed_.emit ();
+                    });
   }
 
 
@@ -113,7 +140,11 @@ namespace DMBCS::Trader_Desk {
 
   void SD_Envelope_Analyzer::stretch_outline (Time_Series::Range &outline)
   {
-    auto const range  = moving_average.mean_series.get_range ();
+    auto const  R  {result.get ()};
+    if (! R)    return;
+
+    auto const standard_deviation = R->standard_deviation;
+    auto const range  = R->mean->mean_series.get_range ();
     auto const margin = (outline.max_value - outline.min_value) * 0.05;
 
     outline.max_value = max (outline.max_value,
@@ -129,45 +160,69 @@ namespace DMBCS::Trader_Desk {
 
 
 
-  void SD_Envelope_Analyzer::graph_draw_hook
-                          (Chart_Context &context,
-                           Tide_Mark::List &marks,
-                           unsigned number_shares,
-                           vector <Tide_Mark::Price_Marker> const &markers)
+  void SD_Envelope_Analyzer::graph_draw_hook  (Chart_Context &context)
   {
-    if (moving_average.mean_series.empty ())
-      return;
+    auto const  R  {result.get ()};
+
+    if (! R  ||  R->mean->mean_series.empty ())
+      {
+        moving_average . graph_draw_hook (context);
+        return;
+      }
+
+    auto const &mean_series  =  R->mean->mean_series;
 
     context.set_source_rgb (Colour::SD_ENVELOPE);
 
-    context.move_to (moving_average.mean_series.front ());
+    auto const envelope = envelope_width * R->standard_deviation;
+
+    /* The envelope is the mean line displaced up and down, so the
+     * decimated mean line serves for both edges. */
+    vector <Event>  points;
+    context.decimate (mean_series,  R->mean->pyramid,  points);
+
+    if (! points.empty ())
+      {
+        context.move_to ({points.front ().time,
+                          points.front ().price + envelope});
+
+        for (auto const &p : points)
+          context.line_to ({p.time, p.price + envelope});
+
+        for (auto i = points.rbegin ();  i != points.rend ();  ++i)
+          context.line_to ({i->time, i->price - envelope});
 
-    auto const envelope = envelope_width * standard_deviation;
+        context.cairo->fill ();
+      }
 
-    auto i  =  begin (moving_average.mean_series);
+    moving_average . graph_draw_hook (context);
+  }
 
-    for (;
-         i != end (moving_average.mean_series)
-                 &&  i->time >= context.outline.start_time;
-         ++i)
-      context.line_to ({i->time, i->price + envelope});
 
-    for (--i; i >= begin (moving_average.mean_series); --i)
-      context.line_to ({i->time, i->price - envelope});
 
-    context.cairo->fill ();
+  void SD_Envelope_Analyzer::tide_mark_hook
+                          (Chart_Context const &context,
+                           Tide_Mark::List &marks,
+                           vector <Tide_Mark::Price_Marker> const &markers)
+  {
+    auto const  R  {result.get ()};
 
-    for (auto const &t : markers)
+    if (R  &&  ! R->mean->mean_series.empty ())
       {
-        auto const mean 
-          = moving_average.mean_series
-                          .interpolated_value (t (0.0, Colour::MEAN_TIDE).time);
+        auto const &mean_series  =  R->mean->mean_series;
+        auto const envelope = envelope_width * R->standard_deviation;
+
+        for (auto const &t : markers)
+          {
+            auto const mean 
+              = mean_series.interpolated_value (t (0.0, Colour::MEAN_TIDE).time);
 
-        marks.emplace_back (t (mean - envelope, Colour::ENVELOPE_TIDES));
-        marks.emplace_back (t (mean + envelope, Colour::ENVELOPE_TIDES));
+            marks.emplace_back (t (mean - envelope, Colour::ENVELOPE_TIDES));
+            marks.emplace_back (t (mean + envelope, Colour::ENVELOPE_TIDES));
+          }
       }
 
-    moving_average . graph_draw_hook (context, marks, number_shares, markers);
+    moving_average . tide_mark_hook (context, marks, markers);
   }
 
 
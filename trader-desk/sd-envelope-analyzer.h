@@ -71,9 +71,24 @@ namespace DMBCS::Trader_Desk {
      *  standard_deviation. */
     double envelope_width {2};
 
-    /** The current standard deviation of the data in the prices
-     *  time-series about the current mean time-series. */
-    double standard_deviation {0};
+    /** The outcome of one computation. */
+    struct Result
+    {
+      /** The moving average which the deviation is measured about. */
+      shared_ptr <Moving_Average_Analyzer::Result const>  mean;
+
+      /** The standard deviation of the data in the prices time-series
+       *  about the \c mean time-series. */
+      double  standard_deviation  {0};
+    };
+
+    /** Where we keep results for re-use. */
+    Analysis_Cache  &cache;
+
+    /** The latest result of computing on the worker pool; it is tagged
+     *  with the version of the \c moving_average result it derives
+     *  from. */
+    Background_Result <Result>  result;
 
     /** We emit this signal whenever we re-compute the \c
      *  standard_deviation. */
@@ -85,7 +100,8 @@ namespace DMBCS::Trader_Desk {
     void control_moved (Scale const *const);
 
     /** Called when the \c moving_average object signals that the mean
-     *  time-series has just been re-computed. */
+     *  time-series has just been re-computed; we then compute a new
+     *  standard deviation on the worker pool. */
     void data_changed ();
 
 
@@ -93,11 +109,30 @@ namespace DMBCS::Trader_Desk {
 
     /** Sole constructor which sets up a fully populated and operational
      *  object. */
-    explicit SD_Envelope_Analyzer (Chart_Data &cd);
+    SD_Envelope_Analyzer (Chart_Data &cd,  Analysis_Cache &);
+
+
+    /** The standard deviation of the \a prices about their moving
+     *  average \a mean (both newest first, from the same latest event),
+     *  back as far as \a earliest_time.  This is the whole of the
+     *  computation we do on the worker pool. */
+    static Currency_Value standard_deviation (Time_Series const &prices,
+                                              Time_Series const &mean,
+                                              Time_Point  const &earliest_time);
 
 
     /* Analyzer interface. */
 
+    string name () const  override   { return "SD envelope"; }
+
+    /** Have our computations, and those of the \c moving_average,
+     *  timed. */
+    void instrument (shared_ptr <Stage_Timer> const &timer)  override
+    {
+      moving_average.instrument (timer);
+      result.time_with (timer,  name () + " compute");
+    }
+
     /** Return a (newly allocated) composite object which includes sliders
      *  for ourself and the \c moving_average. */
     vector <Gtk::Widget*> make_control_widgets ()  override;
@@ -107,10 +142,13 @@ namespace DMBCS::Trader_Desk {
     void stretch_outline (Time_Series::Range &)  override;
 
     /** Display the envelope and \c moving_average chart. */
-    void graph_draw_hook (Chart_Context &context,
-                          Tide_Mark::List &,
-                          unsigned number_shares,
-                          vector <Tide_Mark::Price_Marker> const &)  override;
+    void graph_draw_hook (Chart_Context &context)  override;
+
+    /** Mark the edges of the envelope, and the mean, at the \a markers. */
+    void tide_mark_hook (Chart_Context const &,
+                         Tide_Mark::List &,
+                         vector <Tide_Mark::Price_Marker> const &markers)
+      override;
 
     /** Return the signal object on which we emit when anything
      *  changes. */
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <trader-desk/series-pyramid.h>
+#include <algorithm>
+#include <cmath>
+
+
+/** \file
+ *
+ *  Implementation of the \c Series_Pyramid class. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  using  Bucket  =  Series_Pyramid::Bucket;
+
+
+  /* The summary of the run \a a followed (back in time) by \a b. */
+  static Bucket  combine  (Bucket const &a,  Bucket const &b)
+  {
+    return {b.early,
+            a.late,
+            b.low.price  <  a.low.price   ?  b.low   :  a.low,
+            b.high.price >  a.high.price  ?  b.high  :  a.high};
+  }
+
+
+  static Bucket  single  (Event const &e)   {  return {e, e, e, e};  }
+
+
+
+  Series_Pyramid::Series_Pyramid  (Time_Series const &series)
+    :  source_size {series.size ()}
+  {
+    if (series.size () < 4)    return;
+
+    levels.emplace_back ();
+    levels.back ().reserve (series.size () / 2);
+    for (size_t i = 0;  i + 1 < series.size ();  i += 2)
+      levels.back ().push_back (combine (single (series [i]),
+                                         single (series [i + 1])));
+
+    while (levels.back ().size () >= 4)
+      {
+        auto const &below  {levels.back ()};
+        vector <Bucket>  level;
+        level.reserve (below.size () / 2);
+        for (size_t i = 0;  i + 1 < below.size ();  i += 2)
+          level.push_back (combine (below [i],  below [i + 1]));
+        levels.push_back (move (level));
+      }
+  }
+
+
+
+  void  Series_Pyramid::decimate  (Time_Series const &series,
+                                   Time_Point const &start,
+                                   Time_Point const &end,
+                                   double const columns,
+                                   vector <Event> &out)  const
+  {
+    /* Find the events in the period, and one either side. */
+    auto const  newer  =  [] (Event const &e,  Time_Point const &t)
+                            {  return e.time > t;  };
+
+    size_t  lo  = lower_bound (begin (series), std::end (series), end, newer)
+                    -  begin (series);
+    size_t  hi  = lower_bound (begin (series), std::end (series), start, newer)
+                    -  begin (series);
+
+    if (lo > 0)    --lo;
+    hi = min (hi + 1,  series.size ());
+
+    if (hi <= lo)    return;
+
+    auto const  n  {hi - lo};
+
+    /* Few enough events that they may as well all be drawn. */
+    if (columns < 1.0  ||  n <= 4 * columns  ||  end <= start)
+      {
+        for (auto i = hi;  i > lo;  --i)    out.push_back (series [i - 1]);
+        return;
+      }
+
+    /* Pick the level whose runs are at most a quarter of the number of
+     * events per column, so that few runs straddle two columns; those
+     * that do are split. */
+    auto const  per_column  {n / columns};
+    int  level  {int (std::floor (std::log2 (per_column / 4.0))) - 1};
+    level = min (level,  int (levels.size ()) - 1);
+    if (! describes (series))    level = -1;
+
+    size_t const  run  {level < 0  ?  1  :  size_t {2} << level};
+
+    auto const  column_width  {(end - start) / columns};
+    auto const  column  =  [&] (Time_Point const &t)
+                             {  return std::floor ((t - start)
+                                                     / column_width);  };
+
+    /* Accumulate the events of one column at a time, oldest first. */
+    Bucket  acc;
+    double  current  {NAN};
+
+    auto const  emit  =  [&out] (Event const &e)
+      {
+        if (out.empty ()  ||  out.back ().time != e.time)
+          out.push_back (e);
+      };
+
+    auto const  flush  =  [&]
+      {
+        emit (acc.early);
+        if (acc.low.time < acc.high.time)
+          {  emit (acc.low);   emit (acc.high);  }
+        else
+          {  emit (acc.high);  emit (acc.low);   }
+        emit (acc.late);
+      };
+
+    auto const  take  =  [&] (Bucket const &b)
+      {
+        auto const  c  {column (b.early.time)};
+        if (c == current)
+          acc = combine (b,  acc);
+        else
+          {
+            if (! std::isnan (current))    flush ();
+            acc = b;
+            current = c;
+          }
+      };
+
+    /* Take the b'th run at level k whole if it lies in one column,
+     * otherwise take its two halves (the older first). */
+    auto const  take_run  =  [&] (auto const &self,
+                                  int const k,
+                                  size_t const b)  ->  void
+      {
+        auto const &B  {levels [k] [b]};
+
+        if (column (B.early.time) == column (B.late.time))
+          take (B);
+        else if (k == 0)
+          {
+            take (single (series [2 * b + 1]));
+            take (single (series [2 * b]));
+          }
+        else
+          {
+            self (self,  k - 1,  2 * b + 1);
+            self (self,  k - 1,  2 * b);
+          }
+      };
+
+    for (auto i = hi;  i > lo;  )
+      if (level >= 0  &&  i % run == 0  &&  i >= lo + run)
+        {
+          take_run (take_run,  level,  i / run - 1);
+          i -= run;
+        }
+      else
+        take (single (series [--i]));
+
+    flush ();
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
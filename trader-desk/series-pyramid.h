@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#ifndef DMBCS__TRADER_DESK__SERIES_PYRAMID__H
+#define DMBCS__TRADER_DESK__SERIES_PYRAMID__H
+
+
+#include <trader-desk/time-series.h>
+
+
+/** \file
+ *
+ *  Declaration of the \c Series_Pyramid class. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  /** A multi-resolution summary of a \c Time_Series, from which a line
+   *  can be drawn with a number of vertices proportional to the width of
+   *  the chart in pixels rather than to the length of the series, and
+   *  which looks exactly the same as one drawn through every event.
+   *
+   *  For each pixel column of the chart, only four events are needed:
+   *  the first and last in the column, which join the line to its
+   *  neighbours, and the lowest and highest, which give the vertical
+   *  extent of the line in the column.  The pyramid holds these four for
+   *  runs of 2, 4, 8, ... consecutive events, so that the four for a
+   *  column can be found by combining a few runs instead of looking at
+   *  every event in it.
+   *
+   *  Building the pyramid takes time proportional to the length of the
+   *  series; it is meant to be kept alongside the series until that
+   *  changes. */
+
+  class Series_Pyramid
+  {
+  public:
+
+    /** Summary of a run of consecutive events. */
+    struct Bucket
+    {
+      Event  early,  late,  low,  high;
+    };
+
+
+  private:
+
+    /** levels [k] summarizes runs of 2^(k+1) events, in the same order as
+     *  the series (newest first); any incomplete run at the old end of the
+     *  series is left out. */
+    vector <vector <Bucket>>  levels;
+
+    /** The length of the series we were built from. */
+    size_t  source_size  {0};
+
+
+  public:
+
+    /** An empty pyramid, with which \c decimate will work directly from
+     *  the series. */
+    Series_Pyramid ()  =  default;
+
+    /** Build the pyramid for the \a series. */
+    explicit Series_Pyramid (Time_Series const &series);
+
+    /** Were we built from a series the same length as \a s?  (Series
+     *  only ever grow, so this is a cheap check that we are up to
+     *  date.) */
+    bool  describes  (Time_Series const &s)  const
+    {  return  source_size == s.size ();  }
+
+
+    /** Append to \a out, oldest first, the vertices of a line which,
+     *  drawn through \a columns pixel columns spanning the times from \a
+     *  start to \a end, is indistinguishable from one drawn through every
+     *  event of the \a series in that period.  The events immediately
+     *  outside the period are included, so that the line runs right to
+     *  the edges.  The \a series must be the one this pyramid was built
+     *  from, or this pyramid must be empty. */
+    void  decimate  (Time_Series const &series,
+                     Time_Point const &start,
+                     Time_Point const &end,
+                     double const columns,
+                     vector <Event> &out)  const;
+
+  };  /* End of class Series_Pyramid. */
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+#endif  /* Undefined DMBCS__TRADER_DESK__SERIES_PYRAMID__H. */
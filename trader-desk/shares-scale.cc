@@ -35,16 +35,18 @@ namespace DMBCS::Trader_Desk {
                                      1, 1000, 10000,
                                      1)
   {
-    d.changed_signal . connect  ([this] { on_data_changed (); });
-
     value_adjustment -> signal_value_changed ()
                      . connect  ([this] { on_value_changed (); });
   }
 
 
 
-  void Shares_Scale::on_data_changed ()
+  void Shares_Scale::on_data_changed (Chart_Data::Change const &c)
   {
+    if (! c.any (Chart_Data::Change::POSITION
+                   | Chart_Data::Change::NEW_COMPANY))
+      return;
+
     if (data.open_position.price < 0)
       scale.show ();
     else
@@ -65,7 +67,8 @@ namespace DMBCS::Trader_Desk {
       {
         data.number_shares =  (unsigned) (value ()->get_value () + 0.5);
         data.update_extreme_prices ();
-        data.changed_signal.emit ();
+        data.note_change (Chart_Data::Change::POSITION
+                              | Chart_Data::Change::RANGE);
       }
   }
 
@@ -43,7 +43,7 @@ namespace DMBCS::Trader_Desk {
     void on_value_changed ();
 
     /** Called when the \c Chart_Data change. */
-    void on_data_changed ()  override;
+    void on_data_changed (Chart_Data::Change const &)  override;
     
   public:
 
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <trader-desk/stage-timer.h>
+#include <algorithm>
+
+
+/** \file
+ *
+ *  Implementation of the \c Stage_Timer class. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  void  Stage_Timer::record  (string const &stage,
+                              chrono::steady_clock::duration const d)
+  {
+    auto const  ms  {chrono::duration <double, milli> {d} . count ()};
+
+    lock_guard  l  {stages_mutex};
+
+    /* There are only ever a dozen or so stages, so a linear search is as
+     * quick as anything. */
+    auto  s  {find_if (begin (stages),  end (stages),
+                       [&stage] (Stage const &s)  { return s.name == stage; })};
+
+    if (s == end (stages))
+      {
+        stages.emplace_back ();
+        s = end (stages) - 1;
+        s->name = stage;
+      }
+
+    s->times [s->count++ % WINDOW] = ms;
+  }
+
+
+
+  vector <Stage_Timer::Statistics>  Stage_Timer::snapshot  ()  const
+  {
+    lock_guard  l  {stages_mutex};
+
+    vector <Statistics>  ret;
+    ret.reserve (stages.size ());
+
+    for (auto const &s  :  stages)
+      {
+        auto const  n  {min <uint64_t> (s.count,  WINDOW)};
+
+        Statistics  S  {s.name,  s.count,  s.times [(s.count - 1) % WINDOW]};
+
+        for (uint64_t i = 0;  i < n;  ++i)
+          {
+            S.mean += s.times [i];
+            S.max = max (S.max,  s.times [i]);
+          }
+
+        S.mean /= n;
+        ret.push_back (S);
+      }
+
+    return ret;
+  }
+
+
+
+  void  Stage_Timer::reset  ()
+  {
+    lock_guard  l  {stages_mutex};
+    stages.clear ();
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
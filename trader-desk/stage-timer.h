@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#ifndef DMBCS__TRADER_DESK__STAGE_TIMER__H
+#define DMBCS__TRADER_DESK__STAGE_TIMER__H
+
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+/** \file
+ *
+ *  Declaration of the \c Stage_Timer class, which keeps rolling
+ *  statistics of the time taken by named stages of work, such as the
+ *  parts of drawing a chart. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  using namespace std;
+
+
+  /** A record of how long each of a number of named stages of work has
+   *  taken over its last \c WINDOW runs.  Stages are timed by putting a
+   *  \c Scope around them; they can be run in any thread.  The results
+   *  are read with \c snapshot. */
+
+  class Stage_Timer
+  {
+  public:
+
+    /** The number of recent runs of each stage which the statistics
+     *  cover. */
+    static constexpr size_t const  WINDOW  {64};
+
+
+    /** The state of one stage, with all times in milliseconds. */
+    struct Statistics
+    {
+      string    stage;
+
+      /** The number of runs since the timer was made or last \c reset,
+       *  not just those in the window. */
+      uint64_t  count  {0};
+
+      double    last  {0.0};
+      double    mean  {0.0};
+      double    max   {0.0};
+    };
+
+
+    /** Time the life of this object as a run of the \a stage, if there is
+     *  a \a timer to record it in. */
+    class Scope
+    {
+      Stage_Timer *const  timer;
+      string const  stage;
+      chrono::steady_clock::time_point const  start;
+
+    public:
+
+      Scope  (Stage_Timer *const t,  string s)
+        :  timer {t},  stage {move (s)},  start {chrono::steady_clock::now ()}
+      {}
+
+      Scope  (Scope const &)  =  delete;
+      Scope &operator=  (Scope const &)  =  delete;
+
+      ~Scope  ()
+      {
+        if (timer)
+          timer->record (stage,  chrono::steady_clock::now () - start);
+      }
+
+    };  /* End of class Scope. */
+
+
+    /** Note that a run of the \a stage took \a duration. */
+    void  record  (string const &stage,  chrono::steady_clock::duration);
+
+    /** The statistics of every stage seen, in the order in which they
+     *  were first seen. */
+    vector <Statistics>  snapshot  ()  const;
+
+    /** Forget everything. */
+    void  reset  ();
+
+
+  private:
+
+    struct Stage
+    {
+      string    name;
+      uint64_t  count  {0};
+
+      /** The last \c WINDOW times, in milliseconds, as a ring indexed by
+       *  \c count. */
+      double    times [WINDOW];
+    };
+
+    mutable mutex  stages_mutex;
+    vector <Stage>  stages;
+
+  };  /* End of class Stage_Timer. */
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+#endif  /* Undefined DMBCS__TRADER_DESK__STAGE_TIMER__H. */
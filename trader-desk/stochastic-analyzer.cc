@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <trader-desk/stochastic-analyzer.h>
+
+
+/** \file
+ *
+ *  Implementation of the \c Stochastic_Analyzer class. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  Stochastic_Analyzer::Stochastic_Analyzer (Chart_Data &cd)
+    :  Streaming_Analyzer {cd,  Stochastic {14,  3}}
+  {}
+
+
+
+  void  Stochastic_Analyzer::panel_draw_hook  (Chart_Context &panel)
+  {
+    panel.outline.min_value  =    0.0;
+    panel.outline.max_value  =  100.0;
+
+    draw_guides (panel,  {20.0,  80.0},  "Stochastic (14, 3)");
+
+    draw_line (panel,  [] (Stochastic::Point const &p) { return p.d; },
+               Colour::STOCHASTIC_D);
+    draw_line (panel,  [] (Stochastic::Point const &p) { return p.k; },
+               Colour::STOCHASTIC_K);
+  }
+
+
+
+  void  Stochastic_Analyzer::panel_cursor_hook  (Chart_Context &panel,
+                                                 Time_Point const &cursor)
+  {
+    if (auto const *const  p  {at (cursor)})
+      label_cursor (panel,  cursor,  p->k,  Colour::STOCHASTIC_K);
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
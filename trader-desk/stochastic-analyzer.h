@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#ifndef DMBCS__TRADER_DESK__STOCHASTIC_ANALYZER__H
+#define DMBCS__TRADER_DESK__STOCHASTIC_ANALYZER__H
+
+
+#include <trader-desk/streaming-analyzer.h>
+
+
+/** \file
+ *
+ *  Declaration of the \c Stochastic_Analyzer class. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  /** An \c Analyzer which shows the 14-day stochastic oscillator (%K) and
+   *  its three-day average (%D) in a panel below the chart, with guide
+   *  lines at 20 and 80.  Note that, as we only hold closing prices, the
+   *  range is that of the closes rather than of the intra-day extremes
+   *  (see the \c Stochastic kernel). */
+
+  class Stochastic_Analyzer : public Streaming_Analyzer <Stochastic>
+  {
+  public:
+
+    /** Sole constructor, which registers the \a chart_data to be
+     *  analyzed. */
+    explicit Stochastic_Analyzer (Chart_Data &);
+
+
+    /************************* Analyzer interface. **************************/
+
+    string name () const  override   { return "stochastic"; }
+
+    /** We draw nothing on the price chart itself. */
+    void graph_draw_hook (Chart_Context &)  override   {}
+
+    /** We live in a panel of our own. */
+    bool wants_panel () const  override   { return 1; }
+
+    /** Draw %K and %D on a scale of 0 to 100. */
+    void panel_draw_hook (Chart_Context &panel)  override;
+
+    /** Show the value at the \a cursor. */
+    void panel_cursor_hook (Chart_Context &panel,
+                            Time_Point const &cursor)  override;
+
+  };  /* End of class Stochastic_Analyzer. */
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+#endif  /* Undefined DMBCS__TRADER_DESK__STOCHASTIC_ANALYZER__H. */
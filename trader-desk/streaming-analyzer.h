@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#ifndef DMBCS__TRADER_DESK__STREAMING_ANALYZER__H
+#define DMBCS__TRADER_DESK__STREAMING_ANALYZER__H
+
+
+#include <trader-desk/analyzer.h>
+#include <trader-desk/indicators.h>
+#include <trader-desk/worker-pool.h>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+
+/** \file
+ *
+ *  Definition and complete inline implementation of the \c
+ *  Streaming_Analyzer class template. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  /** The common part of analyzers built on one of the streaming kernels
+   *  in \c indicators.h.  We keep an \c Indicator_Series up to date with
+   *  the \c chart_data: when new events arrive at the recent end they are
+   *  simply fed through the kernel, at constant cost per event; the whole
+   *  series is recomputed, on the worker pool, only when older history
+   *  is added, the company changes, or an event lands behind the last one
+   *  seen.
+   *
+   *  Derived classes provide the drawing, for which some help is given
+   *  here. */
+
+  template <typename Kernel>
+  class Streaming_Analyzer : public Analyzer
+  {
+  protected:
+
+    typedef  Indicator_Series <Kernel>  Series;
+
+    /** The data that we are to analyze. */
+    Chart_Data  &chart_data;
+
+    /** The kernel in its initial state, with its parameters set. */
+    Kernel const  prototype;
+
+    /** The latest complete computation from the worker pool. */
+    Background_Result <Series>  full;
+
+    /** The series we draw: a copy of the last \c full result, extended
+     *  in place as new events arrive. */
+    Series  series;
+
+    /** Fired whenever we have new results to show. */
+    sigc::signal <void>  redraw_needed_;
+
+
+    Streaming_Analyzer (Chart_Data &cd,  Kernel const &k)
+      :  chart_data (cd),  prototype {k},  series {k}
+    {
+      chart_data . changed_signal
+                 . connect ([this] (Chart_Data::Change const &c)
+                            { data_changed (c); });
+    }
+
+
+    /** Act on a change to the \c chart_data. */
+    void  data_changed  (Chart_Data::Change const &c)
+    {
+      using  C  =  Chart_Data::Change;
+
+      if (! c.any (C::PRICES))    return;
+
+      /* Anything other than new events at the recent end invalidates the
+       * kernel state. */
+      if (c.any (C::EXTENDED_HEAD | C::NEW_COMPANY)
+             ||  series.time.empty ()
+             ||  c.tail_from <= series.time.back ())
+        {
+          recompute ();
+          return;
+        }
+
+      catch_up ();
+      redraw_needed_.emit ();
+    }
+
+
+    /** Ask the worker pool for a complete computation. */
+    void  recompute  ()
+    {
+      Input_Version const  v  {chart_data.prices_version,  0};
+
+      if (! full.needs (v))    return;
+
+      shared_ptr <Price_Columns const>  snapshot;
+      {
+        lock_guard  l  {chart_data.prices_mutex};
+        snapshot = make_shared <Price_Columns const> (chart_data.prices);
+      }
+
+      full.request (v,
+                    [snapshot,  k = prototype]
+                    {  return  Series::over (*snapshot,  k);  },
+                    [this]
+                    {
+                      series = *full.get ();
+                      catch_up ();
+                      redraw_needed_.emit ();
+                    });
+    }
+
+
+    /** Bring \c series up to date with the front of the \c chart_data. */
+    void  catch_up  ()
+    {
+      lock_guard  l  {chart_data.prices_mutex};
+      series.extend (chart_data.prices);
+    }
+
+
+    /** The index of the first of our points which falls inside the time
+     *  range of the \a canvas. */
+    ptrdiff_t  first_visible  (Chart_Context const &canvas)  const
+    {
+      return  lower_bound (begin (series.time),  end (series.time),
+                           canvas.outline.start_time)
+                -  begin (series.time);
+    }
+
+
+    /** The point at or most recently before time \a t, or \c nullptr if
+     *  there is none. */
+    typename Kernel::Point const  *at  (Time_Point const &t)  const
+    {
+      auto const  i  {upper_bound (begin (series.time),  end (series.time),  t)};
+      return  i == begin (series.time)
+                ?  nullptr
+                :  &series.points [i - begin (series.time) - 1];
+    }
+
+
+    /** Draw a line on the \a canvas through the values which the \a value
+     *  function extracts from the visible points, leaving gaps where it
+     *  returns \c NO_VALUE. */
+    template <typename Value>
+    void  draw_line  (Chart_Context &canvas,
+                      Value  value,
+                      Colour const &colour,
+                      double const alpha = 1.0)  const
+    {
+      canvas.set_source_rgb (colour,  alpha);
+
+      bool  pen_down  {0};
+
+      for (auto i = first_visible (canvas);
+           i < (ptrdiff_t) series.time.size ();
+           ++i)
+        {
+          double const  v  {value (series.points [i])};
+
+          if (std::isnan (v))    {  pen_down = 0;  continue;  }
+
+          if (pen_down)    canvas.line_to ({series.time [i],  v});
+          else             canvas.move_to ({series.time [i],  v});
+
+          pen_down = 1;
+        }
+
+      canvas.cairo->stroke ();
+    }
+
+
+    /** Draw horizontal guide lines across a panel at each of the \a
+     *  levels, and put the \a title in its top-left corner. */
+    static void  draw_guides  (Chart_Context &panel,
+                               vector <double> const &levels,
+                               string const &title)
+    {
+      panel.set_source_rgb (Colour::CURSOR_TIDES,  0.5);
+
+      for (auto const  l  :  levels)
+        {
+          panel.move_to ({panel.outline.start_time,  l});
+          panel.line_to ({panel.outline.end_time,    l});
+        }
+
+      panel.cairo->stroke ();
+
+      panel.add (panel.text,
+                 title,
+                 Colour::COMPANY_NAME_TITLE,
+                 {panel.left_border + 2,  panel.top_border});
+    }
+
+
+    /** Label the value \a v at the \a cursor in a panel, if the cursor is
+     *  in the panel's time range. */
+    static void  label_cursor  (Chart_Context &panel,
+                                Time_Point const &cursor,
+                                double const v,
+                                Colour const &colour)
+    {
+      if (std::isnan (v)
+             ||  cursor < panel.outline.start_time
+             ||  cursor > panel.outline.end_time)
+        return;
+
+      ostringstream  hold;
+      hold << setprecision (3) << v;
+
+      panel.add (panel.text,  hold.str (),  colour,
+                 {panel.x (cursor) + 4,  panel.y (v) - 6});
+    }
+
+
+  public:
+
+    /** Have our complete computations timed. */
+    void  instrument  (shared_ptr <Stage_Timer> const &timer)  override
+    {  full.time_with (timer,  name () + " compute");  }
+
+    /** Return our signal so that the application can connect and act when
+     *  we need a re-draw to take place. */
+    sigc::signal <void> &signal_redraw_needed ()  override
+    {  return redraw_needed_;  }
+
+  };  /* End of class Streaming_Analyzer. */
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+#endif  /* Undefined DMBCS__TRADER_DESK__STREAMING_ANALYZER__H. */
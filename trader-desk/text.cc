@@ -32,17 +32,22 @@ namespace DMBCS::Trader_Desk {
 
 
 
+  /* The horizontal gap which must be left between items on the same
+   * line. */
+  static double const  PAD  {6.0};
+
+
+
   static double boundary_stress (Text::Item const &i,
+                                 Text::Place const &p,
                                  Text::Boundary const &b,
                                  double const &critical)
   {
     double const ret
-            = i.size.y * (clamp (i.placement.x + i.size.x - b.right,
-                                 0.0, i.size.x)
-                           + clamp (b.left - i.placement.x, 0.0, i.size.x))
-            + i.size.x * (clamp (b.top - i.placement.y, 0.0, i.size.y)
-                        + clamp (i.placement.y + i.size.y - b.bottom,
-                                 0.0, i.size.y));
+            = i.size.y * (clamp (p.x + i.size.x - b.right, 0.0, i.size.x)
+                           + clamp (b.left - p.x, 0.0, i.size.x))
+            + i.size.x * (clamp (b.top - p.y, 0.0, i.size.y)
+                        + clamp (p.y + i.size.y - b.bottom, 0.0, i.size.y));
 
     return  ret > -numeric_limits<double>::min () ? 2 * ret + critical
                                                   : 0.0;
@@ -50,23 +55,23 @@ namespace DMBCS::Trader_Desk {
         
 
 
-  static float overlap (Text::Item const &a, Text::Item const &b,
-                        float const &critical_value)
+  /* The penalty for item \a a, were it at \a p, overlapping item \a b
+   * where it is. */
+  static double overlap (Text::Item const &a,
+                         Text::Place const &p,
+                         Text::Item const &b,
+                         double const &critical_value)
   {
-    static double const pad = 6.0;
-
-    if (a.placement.x >= b.placement.x + b.size.x + pad
-        ||  a.placement.x + a.size.x  <=  b.placement.x - pad
-        ||  a.placement.y >= b.placement.y + b.size.y
-        ||  a.placement.y + a.size.y  <=  b.placement.y)
+    if (p.x >= b.placement.x + b.size.x + PAD
+        ||  p.x + a.size.x  <=  b.placement.x - PAD
+        ||  p.y >= b.placement.y + b.size.y
+        ||  p.y + a.size.y  <=  b.placement.y)
       return 0;
 
-    auto const right  = min (a.placement.x + a.size.x,
-                             b.placement.x + b.size.x) + pad;
-    auto const left   = max (a.placement.x, b.placement.x) - pad;
-    auto const top    = max (a.placement.y, b.placement.y);
-    auto const bottom = min (a.placement.y + a.size.y,
-                             b.placement.y + b.size.y);
+    auto const right  = min (p.x + a.size.x,  b.placement.x + b.size.x) + PAD;
+    auto const left   = max (p.x,  b.placement.x) - PAD;
+    auto const top    = max (p.y,  b.placement.y);
+    auto const bottom = min (p.y + a.size.y,  b.placement.y + b.size.y);
 
     return critical_value + sqrt ((right - left) * (bottom - top));
   }
@@ -79,10 +84,10 @@ namespace DMBCS::Trader_Desk {
   }
 
 
-  inline double tension (Text::Item const &i)
+  inline double tension (Text::Item const &i,  Text::Place const &p)
   {
-    return squash (hypot (i.native_position.x - i.placement.x,
-                          i.native_position.y - i.placement.y));
+    return squash (hypot (i.native_position.x - p.x,
+                          i.native_position.y - p.y));
   }
 
 
@@ -94,18 +99,129 @@ namespace DMBCS::Trader_Desk {
 
 
 
-  double Text::compute_tension (double const &critical_value,
-                                Boundary const &boundary) const
+  /* A uniform grid of buckets laid over the boundary, each holding the
+   * indices of the items whose boxes (widened by the \c PAD) touch it, so
+   * that the items which might overlap any box can be found by looking in
+   * only the few buckets the box touches.  Items beyond the edges of the
+   * grid are put in the buckets at the edges. */
+
+  struct Label_Grid
+  {
+    double  left,  top;
+    double  cell_width  {1.0},  cell_height  {1.0};
+    int     columns,  rows;
+
+    vector <vector <size_t>>  buckets;
+
+    /* Marks for removing duplicates from the results of \c near. */
+    vector <size_t>  seen;
+    size_t  visit  {0};
+
+
+    Label_Grid (vector <Text::Item> const &items,  Text::Boundary const &b)
+      :  left {b.left},  top {b.top},  seen (items.size (),  0)
+    {
+      /* With buckets at least as big as the biggest item, no item
+       * touches more than four of them. */
+      for (auto const &i : items)
+        {
+          cell_width   =  max (cell_width,   i.size.x + 2 * PAD);
+          cell_height  =  max (cell_height,  i.size.y);
+        }
+
+      columns  =  int (clamp (ceil ((b.right - b.left) / cell_width),   1, 256));
+      rows     =  int (clamp (ceil ((b.bottom - b.top) / cell_height),  1, 256));
+
+      buckets.resize (columns * rows);
+
+      for (size_t i = 0;  i < items.size ();  ++i)
+        insert (i,  items [i]);
+    }
+
+
+    int column (double const x) const
+    {  return int (clamp (floor ((x - left) / cell_width),  0,  columns - 1));  }
+
+    int row (double const y) const
+    {  return int (clamp (floor ((y - top) / cell_height),  0,  rows - 1));  }
+
+
+    /* Call \a f on every bucket which the box from (\a x0, \a y0) to (\a
+     * x1, \a y1) touches. */
+    template <typename F>
+    void for_buckets (double const x0,  double const y0,
+                      double const x1,  double const y1,
+                      F  f)
+    {
+      for (auto r = row (y0);  r <= row (y1);  ++r)
+        for (auto c = column (x0);  c <= column (x1);  ++c)
+          f (buckets [r * columns + c]);
+    }
+
+
+    void insert (size_t const i,  Text::Item const &item)
+    {
+      for_buckets (item.placement.x - PAD,  item.placement.y,
+                   item.placement.x + item.size.x + PAD,
+                   item.placement.y + item.size.y,
+                   [i] (vector <size_t> &b)  {  b.push_back (i);  });
+    }
+
+
+    void remove (size_t const i,  Text::Item const &item)
+    {
+      for_buckets (item.placement.x - PAD,  item.placement.y,
+                   item.placement.x + item.size.x + PAD,
+                   item.placement.y + item.size.y,
+                   [i] (vector <size_t> &b)
+                   {  b.erase (find (begin (b),  end (b),  i));  });
+    }
+
+
+    /* Put into \a out the indices of all the items, other than \a i,
+     * which might overlap the box from (\a x0, \a y0) to (\a x1, \a
+     * y1). */
+    void near (size_t const i,
+               double const x0,  double const y0,
+               double const x1,  double const y1,
+               vector <size_t> &out)
+    {
+      ++visit;
+      out.clear ();
+
+      for_buckets (x0,  y0,  x1,  y1,
+                   [this,  i,  &out] (vector <size_t> const &b)
+                   {
+                     for (auto const j : b)
+                       if (j != i  &&  seen [j] != visit)
+                         {
+                           seen [j] = visit;
+                           out.push_back (j);
+                         }
+                   });
+    }
+
+  };  /* End of class Label_Grid. */
+
+
+
+  /* The part of the total tension which depends on where item \a i is,
+   * were it at \a p: its displacement, its boundary stress and its
+   * overlaps with any of the \a neighbours. */
+  static double item_tension (vector <Text::Item> const &items,
+                              size_t const i,
+                              Text::Place const &p,
+                              vector <size_t> const &neighbours,
+                              double const &critical_value,
+                              Text::Boundary const &boundary)
   {
-    double acc {0.0};
+    auto const &item  {items [i]};
 
-    for (auto a = begin (items); a != end (items); ++a)
-      {
-        for (auto b = a + 1; b != end (items); ++b)
-          acc +=  overlap (*a, *b, critical_value);
+    double  acc  {tension (item, p)
+                    +  boundary_stress (item, p, boundary, critical_value)};
 
-        acc +=  tension (*a)  +  boundary_stress (*a, boundary, critical_value);
-      }
+    for (auto const j : neighbours)
+      acc += overlap (item, p, items [j], critical_value);
 
     return acc;
   }
@@ -118,69 +234,101 @@ namespace DMBCS::Trader_Desk {
   {
     if (items.empty ())   return;
 
+    double const acceptable_limit = items.size ();
+
+    vector <size_t>  neighbours;
+
     for (; shift_size > shift_limit; shift_size /= 2.0)
       {
         for (auto &i : items)
           bring_inside (i, boundary);
 
-        auto const acceptable_limit = items.size ();
-        auto initial_tension = compute_tension (acceptable_limit, boundary);
+        Label_Grid  grid  {items,  boundary};
+
+        /* The total tension: every item's own part, and every overlap
+         * (which is counted in the parts of both items). */
+        double  total_tension  {0.0};
+
+        for (size_t i = 0;  i < items.size ();  ++i)
+          {
+            auto const &p  {items [i].placement};
+
+            grid.near (i,  p.x,  p.y,
+                       p.x + items [i].size.x,  p.y + items [i].size.y,
+                       neighbours);
+
+            double  overlaps  {0.0};
+            for (auto const j : neighbours)
+              overlaps += overlap (items [i], p, items [j], acceptable_limit);
+
+            total_tension += tension (items [i], p)
+                               +  boundary_stress (items [i], p, boundary,
+                                                   acceptable_limit)
+                               +  overlaps / 2;
+          }
+
+        if (total_tension < acceptable_limit)    continue;
+
+        /* Each size of shift has a budget of its own, so that the coarse
+         * ones cannot use up all the moves and leave the items without
+         * the final, fine, adjustments. */
+        auto  budget  {MOVE_BUDGET};
 
-        for (;;)
+        /* Only the item which moves changes the tension, so each trial
+         * move is scored by the change in that item's part. */
+        static Place const  moves []  {{1, 0},  {-1, 0},  {0, 1},  {0, -1}};
+
+        while (budget >= size (moves) * items.size ())
           {
-            Item *hot_item {nullptr};
-            enum { up, down, left, right} best_direction {up};
-            double best_tension = numeric_limits<double>::max ();
-
-            {
-              auto test = [this, acceptable_limit, &best_tension,
-                           &hot_item, &best_direction, boundary]
-                                    (Item &i,
-                                     Place const &shift,
-                                     decltype (best_direction) const &direction)
-                    {
-                      i.placement += shift;
-                      auto const tension = compute_tension (acceptable_limit,
-                                                            boundary);
-                      if (tension < best_tension)
-                        {
-                          hot_item = &i;
-                          best_direction = direction;
-                          best_tension = tension;
-                        }
-                    };
-
-              for (auto &i : items)
-                {
-                  test  (i,  Place {shift_size, 0},           right);
-                  test  (i,  Place {- 2 * shift_size, 0},     left );
-                  test  (i,  Place {shift_size, shift_size},  up   );
-                  test  (i,  Place {0, - 2 * shift_size},     down );
-
-                  i.placement  +=  Place {0, shift_size};
-                }
-            }
-            
-
-            if (! hot_item)  return;
-
-
-            switch (best_direction)
+            budget -= size (moves) * items.size ();
+
+            size_t  hot_item  {items.size ()};
+            Place   best_move;
+            double  best_change  {0.0};
+
+            for (size_t i = 0;  i < items.size ();  ++i)
               {
-              case up:    hot_item->placement += {0, shift_size};   break;
-              case down:  hot_item->placement += {0, -shift_size};  break;
-              case left:  hot_item->placement += {-shift_size, 0};  break;
-              case right: hot_item->placement += {shift_size, 0};   break;
+                auto const &item  {items [i]};
+                auto const &p     {item.placement};
+
+                grid.near (i,  p.x - shift_size,  p.y - shift_size,
+                           p.x + item.size.x + shift_size,
+                           p.y + item.size.y + shift_size,
+                           neighbours);
+
+                auto const  here  {item_tension (items, i, p, neighbours,
+                                                 acceptable_limit, boundary)};
+
+                for (auto const &m : moves)
+                  {
+                    Place const  q  {p.x + m.x * shift_size,
+                                     p.y + m.y * shift_size};
+
+                    auto const  change
+                          {item_tension (items, i, q, neighbours,
+                                         acceptable_limit, boundary)
+                             -  here};
+
+                    if (change < best_change)
+                      {
+                        hot_item = i;
+                        best_move = q;
+                        best_change = change;
+                      }
+                  }
               }
 
-            /* Has the tension decreased?  If not we should give up,
+            /* If no move makes things better, we should give up,
              * regardless of the acceptable limit. */
-
-            if (initial_tension - best_tension  
-                     <  numeric_limits<decltype(initial_tension)>::epsilon ())
+            if (hot_item == items.size ()
+                  ||  -best_change < numeric_limits<double>::epsilon ())
               break;
 
-            if ((initial_tension = best_tension)  <  acceptable_limit)
+            grid.remove (hot_item,  items [hot_item]);
+            items [hot_item].placement = best_move;
+            grid.insert (hot_item,  items [hot_item]);
+
+            if ((total_tension += best_change)  <  acceptable_limit)
               break;
 
           }  /* Loop back for further improvements. */
@@ -55,7 +55,16 @@ namespace DMBCS::Trader_Desk {
      *  the itemsʼ displacement from their starting values--we want to get
      *  rid of the overlaps at the expense of the displacements.  The
      *  exercise continues until the overlaps are eliminated and delta is
-     *  not more than the size of a pixel. */
+     *  not more than the size of a pixel.
+     *
+     *  Only the item which moves changes the score, and then only by its
+     *  own displacement and its overlaps with its near neighbours, which
+     *  are found through a grid of buckets laid over the screen; so each
+     *  trial move costs time proportional to the number of neighbours
+     *  only.  No more than \c MOVE_BUDGET trial moves are made at each
+     *  size of shift, so that even a dense crowd of items is laid out in
+     *  bounded time; the result depends only on the items, in the order
+     *  they were added. */
 
     struct Text
     {
@@ -128,13 +137,9 @@ namespace DMBCS::Trader_Desk {
       vector<Item> items;
 
 
-      /* Compute a score, to be minimized, for the current arrangement of
-       * text \c Item \C placements. */
-      double compute_tension (double const &critical_value,
-                              Boundary const &boundary) const;
-
-
-      /* Randomly move some items of text around. */
+      /* Move the items of text around to reduce the score, in steps
+       * starting at \a shift_size and halving until they are no more than
+       * \a shift_limit. */
       void shuffle (double shift_size,
                     double const &shift_limit,
                     Boundary const &boundary);
@@ -142,6 +147,12 @@ namespace DMBCS::Trader_Desk {
 
     public:
 
+      /** The most trial moves of single items that \c arrange will make
+       *  at each size of shift; beyond this the items are moved on to the
+       *  next, smaller, size. */
+      static constexpr size_t const MOVE_BUDGET {40000};
+
+
       /** Return a vector of items whose \c placement's indicate the
        *  optimal positions to render each text item. */
       vector<Item> const &arrange (Boundary const &b)
@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <trader-desk/thumbnail-atlas.h>
+#include <trader-desk/chart-context.h>
+
+
+/** \file
+ *
+ *  Implementation of the \c Thumbnail_Atlas class. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  Thumbnail_Atlas::Picture::Picture (Chart_Data &data)
+    :  prices {data.prices.market_close_time}
+  {
+    /* The update threads change these along with the prices, so all are
+     * copied under the one lock. */
+    lock_guard  l  {data.prices_mutex};
+
+    company_name  =  data.company_name;
+    unaccurate    =  data.unaccurate;
+    extremes      =  data.extremes;
+
+    /* A thumbnail shows only a short stretch of a long history, so there
+     * is no point copying any more than that. */
+    auto  i  {find_if (begin (data.prices),  end (data.prices),
+                       [this] (Event const &e)
+                       {  return  e.time < extremes.start_time;  })};
+
+    if (i != end (data.prices))    ++i;
+
+    prices.assign (begin (data.prices),  i);
+  }
+
+
+
+  Thumbnail_Atlas::Picture::Picture (string const &name)
+    :  company_name {name},
+       unaccurate {1},
+       prices {chrono::seconds {0}}
+  {}
+
+
+
+  Cairo::RefPtr <Cairo::ImageSurface>
+  Thumbnail_Atlas::render  (Picture const &picture,
+                            int const width,
+                            int const height,
+                            double const scale)
+  {
+    auto const  surface  {Chart_Context::scaled_image (width,  height,  scale)};
+
+    /* This follows the lay-out and drawing of a Chart with only the
+     * COMPANY_NAME feature. */
+    Chart_Context  canvas;
+
+    canvas.width          =  width;
+    canvas.height         =  height;
+    canvas.left_border    =  4;
+    canvas.bottom_border  =  4;
+    canvas.top_border     =  4;
+    canvas.right_border   =  4;
+
+    canvas.cairo  =  Cairo::Context::create (surface);
+    canvas.pango  =  Pango::Layout::create (canvas.cairo);
+    canvas.pango  ->  set_font_description (Pango::FontDescription ("Sans 7"));
+
+    canvas.outline  =  picture.extremes;
+
+    double const space  =  0.05  *  (canvas.outline.max_value
+                                             - canvas.outline.min_value);
+
+    canvas.outline.min_value -= space;
+    canvas.outline.max_value += space;
+
+    canvas.cairo->set_line_width (1.0);
+
+    canvas.set_source_rgb (picture.unaccurate ? Colour::NO_DATA_REGION
+                                              : Colour::CHART_BACKGROUND);
+    canvas.cairo->paint ();
+
+    auto const  r  {picture.prices.empty ()  ?  canvas.outline.end_time
+                                             :  picture.prices.back ().time};
+
+    if (r > canvas.outline.start_time)
+      {
+        canvas.set_source_rgb (Colour::NO_DATA_REGION);
+        canvas.move_to ({canvas.outline.start_time, canvas.outline.min_value});
+        canvas.line_to ({canvas.outline.start_time, canvas.outline.max_value});
+        canvas.line_to ({r, canvas.outline.max_value});
+        canvas.line_to ({r, canvas.outline.min_value});
+        canvas.cairo->fill ();
+      }
+
+    if (picture.prices.empty ())
+      {
+        canvas.add (canvas.text,
+                    picture.company_name,
+                    Colour::COMPANY_NAME_TITLE,
+                    {canvas.left_border,  canvas.top_border});
+        canvas.render (canvas.text);
+        return surface;
+      }
+
+    auto const &extremes  {picture.extremes};
+
+    canvas.set_source_rgb (Colour::PRICE_AXIS);
+    canvas.move_to ({extremes.start_time, canvas.outline.max_value});
+    canvas.line_to ({extremes.start_time, canvas.outline.min_value});
+    canvas.cairo->stroke ();
+
+    canvas.set_source_rgb (Colour::TIME_AXIS);
+    canvas.move_to ({extremes.start_time, canvas.outline.min_value});
+    canvas.line_to ({extremes.end_time, canvas.outline.min_value});
+    canvas.cairo->stroke ();
+
+    canvas.draw_time_series (picture.prices,  Colour::PRICE_GRAPH,  1.0);
+
+    canvas.add (canvas.text,
+                picture.company_name,
+                Colour::COMPANY_NAME_TITLE,
+                canvas.x ({extremes.start_time,  canvas.outline.max_value}));
+
+    canvas.render (canvas.text);
+
+    return surface;
+  }
+
+
+
+  void  Thumbnail_Atlas::arrange  (size_t const n,
+                                   int const columns_,
+                                   int const cell_width_,
+                                   int const cell_height_,
+                                   double const scale_)
+  {
+    if (n == cells.size ()  &&  columns_ == columns
+            &&  cell_width_ == cell_width  &&  cell_height_ == cell_height
+            &&  scale_ == scale)
+      return;
+
+    cells.resize (n);
+
+    columns      =  max (1,  columns_);
+    cell_width   =  cell_width_;
+    cell_height  =  cell_height_;
+    scale        =  scale_;
+
+    number_rows = 0;
+    ++geometry;
+  }
+
+
+
+  void  Thumbnail_Atlas::hold_rows  (int const first,  int const count)
+  {
+    if (first == first_row  &&  count == number_rows  &&  atlas)    return;
+
+    first_row    =  first;
+    number_rows  =  count;
+
+    atlas = Chart_Context::scaled_image (max (1,  columns * cell_width),
+                                         max (1,  count * cell_height),
+                                         scale);
+
+    /* The new image is empty, so everything has to be copied into it
+     * again. */
+    size_t const  keep_begin  = size_t (max (0,  first - count)) * columns;
+    size_t const  keep_end    = size_t (first + 2 * count) * columns;
+
+    for (size_t i = 0;  i < cells.size ();  ++i)
+      if (i < keep_begin  ||  i >= keep_end)    cells [i].reset ();
+      else if (cells [i])                       cells [i]->packed = {};
+  }
+
+
+
+  int  Thumbnail_Atlas::cell_at  (double const x,  double const y)  const
+  {
+    if (cell_width <= 0  ||  cell_height <= 0  ||  x < 0  ||  y < 0)
+      return -1;
+
+    int const  column  = int (x) / cell_width;
+
+    if (column >= columns)    return -1;
+
+    auto const  i  {column  +  columns * (int (y) / cell_height)};
+
+    return  i < int (cells.size ())  ?  i  :  -1;
+  }
+
+
+
+  void  Thumbnail_Atlas::update  (size_t const i,
+                                  Chart_Data &data,
+                                  function <void ()> done)
+  {
+    int const  row  = int (i) / columns;
+
+    if (cell_width <= 0  ||  cell_height <= 0
+            ||  row < first_row  ||  row >= first_row + number_rows)
+      return;
+
+    if (! cells [i])    cells [i] = make_unique <Cell> ();
+
+    auto &cell  {*cells [i]};
+
+    /* The range shown by a thumbnail only moves when its prices do, so
+     * apart from the geometry the only other thing which can change the
+     * picture is the accuracy flag. */
+    Input_Version const  v  {data.prices_version,
+                             2 * geometry  +  data.unaccurate};
+
+    if (cell.rendering.needs (v))
+      {
+        auto const  picture  {make_shared <Picture const> (data)};
+
+        cell.rendering.request (v,
+                                [picture,  w = cell_width,  h = cell_height,
+                                 s = scale]
+                                {  return  render (*picture,  w,  h,  s);  },
+                                move (done));
+      }
+
+    /* Until the up-to-date picture arrives, an older one (of the right
+     * size) is better than none. */
+    auto const  r  {cell.rendering.get ()};
+
+    if (! r
+          ||  cell.rendering.version () == cell.packed
+          ||  cell.rendering.version ().parameters / 2  !=  geometry)
+      return;
+
+    pack (i,  *r);
+
+    cell.packed = cell.rendering.version ();
+  }
+
+
+
+  void  Thumbnail_Atlas::placeholder  (size_t const i,
+                                       string const &company_name)
+  {
+    int const  row  = int (i) / columns;
+
+    if (cell_width <= 0  ||  cell_height <= 0
+            ||  row < first_row  ||  row >= first_row + number_rows)
+      return;
+
+    if (! cells [i])    cells [i] = make_unique <Cell> ();
+
+    /* No real rendering is ever tagged with this, as prices versions
+     * start at one. */
+    Input_Version const  v  {0,  2 * geometry + 1};
+
+    if (cells [i]->packed == v)    return;
+
+    pack (i,  render (Picture {company_name},
+                      cell_width,  cell_height,  scale));
+
+    cells [i]->packed = v;
+  }
+
+
+
+  void  Thumbnail_Atlas::pack  (size_t const i,
+                                Cairo::RefPtr <Cairo::ImageSurface> const &r)
+  {
+    int const  x  = int (i) % columns  *  cell_width;
+    int const  y  = (int (i) / columns - first_row)  *  cell_height;
+
+    auto const  cairo  {Cairo::Context::create (atlas)};
+    cairo->set_operator (Cairo::OPERATOR_SOURCE);
+    cairo->set_source (r,  x,  y);
+    cairo->rectangle (x,  y,  cell_width,  cell_height);
+    cairo->fill ();
+  }
+
+
+
+  void  Thumbnail_Atlas::paint  (Cairo::RefPtr <Cairo::Context> const &cairo)
+                                                                         const
+  {
+    if (! atlas)    return;
+
+    cairo->set_source (atlas,  0.0,  double (first_row * cell_height));
+    cairo->paint ();
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#ifndef DMBCS__TRADER_DESK__THUMBNAIL_ATLAS__H
+#define DMBCS__TRADER_DESK__THUMBNAIL_ATLAS__H
+
+
+#include <trader-desk/chart-data.h>
+#include <trader-desk/worker-pool.h>
+#include <cairomm/cairomm.h>
+
+
+/** \file
+ *
+ *  Declaration of the \c Thumbnail_Atlas class. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  /** Pictures of many charts laid out in a grid, of which the rows in
+   *  view are held in a single image which can be put on the screen with
+   *  one paint.  Each picture is rendered
+   *  on the worker pool onto a surface of its own, and copied into place
+   *  in the GTK thread when it is ready; it is rendered again only when
+   *  the data it shows, or the geometry of the grid, changes.
+   *
+   *  All methods are to be called in the GTK thread, except \c render
+   *  which may be called anywhere. */
+
+  class Thumbnail_Atlas
+  {
+  public:
+
+    /** Everything that a thumbnail shows, copied out of a \c Chart_Data
+     *  so that it can be drawn away from the GTK thread. */
+    struct Picture
+    {
+      string              company_name;
+      bool                unaccurate;
+      Time_Series::Range  extremes;
+
+      /** The events which fall inside the \c extremes, and the one
+       *  before, newest first. */
+      Time_Series         prices;
+
+      explicit Picture (Chart_Data &);
+
+      /** A picture with nothing but the \a company_name on a background
+       *  marked as unaccurate, to stand in while the data are loaded. */
+      explicit Picture (string const &company_name);
+    };
+
+
+    /** Draw the \a picture onto a new surface \a width by \a height
+     *  pixels, each of \a scale device pixels, just as a \c Chart of \c
+     *  Style::THUMB would draw it. */
+    static Cairo::RefPtr <Cairo::ImageSurface>  render  (Picture const &,
+                                                         int width,
+                                                         int height,
+                                                         double scale = 1.0);
+
+
+  private:
+
+    struct Cell
+    {
+      /** The latest rendering of this cell. */
+      Background_Result <Cairo::RefPtr <Cairo::ImageSurface>>  rendering;
+
+      /** The version of the rendering which has been copied into the \c
+       *  atlas. */
+      Input_Version  packed;
+    };
+
+    /** One for each cell, made when it is first updated. */
+    vector <unique_ptr <Cell>>  cells;
+
+    /** Copy the \a picture into the place of cell \a i in the \c atlas,
+     *  which must be in the rows we hold. */
+    void  pack  (size_t i,  Cairo::RefPtr <Cairo::ImageSurface> const &);
+
+    /** The pictures of the cells in the rows we hold, side by side. */
+    Cairo::RefPtr <Cairo::ImageSurface>  atlas;
+
+    int  columns  {0};
+    int  cell_width  {0},  cell_height  {0};
+
+    /** The number of device pixels to each pixel of a cell. */
+    double  scale  {1.0};
+
+    /** The rows of cells which the \c atlas holds. */
+    int  first_row  {0},  number_rows  {0};
+
+    /** Incremented whenever the geometry changes, so that every cell
+     *  needs rendering afresh. */
+    uint64_t  geometry  {0};
+
+
+  public:
+
+    /** Lay out \a n cells, \a columns_ to a row, each \a cell_width_ by
+     *  \a cell_height_ pixels, for a display with \a scale_ device pixels
+     *  to each of those.  If this differs from the last layout, all the
+     *  cells will be rendered again. */
+    void  arrange  (size_t n,  int columns_,  int cell_width_,  int cell_height_,
+                    double scale_ = 1.0);
+
+    /** Hold the pictures of the \a count rows of cells from row \a
+     *  first; only the cells in these may be updated or painted.  The
+     *  pictures already rendered are kept for the cells within \a count
+     *  rows either side, and so are not rendered again when they come
+     *  back; those further away are dropped. */
+    void  hold_rows  (int first,  int count);
+
+    /** Drop all the cells, and any renderings of them which are in
+     *  progress. */
+    void  clear  ()   {  cells.clear ();  columns = 0;  }
+
+    /** The index of the cell under the point (\a x, \a y), or -1 if there
+     *  is none. */
+    int  cell_at  (double x,  double y)  const;
+
+    /** Make sure that cell \a i will show the \a data: if its picture is
+     *  out of date, ask for it to be rendered again, and call \a done
+     *  when that is finished; if a rendering has finished since the last
+     *  call, copy it into place. */
+    void  update  (size_t i,  Chart_Data &data,  function <void ()> done);
+
+    /** Show a picture with only the \a company_name in cell \a i, until
+     *  it is next \c update'd.  This is drawn straight away, in the GTK
+     *  thread, as it costs hardly more than the copy. */
+    void  placeholder  (size_t i,  string const &company_name);
+
+    /** Paint the rows we hold onto \a cairo, in their places in the whole
+     *  grid. */
+    void  paint  (Cairo::RefPtr <Cairo::Context> const &cairo)  const;
+
+  };  /* End of class Thumbnail_Atlas. */
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+#endif  /* Undefined DMBCS__TRADER_DESK__THUMBNAIL_ATLAS__H. */
@@ -19,6 +19,8 @@
 
 
 #include <trader-desk/time-series.h>
+#include <trader-desk/db.h>
+#include <trader-desk/kernels.h>
 #include <algorithm>
 #include <cmath>
 #include <limits>
@@ -234,58 +236,30 @@ namespace DMBCS::Trader_Desk {
     if (in.size () < 2)
       return in;
 
-    Time_Series ret {in.market_close_time};
-
-    auto const forward_window_size = window / 2;
-    auto const backward_window_size = window - forward_window_size;
-
+    /* Lay out the events which can contribute, oldest first, for the
+     * kernel. */
     auto const start_time = earliest - window;
 
-    /* These iterators run through _increasing_ dates. */
-    auto window_front = in.rbegin ();
-    while  (window_front->time  <  start_time   &&   window_front != in.rend ())
-      ++window_front;
-    auto window_back = window_front;
+    vector<Time_Point> time;
+    vector<double> price;
+    time.reserve (in.size ());
+    price.reserve (in.size ());
 
-    int count = 0;
-    double sum = 0.0;
-
-    for (;
-         window_front != in.rend ()
-           &&  window_front->time < window_back->time + forward_window_size;
-         ++ window_front)
-      {
-        sum += window_front->price;
-        ++count;
-      }
+    for (auto i = in.rbegin ();  i != in.rend ();  ++i)
+      if (i->time >= start_time)
+        {
+          time.push_back (i->time);
+          price.push_back (i->price);
+        }
 
-    ret.emplace_back (window_back->time,
-                      count > 0 ? sum / count : 0.0);
+    vector<double> mean (price.size ());
+    centred_moving_average (time, price, window, mean);
 
-    for (auto i = window_back + 1;  i != in.rend ();  ++i)
-      {
-        for (;
-             window_front != in.rend ()
-               &&  window_front->time < i->time + forward_window_size;
-             ++window_front)
-          {
-            sum += window_front->price;
-            ++ count;
-          }
-
-        for (;
-             window_back != window_front
-                     &&  window_back->time < i->time - backward_window_size;
-             ++window_back)
-          {
-            sum -= window_back->price;
-            -- count;
-          }
-
-        ret.emplace_back (i->time,  count > 0 ? sum / count : 0.0);
-      }
+    Time_Series ret {in.market_close_time};
+    ret.reserve (mean.size ());
 
-    reverse (std::begin (ret), std::end (ret));
+    for (auto i = mean.size ();  i > 0;  --i)
+      ret.emplace_back (time [i - 1],  mean [i - 1]);
 
     return ret;
   }
@@ -23,8 +23,8 @@
 
 
 #include <chrono>
+#include <ctime>
 #include <vector>
-#include <trader-desk/db.h>
 
 
 /** \file
@@ -38,6 +38,14 @@
 
 namespace DMBCS::Trader_Desk {
 
+
+  using namespace std;
+
+
+  /* This header is kept free of the database and graphics headers, so
+   * that the price arithmetic can be used without either. */
+  struct DB;
+
   
   /** All trades and closing prices are fixed to a \c Time_Point. */
   typedef  chrono::system_clock::time_point  Time_Point;
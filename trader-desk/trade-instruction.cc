@@ -73,7 +73,10 @@ namespace DMBCS::Trader_Desk {
                          chart_data.note_current_price (db,  value ()); });
 
     chart_data.changed_signal
-              .connect ([this] { chart_data_changed (); });
+              .connect ([this] (Chart_Data::Change const &c)
+                        { if (c.any (Chart_Data::Change::NEW_TAIL
+                                        | Chart_Data::Change::NEW_COMPANY))
+                              chart_data_changed (); });
   }
 
 
@@ -21,7 +21,11 @@
 #include  "auto-config.h"
 #include  "alpha-vantage--monitor.h"
 #include  "application.h"
+#include  "backtest.h"
+#include  "correlation.h"
+#include  "indicators.h"
 #include  "markets.h"
+#include  "screener.h"
 #include  "update-latest-prices.h"
 #include  "wizard.h"
 
@@ -38,7 +42,7 @@ namespace DMBCS::Trader_Desk {
 static void  grid_injector  (Chart_Grid &grid,
                              const Update_Latest_Prices::Data&  data)
   {
-    Chart *const  c  {grid.find_chart (data.company_seqid)};
+    auto const  c  {grid.find_chart (data.company_seqid)};
 
     if (c)    c->data.new_event ({chrono::system_clock::to_time_t (data.time),
                                   data.price});
@@ -61,8 +65,20 @@ struct  Window  :   Gtk::Window
 
     explicit  Window  (Preferences&&);
 
+    /** Set while an update of the latest data is in progress. */
+    atomic<bool>  latest_update_running  {0};
+
+    /** Shared with the update of the latest data in progress, if any; set
+     *  by \c destroy_application to tell it that the charts it was to
+     *  feed have gone. */
+    shared_ptr<atomic<bool>>  latest_update_cancelled;
+
     void update_latest_data ();
 
+    /** Tell the user that the data service has refused us, with the \a
+     *  message it gave, and offer them the preferences dialog. */
+    void  latest_data_error  (const string&  message);
+
     void  change_company_name  (Chart_Data&  chart_data,  const int&  seqid);
 
     void  create_application  (Preferences&&  P);
@@ -156,9 +172,11 @@ void  Window::change_company_name  (Chart_Data&  chart_data,  const int&  seqid)
 
         for (auto &a : app.market_grids)
             {
-                Chart *const  c  {a->find_chart (seqid)};
+                Chart *const  c  {a->open_chart (seqid)};
 
-                if (c)   {   chart_data.subsume  (&c->data);
+                /* The grid must keep the chart while we have its data. */
+                if (c)   {   a->selection  =  c;
+                             chart_data.subsume  (&c->data);
                              if (! db)  db  =  make_unique<DB> (app.user_prefs);
                              app . hand_analysis -> company_name
                                  . read_names  (*db,  a->market.seqid,  seqid);
@@ -205,6 +223,26 @@ void  Window::create_application  (Preferences&&  P)
                                              pgettext ("Menu", "_Market")));
       app.actions->add (Gtk::Action::create ("market-menu",
                                              pgettext ("Menu", "_Update")));
+      app.actions->add (Gtk::Action::create ("analysis-menu",
+                                             pgettext ("Menu", "_Analysis")));
+      app.actions->add (Gtk::Action::create ("screen-market",
+                                             pgettext ("Menu",
+                                                       "_Screen market")),
+                        Gtk::AccelKey {"<control><shift>s"},
+                        [this] { app.screen_market (); });
+      app.actions->add (Gtk::Action::create ("correlate-market",
+                                             pgettext ("Menu",
+                                                       "_Correlations")),
+                        [this] { app.correlate_market (); });
+      {
+        auto const  timings  {Gtk::ToggleAction::create
+                                    ("show-timings",
+                                     pgettext ("Menu", "Show _timings"))};
+        app.actions->add (timings,
+                          [this,  t = timings.operator-> ()]
+                          { app.hand_analysis->chart
+                                 .set_show_timings (t->get_active ()); });
+      }
       app.actions->add (Gtk::Action::create ("help-menu",
                                              pgettext ("Menu", "_Help")));
       app.actions->add (Gtk::Action::create ("about", 
@@ -306,6 +344,12 @@ void  Window::create_application  (Preferences&&  P)
                          "      <menuitem action=\"update-recent\"/>"
                          "      <menuitem action=\"update-closes\"/>"
                          "    </menu>"
+                         "    <menu action=\"analysis-menu\">"
+                         "      <menuitem action=\"screen-market\"/>"
+                         "      <menuitem action=\"correlate-market\"/>"
+                         "      <separator/>"
+                         "      <menuitem action=\"show-timings\"/>"
+                         "    </menu>"
                          "    <menu action=\"help-menu\">"
                          "      <menuitem action=\"about\"/>"
                          "    </menu>"
@@ -364,6 +408,10 @@ void  Window::create_application  (Preferences&&  P)
 
 void  Window::destroy_application  ()
     {
+      /* Nothing from an update still in progress may reach the charts
+       * after this. */
+      if (latest_update_cancelled)   *latest_update_cancelled  =  1;
+
       for (auto *const W  :  app.notebook.get_children ())
              app.notebook.remove (*W);
       app.market_grids.clear ();
@@ -378,56 +426,313 @@ void  Window::destroy_application  ()
 
 
 
-void Window::update_latest_data ()
-  try
-    {
-      DB  db  {app.user_prefs};
-      
-      if (app.notebook.get_current_page ()  ==  0)
-        {
-          Update_Latest_Prices::do_update  (db,
-                                            app.hand_analysis->chart.data,
-                                            app.user_prefs);
-          return;
-        }
-      
-      Chart_Grid *const  market
-               {app.market_grids [app.notebook.get_current_page ()-1].get ()};
-
-      Update_Latest_Prices::Work  update  {market->market};
-      
-      do_update (&update,
-                 db,
-                 app.user_prefs,
-                 [&db,  market]
-                    (const Update_Latest_Prices::Data&  data)  ->  void
-                     {   sql_injector   (db,      data);
-                         grid_injector  (*market, data);  });
-    }
-    catch (const Alpha_Vantage::Error&  E)
+void  Window::latest_data_error  (const string&  message)
       {
         Gtk::MessageDialog 
                  {*this,
                   gettext ("There seems to be a problem with the AlphaVantage "
                            "account, please check your settings on the "
                            "preferences panel.  The message from the "
-                           "server is:") + string {"\n\n‘"} + E.what () + "’",
+                           "server is:") + string {"\n\n‘"} + message + "’",
                   0,
                   Gtk::MESSAGE_ERROR}
            .run ();
         run_preferences_dialog  (*this);
       }
-    catch (Update_Closing_Prices::No_Connection const &)
-       {
-             Gtk::MessageDialog  {*this,
-                                  gettext ("No Internet Connection"),
-                                  0,
-                                  Gtk::MESSAGE_WARNING}
-                .run ();
-       }
+
+
+
+    /* The grid and chart pointers below are good only while the \c
+     * cancelled flag is not set; that is only ever set, and these are
+     * only ever called, in the GTK thread. */
+
+          struct  latest_datum_args
+                 {   Chart_Grid*  grid;   Update_Latest_Prices::Data  data;
+                     shared_ptr<atomic<bool>>  cancelled;   };
+
+extern "C"  int  inject_latest_datum  (const latest_datum_args *const  A)
+    {
+        if  (! *A->cancelled)   grid_injector  (*A->grid,  A->data);
+        delete  A;
+        return  0;
+    }
+
+
+
+          struct  latest_chart_args
+                 {   Chart_Data*  chart;  Update_Latest_Prices::Data  data;
+                     shared_ptr<atomic<bool>>  cancelled;   };
+
+extern "C"  int  inject_latest_chart_datum  (const latest_chart_args *const  A)
+    {
+        /* The user may have moved on to another company, or another
+         * database, while the quote was on its way. */
+        if  (! *A->cancelled
+               &&  A->chart->company_seqid  ==  A->data.company_seqid)
+              Update_Latest_Prices::chart_injector  (*A->chart,  A->data);
+        delete  A;
+        return  0;
+    }
+
+
+
+          struct  latest_error_args
+                 {   Window*  window;   string  message;   bool  account;   };
+
+extern "C"  int  latest_data_error_  (const latest_error_args *const  A)
+    {
+        if  (A->account)
+              A->window->latest_data_error  (A->message);
+        else
+              Gtk::MessageDialog  {*A->window,  A->message,  0,
+                                   Gtk::MESSAGE_WARNING}
+                 .run ();
+        A->window->latest_update_running  =  0;
+        delete  A;
+        return  0;
+    }
+
+
+
+void Window::update_latest_data ()
+    {
+      /* One update at a time: another would only compete with the first
+       * for the same rate-limited calls. */
+      if  (latest_update_running.exchange (1))   return;
+
+      Chart_Data *const  chart
+            {app.notebook.get_current_page () == 0
+                    ?  &app.hand_analysis->chart.data
+                    :  nullptr};
+
+      Chart_Grid *const  market
+            {chart  ?  nullptr
+                    :  app.market_grids [app.notebook.get_current_page () - 1]
+                          .get ()};
+
+      /* The application may be torn down and built again while we are
+       * at work, so the thread takes copies of what it needs from it, and
+       * only hands the chart and grid pointers back to the GTK thread. */
+      auto const  cancelled  {make_shared<atomic<bool>> (0)};
+      latest_update_cancelled  =  cancelled;
+
+      optional<Market_Meta_Data>  meta;
+      if (market)   meta  =  market->market;
+
+      std::thread
+        {[this,  chart,  market,  meta,  cancelled,  P = app.user_prefs,
+          company_seqid = chart ? chart->company_seqid : 0]
+         ()  mutable
+         {
+           latest_error_args  *error  {nullptr};
+
+           try
+             {
+               DB  db  {P};
+      
+               if (chart)
+                 Update_Latest_Prices::do_update
+                     (db,
+                      company_seqid,
+                      P,
+                      [chart,  cancelled]
+                         (const Update_Latest_Prices::Data&  data)
+                         {   gdk_threads_add_idle
+                                 ((int(*)(void*))  inject_latest_chart_datum,
+                                  new  latest_chart_args
+                                          {chart,  data,  cancelled});  });
+
+               else
+                 {
+                   Update_Latest_Prices::Work  update  {*meta};
+
+                   do_update
+                       (&update,
+                        db,
+                        P,
+                        [&db,  &update,  market,  cancelled]
+                           (const Update_Latest_Prices::Data&  data)
+                            {   if (*cancelled)
+                                  {   update.stop  =  1;   return;   }
+                                sql_injector   (db,  data);
+                                gdk_threads_add_idle
+                                  ((int(*)(void*))  inject_latest_datum,
+                                   new  latest_datum_args
+                                          {market,  data,  cancelled});
+                            });
+                 }
+             }
+           catch (const Alpha_Vantage::Error&  E)
+             {
+               error  =  new  latest_error_args  {this,  E.what (),  1};
+             }
+           catch (Update_Closing_Prices::No_Connection const &)
+             {
+               error  =  new  latest_error_args
+                                   {this,  gettext ("No Internet Connection"),
+                                    0};
+             }
+           catch (const Mysql::DB_Connection::Exception&  E)
+             {
+               error  =  new  latest_error_args  {this,  E.what (),  0};
+             }
+
+           /* Nobody wants to hear about the troubles of an update which
+            * has been called off. */
+           if  (error  &&  ! *cancelled)
+                 gdk_threads_add_idle
+                        ((int(*)(void*))  latest_data_error_,  error);
+           else
+             {
+                 delete  error;
+                 latest_update_running  =  0;
+             }
+         }}
+      .detach ();
+    }
     
 
 
+/* Print the latest MACD state of every company in the market with the
+ * given symbol, without bringing up any graphics. */
+static void  macd_report  (Preferences&&  P,  const string&  market_symbol)
+    {
+      DB  db  {P};
+
+      for (auto const &m  :  Markets {db})
+        if (m.second.world_data.symbol  ==  market_symbol)
+          for (auto const &c  :  market_macd  (db,
+                                               m.second,
+                                               chrono::hours {24 * 365}))
+            cout << c.company_name        << '\t'
+                 << c.latest.price        << '\t'
+                 << c.point.macd          << '\t'
+                 << c.point.signal        << '\t'
+                 << c.point.histogram     << '\n';
+    }
+
+
+
+/* Print a ranked table of the \a expressions (the default screen if
+ * there are none) for every company in the market with the given symbol,
+ * without bringing up any graphics. */
+static void  screen_report  (Preferences&&  P,
+                             const string&  market_symbol,
+                             vector <string> const &expressions)
+    {
+      vector <Screen_Expression>  E;
+      for (auto const &e  :  expressions)
+        E.push_back (Screen_Expression::parse (e));
+      if (E.empty ())    E = default_screen ();
+
+      DB  db  {P};
+
+      for (auto const &m  :  Markets {db})
+        if (m.second.world_data.symbol  ==  market_symbol)
+          {
+            auto const  screen  {screen_market  (db,  m.second,  E)};
+
+            cout << "company\tprice";
+            for (auto const &e  :  screen.expressions)
+              cout << '\t' << e.title ();
+            cout << '\n';
+
+            for (auto const &r  :  screen.rows)
+              {
+                cout << r.company_name << '\t' << r.latest.price;
+                for (auto const  v  :  r.values)    cout << '\t' << v;
+                cout << '\n';
+              }
+          }
+    }
+
+
+
+/* The value of a command-line argument which must be a positive whole
+ * number, or zero if the \a text is anything else. */
+static unsigned long  positive_integer  (const string&  text)
+    {
+      if (text.empty ()
+            ||  text.find_first_not_of ("0123456789")  !=  string::npos)
+        return 0;
+
+      try                              {  return  stoul (text);  }
+      catch (const out_of_range&)      {  return  0;  }
+    }
+
+
+
+/* Print the \a count most strongly correlated pairs of companies in the
+ * market with the given symbol, over the last year, without bringing up
+ * any graphics. */
+static void  correlation_report  (Preferences&&  P,
+                                  const string&  market_symbol,
+                                  size_t const  count)
+    {
+      DB  db  {P};
+      Analysis_Cache  cache  {1};
+
+      for (auto const &m  :  Markets {db})
+        if (m.second.world_data.symbol  ==  market_symbol)
+          {
+            auto const  matrix  {correlate_market  (db,  m.second,
+                                                    chrono::hours {24 * 365},
+                                                    0,  cache)};
+
+            for (auto const &p  :  matrix->strongest (count))
+              cout << matrix->name [p.a]                   << '\t'
+                   << matrix->name [p.b]                   << '\t'
+                   << p.correlation                        << '\t'
+                   << matrix->covariance (p.a,  p.b)       << '\n';
+          }
+    }
+
+
+
+/* Replay the last ten years of closing prices of every company in the
+ * market with the given symbol through each of the \a strategies (or the
+ * default ones if there are none), trading \a number_shares at a time
+ * with the costs in the preferences, and print the market-wide results,
+ * without bringing up any graphics. */
+static void  backtest_report  (Preferences&&  P,
+                               const string&  market_symbol,
+                               unsigned const  number_shares,
+                               vector <string> const &strategies)
+    {
+      vector <Strategy>  S;
+      for (auto const &s  :  strategies)
+        S.push_back (Strategy::parse (s));
+      if (S.empty ())    S = default_strategies ();
+
+      DB  db  {P};
+
+      for (auto const &m  :  Markets {db})
+        if (m.second.world_data.symbol  ==  market_symbol)
+          {
+            Backtest const  B  {Market_History::from_database
+                                      (db,  m.second,
+                                       chrono::system_clock::now (),
+                                       chrono::hours {24 * 365 * 10})};
+
+            auto const  results  {B.sweep (S,  number_shares,
+                                           {P.trade_cost_offset,
+                                            P.trade_cost_factor})};
+
+            /* Money is shown in pounds, as on the charts. */
+            cout << "strategy\tprofit\tmax_drawdown\tturnover\tcosts"
+                                                            "\ttrades\n";
+            for (size_t i = 0;  i < S.size ();  ++i)
+              cout << S [i].title ()                   << '\t'
+                   << results [i].profit / 100.0       << '\t'
+                   << results [i].max_drawdown / 100.0 << '\t'
+                   << results [i].turnover / 100.0     << '\t'
+                   << results [i].costs / 100.0        << '\t'
+                   << results [i].trades               << '\n';
+          }
+    }
+
+
+
 Window::Window  (Preferences&&  P)  :  app {std::move (P)}
     {
       signal_map_event ()
@@ -453,25 +758,43 @@ try
     /*  Needed for Alpha_Vantage. */
     curlpp::Cleanup curl_lifetime;
 
+    namespace TD  =  DMBCS::Trader_Desk;
+
     std::string  config_file;
 
-    if (argc > 1)
-      {
-        using std::cout;
+    /* The index in argv of the option which says what we are to do; the
+     * configuration file, if given, comes before it. */
+    int  mode  {1};
 
-        if (argv [1] == std::string {"--config"}
-                ||    argv [1] == std::string {"-c"})
+    if (argc > 1
+          &&  (argv [1] == std::string {"--config"}
+                  ||    argv [1] == std::string {"-c"}))
+      {
+        if  (argc < 3)
           {
-            if  (argc < 3)
-              {
-                std::cerr << PACKAGE_STRING
-                          << "Error: -c option requires an argument.\n";
-                exit (1);
-              }
-            config_file  =  argv [2];
+            std::cerr << PACKAGE_STRING
+                      << "Error: -c option requires an argument.\n";
+            exit (1);
           }
+        config_file  =  argv [2];
+        mode  =  3;
+      }
+
+    auto const  preferences  {[&config_file]
+                              {  return  config_file.empty ()
+                                   ?  TD::Preferences::from_default_file ()
+                                   :  TD::Preferences::from_file
+                                                            (config_file);  }};
+
+    if (argc > mode)
+      {
+        using std::cout;
+
+        /* The arguments of the option. */
+        char **const  args  {argv + mode + 1};
+        int const  n_args  {argc - mode - 1};
 
-        else if (argv [1] == std::string ("--version"))
+        if (argv [mode] == std::string ("--version"))
           {
             cout << PACKAGE_STRING << '\n';
             cout << gettext ("Copyright (C) 2017, 2020  Dale Mellor") << "\n\n"
@@ -483,9 +806,102 @@ try
                                                                   "by law.\n");
             exit (0);
           }
-        else if (argv [1] == std::string ("--help"))
+        else if (argv [mode] == std::string ("--macd"))
+          {
+            if  (n_args < 1)
+              {
+                std::cerr << PACKAGE_STRING
+                          << "Error: --macd option requires an argument.\n";
+                exit (1);
+              }
+            TD::macd_report  (preferences (),  args [0]);
+            exit (0);
+          }
+        else if (argv [mode] == std::string ("--screen"))
+          {
+            if  (n_args < 1)
+              {
+                std::cerr << PACKAGE_STRING
+                          << "Error: --screen option requires an argument.\n";
+                exit (1);
+              }
+            TD::screen_report  (preferences (),
+                                args [0],
+                                {args + 1,  argv + argc});
+            exit (0);
+          }
+        else if (argv [mode] == std::string ("--correlation"))
           {
-            cout << gettext ("usage") << ": trader-desk [options]\n";
+            if  (n_args < 1)
+              {
+                std::cerr << PACKAGE_STRING
+                          << "Error: --correlation option requires an "
+                                                               "argument.\n";
+                exit (1);
+              }
+            auto const  count  {n_args > 1  ?  TD::positive_integer (args [1])
+                                            :  50};
+            if  (count == 0)
+              {
+                std::cerr << PACKAGE_STRING
+                          << "Error: --correlation COUNT must be a positive "
+                                                              "integer.\n";
+                exit (1);
+              }
+            TD::correlation_report  (preferences (),  args [0],  count);
+            exit (0);
+          }
+        else if (argv [mode] == std::string ("--backtest"))
+          {
+            if  (n_args < 2)
+              {
+                std::cerr << PACKAGE_STRING
+                          << "Error: --backtest option requires two "
+                                                              "arguments.\n";
+                exit (1);
+              }
+            auto const  shares  {TD::positive_integer (args [1])};
+            if  (shares == 0
+                   ||  shares > std::numeric_limits <unsigned>::max ())
+              {
+                std::cerr << PACKAGE_STRING
+                          << "Error: --backtest SHARES must be a positive "
+                                                              "integer.\n";
+                exit (1);
+              }
+            TD::backtest_report  (preferences (),
+                                  args [0],
+                                  shares,
+                                  {args + 2,  argv + argc});
+            exit (0);
+          }
+        else if (argv [mode] == std::string ("--help"))
+          {
+            cout << gettext ("usage") << ": trader-desk [-c FILE] [option]\n";
+            cout << "  -c, --config FILE    "
+                 << gettext ("use the given configuration file, with "
+                                                   "any of the options below")
+                 << '\n';
+            cout << "      --macd MARKET    "
+                 << gettext ("print the MACD of every company in MARKET")
+                 << '\n';
+            cout << "      --screen MARKET [EXPRESSION...]\n"
+                 << "                       "
+                 << gettext ("rank every company in MARKET on the "
+                                                         "EXPRESSIONs, e.g.")
+                 << "\n                       "
+                    "envelope:20:2 return:5 crossover:10:50\n";
+            cout << "      --correlation MARKET [COUNT]\n"
+                 << "                       "
+                 << gettext ("print the COUNT most correlated pairs of "
+                                                    "companies in MARKET")
+                 << '\n';
+            cout << "      --backtest MARKET SHARES [STRATEGY...]\n"
+                 << "                       "
+                 << gettext ("replay ten years of MARKET through the "
+                                                          "STRATEGYs, e.g.")
+                 << "\n                       "
+                    "envelope:14:2 crossover:10:50\n";
             cout << gettext ("To report bugs or contact the authors please "
                                      "refer to http://rdmp.org/trader-desk\n");
             exit (0);
@@ -496,10 +912,7 @@ try
 
     Gtk::Main kit (argc, argv);
 
-    namespace TD  =  DMBCS::Trader_Desk;
-    TD::Window  window   {config_file.empty ()
-                               ?  TD::Preferences::from_default_file ()
-                               :  TD::Preferences::from_file  (config_file)};
+    TD::Window  window   {preferences ()};
 
     Gtk::Main::run (window);
 
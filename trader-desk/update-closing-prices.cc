@@ -20,6 +20,9 @@
 
 #include  <trader-desk/update-closing-prices.h>
 #include  <trader-desk/alpha-vantage--monitor.h>
+#include  <trader-desk/bounded-queue.h>
+#include  <trader-desk/ingest-job.h>
+#include  <thread>
 
 
 /** \file
@@ -119,6 +122,58 @@ namespace DMBCS::Trader_Desk { namespace Update_Closing_Prices {
           }
 
 
+    /* The day of the marketʼs latest close: today if it has closed
+     * already, otherwise the weekday before. */
+    static  tm  last_close_day  (const Work&  ucp)
+          {
+                const auto  close  {chrono::duration_cast<chrono::minutes>
+                                       (ucp.market.world_data.close_time)
+                                    .count ()};
+                tm  now  {not_weekend (current_tm ())};
+                if  (now.tm_hour * 60 + now.tm_min  <  close)
+                      now  =  day_before (now);
+                return  now;
+          }
+
+    /* The time of that close. */
+    static  time_t  last_close_time  (const Work&  ucp)
+          {
+                const auto  close  {chrono::duration_cast<chrono::minutes>
+                                       (ucp.market.world_data.close_time)
+                                    .count ()};
+                tm  T  {last_close_day (ucp)};
+                T.tm_hour   =  close / 60;
+                T.tm_min    =  close % 60;
+                T.tm_sec    =  0;
+                T.tm_isdst  =  -1;
+                return  mktime (&T);
+          }
+
+
+    /* What passes between the stages of the pipeline in do_update. */
+
+    struct  Fetched
+          {
+                const Company*  company;
+
+                /* Empty if there is nothing new to be had for the
+                 * company. */
+                optional<string>  csv;
+
+                /* Set if the server would not give us the companyʼs data;
+                 * it is left PENDING in the job, to be tried again. */
+                bool  failed  {0};
+          };
+
+    struct  Parsed
+          {
+                const Company*  company;
+                vector<Data>  data;
+                bool  failed;
+          };
+
+
+
 static  void  do_update
         (Work&  ucp,
          Preferences&  user_prefs,
@@ -129,46 +184,170 @@ static  void  do_update
   {
     ucp.stop  =  false;
 
-    for (size_t  i  {0};  i < entries.size ();  ++i)
+    /* A job which was started since the last close can be taken up
+     * again; anything older is out of date. */
+    optional<Ingest_Job>  job;
+    try
       {
-        if (ucp.stop)   break;
+        job.emplace  (user_prefs,  ucp.market.seqid,  last_close_time (ucp));
+      }
+    catch (const exception&  e)   {  throw No_Connection {e};  }
+
+    /* The work is done in three stages, each in its own thread, so that
+     * while we wait for the server to let us make the next request, the
+     * last response is being parsed and the one before that written
+     * away: fetching the responses (in this thread), parsing them, and
+     * passing the data to the injector. */
+    Bounded_Queue<Fetched>  fetched  {PIPELINE_DEPTH};
+    Bounded_Queue<Parsed>   parsed   {PIPELINE_DEPTH};
+
+    /* The first exception thrown by any of the stages, to be re-thrown
+     * here when they have all finished. */
+    exception_ptr  failure;
+    mutex  failure_mutex;
+
+    auto const  fail  {[&]  (exception_ptr  e)
+                       {
+                         lock_guard  l  {failure_mutex};
+                         if (! failure)   failure  =  e;
+                       }};
+
+    thread  parser
+      {[&]
+       {
+         try
+           {
+             while  (auto  F  {fetched.pop ()})
+               {
+                 Parsed  P  {F->company,  {},  F->failed};
+
+                 if  (F->csv)
+                       Price_Server::parse_closing_prices
+                                (*F->company,
+                                 *F->csv,
+                                 [&P]  (const Data&  d)
+                                       {   P.data.push_back (d);   });
+
+                 if  (! parsed.push (move (P)))   break;
+               }
+
+             parsed.close ();
+           }
+         catch (...)
+           {
+             fail (current_exception ());
+             parsed.abandon ();
+             fetched.abandon ();
+           }
+       }};
+
+    thread  writer
+      {[&]
+       {
+         try
+           {
+             while  (auto  P  {parsed.pop ()})
+               {
+                 if (ucp.stop)   break;
+                 for  (const auto&  d  :  P->data)   injector (d);
+                 if (! P->failed)    job->done (P->company->seqid);
+                 if (ucp.stop)   break;
+                 if (done_processing)    done_processing (P->company->seqid);
+               }
+           }
+
+         /* The injectors used to be run inside the call to the price
+          * server, so that database problems showed up like network
+          * ones; we keep it that way. */
+         catch (const exception&  e)
+           {   fail (make_exception_ptr (No_Connection {e}));   }
+
+         catch (...)
+           {   fail (current_exception ());   }
+
+         /* If we stopped early, the other stages must not wait for us. */
+         parsed.abandon ();
+         fetched.abandon ();
+       }};
+
+    /* Whether any company was skipped, in which case the job is kept so
+     * that the next update need only try those again. */
+    bool  any_failed  {0};
+
+    try
+      {
+        for (size_t  i  {0};  i < entries.size ();  ++i)
+          {
+            if (ucp.stop)   break;
+
+            const Company&  company  {entries [i]};
 
-        const Company&  company  {entries [i]};
+            if (progress_callback)
+                  progress_callback  (i / double (entries.size ()),  company);
 
-        if (progress_callback)
-              progress_callback  (i / double (entries.size ()),  company);
+            const Ingest_Job::State  state  {job->state (company.seqid)};
 
-        tm  now  {not_weekend (current_tm ())};
-        const auto  close_hour  {chrono::duration_cast<chrono::hours>
-                                   (ucp.market.world_data.close_time).count ()};
-        const auto  close_min  {chrono::duration_cast<chrono::minutes>
-                                   (ucp.market.world_data.close_time).count ()
-                                 %  60};
-        if  (now.tm_hour < close_hour
-             ||  (now.tm_hour == close_hour  &&  now.tm_min < close_min))
-          now  =  day_before (now);
+            /* A company finished by an earlier run still goes down the
+             * pipeline, with nothing to write, so that done_processing
+             * hears of it. */
+            Fetched  F  {&company,  {}};
 
-        if  (!same_day  (tm_from  (company.last_close_date),  now))
-          try   {  while (Price_Server::get_closing_prices
+            /* Whatever was downloaded last time and not written away is
+             * still good. */
+            if  (state == Ingest_Job::State::FETCHED)
+                  F.csv  =  job->response (company.seqid);
+
+            if  (state != Ingest_Job::State::DONE
+                 &&  ! F.csv
+                 &&  ! same_day  (tm_from  (company.last_close_date),
+                                  last_close_day (ucp)))
+              try
+                {
+                  string  csv;
+                  while (Price_Server::fetch_closing_prices
                                  (company,
                                   ucp.market.world_data.component_extension,
                                   user_prefs,
-                                  injector)
+                                  csv)
                             ==  Price_Server::TO_DO::MORE_WORK)
-                        if (ucp.stop)   break;   }
+                        if (ucp.stop)   break;
+                  if (ucp.stop)   break;
+                  job->fetched (company.seqid,  csv);
+                  F.csv  =  move (csv);
+                }
+
+              catch (const Price_Server::Bad_API_Key&)    {  throw;  }
 
-          catch (const Price_Server::Bad_API_Key&)    {  throw;  }
+              /* No point trying the rest of the companies today. */
+              catch (const Price_Server::Quota_Used_Up&)  {  throw;  }
 
-          catch (const Price_Server::Error&)
-            {   cerr << "Skipping company " << company.name << ".\n";   }
+              catch (const Price_Server::Error&)
+                {
+                  cerr << "Skipping company " << company.name << ".\n";
+                  F.failed  =  any_failed  =  1;
+                }
 
-          /* This will be thrown by curlpp if there is any serious problem
-           * with the networking. */
-          catch (const exception&  e)   {   throw No_Connection {e};   }
-          
-        if (ucp.stop)  break;
-        if (done_processing)    done_processing (company.seqid);
+              /* This will be thrown by curlpp if there is any serious
+               * problem with the networking. */
+              catch (const exception&  e)   {   throw No_Connection {e};   }
+
+            if (ucp.stop)  break;
+            if (! fetched.push (move (F)))   break;
+          }
+      }
+    catch (...)
+      {
+        fail (current_exception ());
       }
+
+    /* Whatever has been fetched so far still gets written away. */
+    fetched.close ();
+    parser.join ();
+    writer.join ();
+
+    if (failure)    rethrow_exception (failure);
+
+    if (! ucp.stop  &&  ! any_failed)    job->finish ();
   }
 
 
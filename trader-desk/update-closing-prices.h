@@ -123,6 +123,11 @@ namespace DMBCS::Trader_Desk {
   vector<Company>  entries_from_database  (DB&,  const size_t  market_seqid);
     
 
+  /** The number of companies' responses which may wait between each
+   *  stage of \c do_update and the next. */
+  constexpr size_t const  PIPELINE_DEPTH  {4};
+
+
   /** Do the work: scan the \a db database for the appropriate \a
    *  companies and currently known closing prices, obtain new price
    *  information from data service and store these back to the database.  The
@@ -136,7 +141,17 @@ namespace DMBCS::Trader_Desk {
    *  to a companyʼs price records.
    *
    *  If not \c nullptr, the \a company_done callback will be called after
-   *  all data for a particular company have been processed as above. */
+   *  all data for a particular company have been processed as above; it
+   *  is called too for a company finished by an earlier, interrupted,
+   *  update, though there are then no new data.
+   *
+   *  The fetching, the parsing and the injecting of the data run in a
+   *  pipeline, so that each company's data are injected while later
+   *  companies' are being fetched.  The \a progress_callback is called
+   *  in the calling thread as each company is fetched; the \a injector
+   *  and \a company_done are called, in order of company, in a thread
+   *  of their own.  Exceptions from any of them come out of here, once
+   *  everything fetched before the problem has been injected. */
   void  do_update
       (Work&,
        DB&,
@@ -20,6 +20,8 @@
 
 #include  <trader-desk/update-latest-prices.h>
 #include  <trader-desk/alpha-vantage--monitor.h>
+#include  <trader-desk/http-client.h>
+#include  <iostream>
 #include  <algorithm>
 #include  <numeric>
 #include  <set>
@@ -54,16 +56,80 @@ namespace DMBCS::Trader_Desk::Update_Latest_Prices {
 
 
 
-  static void  do_update  (Work *const  work,
+  /* Thrown through Http_Client::get_all to get out of it early. */
+  struct  Stopped  {};
+
+
+
+  /* The companies are asked after in groups of as many as the server
+   * takes in one call, with up to PARALLEL_CALLS calls in flight at a
+   * time.  A company the server will not tell us about is skipped, but
+   * trouble with the account or the connection ends the whole update.  If
+   * \a stop is given and becomes set, the calls still to be made are
+   * abandoned, and what is still to come of those in flight is ignored. */
+
+  static void  do_update  (const string&  market_component_extension,
                            Preferences&  P,
                            function <void (Data const &)> injector,
-                           vector<Company> const &entries)
+                           vector<Company> const &entries,
+                           atomic<bool> const *const  stop  =  nullptr)
   try
   {
+    auto const  stopped  {[stop]  {  return  stop  &&  *stop;  }};
+
+    vector<vector<const Company*>>  groups;
     for  (const Company&  C  :  entries)
-      injector  (Data_Server::get_latest_data
-                       (C,  work->market.world_data.component_extension,  P));
+      {
+        if  (groups.empty ()
+               ||  groups.back ().size () == Data_Server::QUOTES_PER_CALL)
+          groups.emplace_back ();
+        groups.back ().push_back (&C);
+      }
+
+    vector<string>  queries;
+    queries.reserve (groups.size ());
+    for  (const auto&  G  :  groups)
+      queries.push_back (Data_Server::latest_data_query
+                                       (G,  market_component_extension,  P));
+
+    Http_Client::shared ().get_all
+        (queries,
+         PARALLEL_CALLS,
+         [&] (size_t const  i,  string&&  response,  exception_ptr  error)
+            {
+              if  (stopped ())   throw  Stopped  {};
+
+              try
+                {
+                  if  (error)   rethrow_exception (error);
+
+                  for  (const Data&  D  :  Data_Server::parse_latest_data
+                                                      (groups [i],  response))
+                    injector  (D);
+                }
+              catch (Data_Server::Throttled const &)     {  throw;  }
+              catch (Data_Server::Bad_API_Key const &)   {  throw;  }
+              catch (Data_Server::Error const &E)
+                {
+                  cerr << "Skipping company " << groups [i].front ()->symbol
+                       << ": " << E.what () << ".\n";
+                }
+              catch (Http_Client::Status_Error const &E)
+                {
+                  cerr << "Skipping company " << groups [i].front ()->symbol
+                       << ": " << E.what () << ".\n";
+                }
+            },
+         [&]  {  if  (stopped ())   throw  Stopped  {};
+                 return  Data_Server::admit (P);  });
   }
+  catch (Stopped const &)
+    {
+    }
+  catch (Data_Server::Error const &)
+    {
+      throw;
+    }
   catch (exception const &e)
     {
       throw Update_Closing_Prices::No_Connection {e};
@@ -76,42 +142,52 @@ namespace DMBCS::Trader_Desk::Update_Latest_Prices {
                     Preferences&  P,
                     function <void (Data const &)>  injector)
   {
-     do_update (work,
+     do_update (work->market.world_data.component_extension,
                 P,
                 injector,
                 Update_Closing_Prices::entries_from_database
-                                              (db,  work->market.seqid));
+                                              (db,  work->market.seqid),
+                &work->stop);
   }
 
 
 
-  void  do_update  (DB&  db,  Chart_Data&  data,  Preferences&  P)
+  void  do_update  (DB&  db,
+                    int const  company_seqid,
+                    Preferences&  P,
+                    function <void (Data const &)>  injector)
   {
     auto  row  {db.row_query ()};
     row  <<  "select company.symbol, "
          <<         "unix_timestamp(company.last_close_date), "
          <<         "market.component_extension "
          <<    "from company, market "
-         <<   "where company.seqid=" << data.company_seqid
+         <<   "where company.seqid=" << company_seqid
          <<        " and market.seqid=company.market";
     row.execute ();
 
     Company  C;
     row  >>  C.symbol  >>  C.last_close_date;
-    C.seqid  =  data.company_seqid;
+    C.seqid  =  company_seqid;
 
     const string  market_symbol  {row.next_entry<string> ()};
 
-    const Data  D  {Data_Server::get_latest_data  (C,  market_symbol,  P)};
-    
     ++row;
 
+    do_update  (market_symbol,  P,  injector,  {C});
+  }
+
+
+
+  void  chart_injector  (Chart_Data&  data,  const Data&  D)
+  {
     {unique_lock  L  {data.prices_mutex};
            data.last_fetch_time  =  D.time;
            data.prices.insert_event  (  {D.time,  D.price}  );
            data.extremes.end_time  =  D.time;       }
     
-    data.changed_signal.emit  ();
+    data.note_change  (Chart_Data::Change::NEW_TAIL | Chart_Data::Change::RANGE,
+                       D.time);
   }
   
       
@@ -68,16 +68,33 @@ namespace DMBCS::Trader_Desk {
     void  sql_injector  (DB&,  const Data&);
 
 
+    /** The most calls to the data server which we have in flight at
+     *  once. */
+    constexpr size_t const  PARALLEL_CALLS  {4};
+
+
     /** Get the companies for the registered market, fetch their latest
-     *  data from the Yahoo! server, and pass the results, one at a time,
-     *  to \a injector. */
+     *  data from the server, and pass the results, one at a time as they
+     *  arrive, to \a injector.  The calls to the server are made
+     *  concurrently, as fast as the rate limiter allows, but this may
+     *  still take minutes so should not be done in the GTK thread.  If
+     *  the \a work's \c stop flag is set, we return early. */
     void  do_update  (Work *const  work,
                       DB&,
                       Preferences&,
                       function <void (const Data&)>  injector);
 
 
-    void  do_update  (DB&,  Chart_Data&,  Preferences&);
+    /** As above, but for the one company with \a company_seqid. */
+    void  do_update  (DB&,
+                      int  company_seqid,
+                      Preferences&,
+                      function <void (const Data&)>  injector);
+
+
+    /** Put the new \a data into the \a chart_data, and tell the world;
+     *  this must be done in the GTK thread. */
+    void  chart_injector  (Chart_Data&,  const Data&);
     
 
 } }  /* End of namespace DMBCS::Trader_Desk::Update_Latest_Prices. */
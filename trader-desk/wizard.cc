@@ -20,6 +20,7 @@
 
 #include   <trader-desk/wizard.h>
 #include   <trader-desk/db.h>
+#include   <trader-desk/ingest-job.h>
 #include   <fstream>
 #include   <iostream>
 #include   <random>
@@ -526,6 +527,8 @@ try
 
     db.instruction ("create table alphavantage_ticks "
                              "(time int(11) primary key)");
+
+    Ingest_Job::create_tables (db);
     
     return  1;
 }
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <trader-desk/worker-pool.h>
+#include <gtkmm.h>
+
+
+/** \file
+ *
+ *  Implementation of the \c Worker_Pool class. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  Worker_Pool::Worker_Pool  (unsigned  n_threads)
+  {
+    if (n_threads == 0)
+      n_threads  =  max (2u,  thread::hardware_concurrency ())  -  1;
+
+    for (unsigned i = 0;  i < n_threads;  ++i)
+      workers.emplace_back ([this] { run (); });
+  }
+
+
+
+  Worker_Pool::~Worker_Pool  ()
+  {
+    {
+      lock_guard  l  {jobs_mutex};
+      stopping = 1;
+      jobs.clear ();
+    }
+
+    jobs_ready.notify_all ();
+
+    for (auto &w : workers)    w.join ();
+  }
+
+
+
+  void  Worker_Pool::run  ()
+  {
+    for (;;)
+      {
+        function <void ()>  job;
+
+        {
+          unique_lock  l  {jobs_mutex};
+          jobs_ready.wait (l,  [this] { return stopping  ||  ! jobs.empty (); });
+          if (stopping)    return;
+          job  =  move (jobs.front ());
+          jobs.pop_front ();
+        }
+
+        job ();
+      }
+  }
+
+
+
+  void  Worker_Pool::post  (function <void ()>  job)
+  {
+    {
+      lock_guard  l  {jobs_mutex};
+      jobs.push_back (move (job));
+    }
+
+    jobs_ready.notify_one ();
+  }
+
+
+
+  void  Worker_Pool::parallel_for  (size_t const  n,
+                                    function <void (size_t, size_t)>  body,
+                                    size_t const  grain)
+  {
+    if (n == 0)    return;
+
+    /* A few blocks per thread, so that a slow block does not hold
+     * everybody else up. */
+    auto const  block  {max (max (grain,  size_t {1}),
+                             n / (4 * (size () + 1)) + 1)};
+    auto const  number_blocks  {(n + block - 1) / block};
+
+    /* The jobs we post may only get to run after we have returned, so the
+     * state they share with us lives on the heap; they will not touch \a
+     * body unless they manage to claim a block, which can only happen
+     * while we are still waiting below. */
+    struct Shared
+    {
+      atomic <size_t>  next  {0};
+      size_t  done  {0};
+      mutex  done_mutex;
+      condition_variable  all_done;
+      function <void (size_t, size_t)>  *body;
+    };
+
+    auto  S  {make_shared <Shared> ()};
+    S->body = &body;
+
+    auto  work  =  [S,  n,  block,  number_blocks]
+      {
+        size_t  count  {0};
+        for (size_t b;  (b = S->next++) < number_blocks;  ++count)
+          (*S->body) (b * block,  min (n,  (b + 1) * block));
+
+        if (count == 0)    return;
+
+        lock_guard  l  {S->done_mutex};
+        if ((S->done += count) == number_blocks)
+          S->all_done.notify_all ();
+      };
+
+    for (size_t i = 1;  i < min (number_blocks,  size () + 1);  ++i)
+      post (work);
+
+    work ();
+
+    unique_lock  l  {S->done_mutex};
+    S->all_done.wait (l,  [&S,  number_blocks]
+                            { return S->done == number_blocks; });
+  }
+
+
+
+  Worker_Pool  &Worker_Pool::shared  ()
+  {
+    static Worker_Pool  pool;
+    return pool;
+  }
+
+
+
+  extern "C"  int  run_posted_function  (gpointer  f)
+  {
+    unique_ptr <function <void ()>>  F  {(function <void ()>*) f};
+    (*F) ();
+    return 0;
+  }
+
+
+  void  post_to_gtk_thread  (function <void ()>  f)
+  {
+    gdk_threads_add_idle  (run_posted_function,
+                           new function <void ()> {move (f)});
+  }
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2017, 2020  Dale Mellor
+ *
+ *  This file is part of the trader-desk package.
+ *
+ *  The trader-desk package is free software: you can redistribute it
+ *  and/or modify it under the terms of the GNU General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  The trader-desk package is distributed in the hope that it will be
+ *  useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#ifndef DMBCS__TRADER_DESK__WORKER_POOL__H
+#define DMBCS__TRADER_DESK__WORKER_POOL__H
+
+
+#include <trader-desk/stage-timer.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/** \file
+ *
+ *  Declaration of the \c Worker_Pool class, and of the \c
+ *  Background_Result template which uses it to take analytical
+ *  computations off the GTK thread. */
+
+
+namespace DMBCS::Trader_Desk {
+
+
+  using namespace std;
+
+
+  /** A fixed set of threads which take jobs off a queue and run them, in
+   *  the order they were posted.  There is one \c shared instance which
+   *  the whole application uses; the jobs must not touch any GTK
+   *  objects (use \c post_to_gtk_thread to get results back). */
+
+  class Worker_Pool
+  {
+    /** The threads; their number is fixed at construction. */
+    vector <thread>  workers;
+
+    /** Jobs waiting for a free thread. */
+    deque <function <void ()>>  jobs;
+
+    /** Protects \c jobs and \c stopping. */
+    mutex  jobs_mutex;
+
+    /** Signalled whenever a job is posted, or we are shutting down. */
+    condition_variable  jobs_ready;
+
+    /** Set in the destructor to tell the workers to finish. */
+    bool  stopping  {0};
+
+    /** The body of each worker thread. */
+    void  run  ();
+
+
+  public:
+
+    /** Start \a n_threads threads; if zero, use one fewer than the
+     *  hardware has cores (but at least one). */
+    explicit Worker_Pool  (unsigned  n_threads = 0);
+
+    /** Abandon any jobs which have not yet started, wait for running ones
+     *  to finish, and join all the threads. */
+    ~Worker_Pool  ();
+
+    Worker_Pool  (Worker_Pool const &)  =  delete;
+    Worker_Pool &operator=  (Worker_Pool const &)  =  delete;
+
+    /** Queue \a job for running on one of our threads. */
+    void  post  (function <void ()>  job);
+
+    /** The number of threads we run. */
+    size_t  size  ()  const   {  return workers.size ();  }
+
+    /** Call \a body on consecutive blocks [begin, end) which together
+     *  cover [0, \a n), spreading the blocks over our threads, and return
+     *  when all have been processed.  The calling thread takes its share
+     *  of the blocks, so this may safely be called from one of our own
+     *  jobs.  Blocks are at least \a grain long. */
+    void  parallel_for  (size_t  n,
+                         function <void (size_t begin,  size_t end)>  body,
+                         size_t  grain = 1);
+
+    /** The application-wide pool, created on first use. */
+    static Worker_Pool  &shared  ();
+
+  };  /* End of class Worker_Pool. */
+
+
+
+  /** Arrange for \a f to be called in the GTK thread at the next idle
+   *  moment.  May be called from any thread. */
+  void  post_to_gtk_thread  (function <void ()>  f);
+
+
+
+  /** A tag which identifies the inputs of a computation.  The \c data
+   *  component is usually a \c Chart_Data::prices_version; \c parameters
+   *  is maintained by the computing object and must change whenever any
+   *  other input (a window size, the start of the visible range) does. */
+
+  struct Input_Version
+  {
+    uint64_t  data        {0};
+    uint64_t  parameters  {0};
+
+    bool operator==  (Input_Version const &v)  const
+    {  return  data == v.data  &&  parameters == v.parameters;  }
+
+    bool operator!=  (Input_Version const &v)  const
+    {  return  ! (*this == v);  }
+  };
+
+
+
+  /** Holds the latest finished result of a computation which is run on
+   *  the shared \c Worker_Pool, and manages requests for new ones.  The
+   *  owner calls \c request in the GTK thread with a tag describing the
+   *  inputs, and a pure function which computes from a snapshot of those
+   *  inputs; when the function returns, its result is installed (and the
+   *  owner's \a done callback called) in the GTK thread, but only if no
+   *  request with a different tag has been made in the mean time.  Jobs
+   *  overtaken before they start are not run at all.
+   *
+   *  The owning object may be destroyed at any time in the GTK thread;
+   *  outstanding jobs will quietly discard their results. */
+
+  template <typename Result>
+  class Background_Result
+  {
+    /** State shared between ourself and the jobs in flight. */
+    struct Token
+    {
+      mutex          wanted_mutex;
+      Input_Version  wanted;
+      bool           alive  {1};   /* Only touched in the GTK thread. */
+    };
+
+    shared_ptr <Token>  token  {make_shared <Token> ()};
+
+    /** The most recent result to have been installed. */
+    shared_ptr <Result const>  latest;
+
+    /** The tag of the \c latest result. */
+    Input_Version  latest_version;
+
+    /** Whether \c latest_version means anything. */
+    bool  have_result  {0};
+
+    /** Whether \c Token::wanted means anything. */
+    bool  requested  {0};
+
+    /** Where to record the time taken by each computation, if
+     *  anywhere. */
+    shared_ptr <Stage_Timer>  timer;
+    string  timer_stage;
+
+
+  public:
+
+    Background_Result  ()  =  default;
+    Background_Result  (Background_Result const &)  =  delete;
+    Background_Result &operator=  (Background_Result const &)  =  delete;
+
+    ~Background_Result  ()   {  token->alive = 0;  }
+
+
+    /** Ask for a result for the inputs tagged \a v, to be computed by \a
+     *  compute on a worker thread.  If we already have that result, or a
+     *  request for it is outstanding, nothing happens. */
+    template <typename Compute>
+    void  request  (Input_Version const &v,
+                    Compute  compute,
+                    function <void ()>  done)
+    {
+      {
+        lock_guard  l  {token->wanted_mutex};
+        if (requested  &&  token->wanted == v)    return;
+        token->wanted = v;
+        requested = 1;
+      }
+
+      Worker_Pool::shared ()
+        .post ([this,  T = token,  v,
+                timer = timer,  stage = timer_stage,
+                compute = move (compute),  done = move (done)]  ()  mutable
+               {
+                 {
+                   lock_guard  l  {T->wanted_mutex};
+                   if (T->wanted != v)    return;
+                 }
+
+                 shared_ptr <Result const>  r;
+                 {
+                   Stage_Timer::Scope  s  {timer.get (),  stage};
+                   r = make_shared <Result const> (compute ());
+                 }
+
+                 post_to_gtk_thread
+                     ([this,  T,  v,  r = move (r),  done = move (done)]
+                      {
+                        if (! T->alive)    return;
+                        {
+                          lock_guard  l  {T->wanted_mutex};
+                          if (T->wanted != v)    return;
+                        }
+                        latest = r;
+                        latest_version = v;
+                        have_result = 1;
+                        done ();
+                      });
+               });
+    }
+
+
+    /** Have the time taken by each subsequent computation recorded in \a
+     *  t as a run of the \a stage. */
+    void  time_with  (shared_ptr <Stage_Timer>  t,  string  stage)
+    {
+      timer = move (t);
+      timer_stage = move (stage);
+    }
+
+
+    /** Install \a r, which was obtained by other means (usually from an
+     *  \c Analysis_Cache), as the result for the inputs tagged \a v.
+     *  Any outstanding request is thereby overtaken.  Only to be called
+     *  in the GTK thread. */
+    void  adopt  (Input_Version const &v,  shared_ptr <Result const>  r)
+    {
+      {
+        lock_guard  l  {token->wanted_mutex};
+        token->wanted = v;
+        requested = 1;
+      }
+      latest = move (r);
+      latest_version = v;
+      have_result = 1;
+    }
+
+
+    /** Would a \c request with tag \a v result in any work being done?
+     *  Allows the owner to avoid taking a snapshot of the inputs when it
+     *  is not needed. */
+    bool  needs  (Input_Version const &v)  const
+    {
+      lock_guard  l  {token->wanted_mutex};
+      return  ! requested  ||  token->wanted != v;
+    }
+
+
+    /** The last result installed, or \c nullptr if there is none yet.  It
+     *  may be out of date with respect to the latest request. */
+    shared_ptr <Result const>  get  ()  const   {  return latest;  }
+
+    /** The tag of the result returned by \c get. */
+    Input_Version const  &version  ()  const   {  return latest_version;  }
+
+    /** Is the result we hold the one for the latest request? */
+    bool  current  ()  const
+    {
+      lock_guard  l  {token->wanted_mutex};
+      return  have_result  &&  latest_version == token->wanted;
+    }
+
+  };  /* End of class Background_Result. */
+
+
+}  /* End of namespace DMBCS::Trader_Desk. */
+
+
+#endif  /* Undefined DMBCS__TRADER_DESK__WORKER_POOL__H. */